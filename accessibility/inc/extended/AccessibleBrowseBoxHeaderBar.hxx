@@ -23,8 +23,11 @@
 
 #include "extended/AccessibleBrowseBoxTableBase.hxx"
 #include <cppuhelper/implbase1.hxx>
+#include <cppuhelper/weakref.hxx>
 #include <com/sun/star/accessibility/XAccessibleSelection.hpp>
 
+#include <unordered_map>
+
 
 namespace accessibility {
 
@@ -157,6 +160,10 @@ public:
     /** @return  An unique implementation ID. */
     virtual css::uno::Sequence< sal_Int8 > SAL_CALL getImplementationId() override;
 
+    /** Forgets the header cells handed out so far, whose indexes are no longer
+        valid after rows or columns were inserted, removed or moved. */
+    void clearHeaderCellCache();
+
 protected:
     // internal virtual methods
 
@@ -198,6 +205,13 @@ protected:
         @throws <type>IndexOutOfBoundsException</type>
         If the specified row/column index (depending on type) is invalid. */
     void ensureIsValidHeaderIndex( sal_Int32 nIndex );
+
+    /** The header cells by row index or VCL column position, so that the same object
+        is returned for a header as long as a client holds it.  Sparse, as a client
+        walking the row headers of a big table only holds a few of them at a time. */
+    std::unordered_map< sal_Int32, css::uno::WeakReference< css::accessibility::XAccessible > > m_aHeaderCells;
+    /** The size of m_aHeaderCells after the cells no longer held were last removed. */
+    size_t m_nLiveHeaderCells;
 };
 
 // inlines
@@ -23,6 +23,9 @@
 
 #include <extended/AccessibleGridControlHeaderCell.hxx>
 #include <extended/AccessibleGridControlTableBase.hxx>
+#include <cppuhelper/weakref.hxx>
+
+#include <unordered_map>
 
 namespace accessibility {
 
@@ -115,6 +118,10 @@ public:
     /** @return  An unique implementation ID. */
     virtual css::uno::Sequence< sal_Int8 > SAL_CALL getImplementationId() override;
 
+    /** Forgets the header cells handed out so far, whose indexes are no longer
+        valid after rows or columns were inserted, removed or moved. */
+    void clearHeaderCellCache();
+
 protected:
     /** Returns the specified row or column. Uses one of the parameters,
         depending on object type.
@@ -135,6 +142,14 @@ protected:
     inline bool isRowBar() const;
     /** @return  TRUE, if the objects is a header bar for columns. */
     inline bool isColumnBar() const;
+
+private:
+    /** The header cells by row or column index, so that the same object is returned
+        for a header as long as a client holds it.  Sparse, as a client walking the row
+        headers of a big table only holds a few of them at a time. */
+    std::unordered_map< sal_Int32, css::uno::WeakReference< css::accessibility::XAccessible > > m_aHeaderCells;
+    /** The size of m_aHeaderCells after the cells no longer held were last removed. */
+    size_t m_nLiveHeaderCells;
 };
 
 // inlines
@@ -36,6 +36,7 @@
 #include <comphelper/accessibletexthelper.hxx>
 #include <tools/gen.hxx>
 #include <vcl/vclptr.hxx>
+#include "helper/entrylayoutcache.hxx"
 
 // forward
 
@@ -65,6 +66,8 @@ namespace accessibility
         /** The treelistbox control */
         VclPtr<SvtIconChoiceCtrl>           m_pIconCtrl;
         sal_Int32                           m_nIndex;
+        /// text layout for getCharacterBounds/getIndexAtPoint
+        EntryLayoutCache                    m_aLayoutCache;
 
     protected:
         /// client id in the AccessibleEventNotifier queue
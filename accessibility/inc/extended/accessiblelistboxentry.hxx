@@ -38,6 +38,7 @@
 #include <svtools/treelistentry.hxx>
 #include <tools/gen.hxx>
 #include "extended/listboxaccessible.hxx"
+#include "helper/entrylayoutcache.hxx"
 
 // forward ---------------------------------------------------------------
 
@@ -79,6 +80,8 @@ namespace accessibility
         /** The treelistbox control */
         std::deque< sal_Int32 >           m_aEntryPath;
         SvTreeListEntry*                    m_pSvLBoxEntry; // Needed for a11y focused item...
+        /// text layout for getCharacterBounds/getIndexAtPoint
+        EntryLayoutCache                    m_aLayoutCache;
 
 
     protected:
@@ -134,6 +137,8 @@ namespace accessibility
 
         SvTreeListEntry* GetSvLBoxEntry() const { return m_pSvLBoxEntry; }
 
+        void InvalidateLayoutData() { m_aLayoutCache.Invalidate(); }
+
 
     protected:
         // XTypeProvider
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_ACCESSIBILITY_INC_HELPER_ENTRYLAYOUTCACHE_HXX
+#define INCLUDED_ACCESSIBILITY_INC_HELPER_ENTRYLAYOUTCACHE_HXX
+
+#include <rtl/ustring.hxx>
+#include <tools/gen.hxx>
+#include <vcl/controllayout.hxx>
+#include <vcl/font.hxx>
+
+#include <memory>
+
+
+// class EntryLayoutCache
+
+
+/** keeps the text layout of a single list box or icon view entry
+
+    Assistive technology asks for the bounds of every character of every visible entry, and
+    recording the layout of the entry's text for each of these queries is expensive.  The
+    layout is recorded again only when the text, the font or the position of the entry
+    changed since the last query, or after Invalidate.
+*/
+class EntryLayoutCache
+{
+private:
+    std::unique_ptr< vcl::ControlLayoutData >   m_pLayoutData;
+    OUString                                    m_sText;
+    vcl::Font                                   m_aFont;
+    tools::Rectangle                            m_aItemRect;
+    /// the glyph rectangles of each line are ordered left to right, so they can be bisected
+    bool                                        m_bOrdered;
+
+    bool            IsValid( const OUString& rText, const vcl::Font& rFont, const tools::Rectangle& rItemRect ) const;
+    vcl::ControlLayoutData& Reset( const OUString& rText, const vcl::Font& rFont, const tools::Rectangle& rItemRect );
+    void            Recorded();
+
+public:
+    EntryLayoutCache();
+    ~EntryLayoutCache();
+
+    /** returns the layout of the entry at rItemRect, letting rControl record it only if it is not
+        up to date
+    */
+    template< class CONTROL >
+    const vcl::ControlLayoutData& Get( CONTROL& rControl, const OUString& rText, const tools::Rectangle& rItemRect )
+    {
+        if ( !IsValid( rText, rControl.GetFont(), rItemRect ) )
+        {
+            rControl.RecordLayoutData( &Reset( rText, rControl.GetFont(), rItemRect ), rItemRect );
+            Recorded();
+        }
+        return *m_pLayoutData;
+    }
+
+    /// forget the recorded layout, e.g. after the control was scrolled
+    void            Invalidate();
+
+    /** returns the index of the character at rPoint in the layout last returned by Get, or -1
+
+        Unlike vcl::ControlLayoutData::GetIndexForPoint this bisects the glyph rectangles of
+        each line instead of testing all of them.
+    */
+    sal_Int32       GetIndexForPoint( const Point& rPoint ) const;
+};
+
+#endif // INCLUDED_ACCESSIBILITY_INC_HELPER_ENTRYLAYOUTCACHE_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
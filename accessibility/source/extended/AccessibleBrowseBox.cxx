@@ -20,6 +20,7 @@
 #include "extended/AccessibleBrowseBox.hxx"
 #include "extended/AccessibleBrowseBoxTable.hxx"
 #include "extended/AccessibleBrowseBoxHeaderBar.hxx"
+#include <com/sun/star/accessibility/AccessibleEventId.hpp>
 #include <svtools/accessibletableprovider.hxx>
 #include <toolkit/helper/vclunohelper.hxx>
 #include <sal/types.h>
@@ -271,6 +272,15 @@ AccessibleBrowseBoxTable* AccessibleBrowseBox::createAccessibleTable()
 
 void AccessibleBrowseBox::commitTableEvent(sal_Int16 _nEventId,const Any& _rNewValue,const Any& _rOldValue)
 {
+    // the header cells know their index
+    if ( _nEventId == AccessibleEventId::TABLE_MODEL_CHANGED )
+    {
+        if ( m_xImpl->mxColumnHeaderBar.is() )
+            m_xImpl->mxColumnHeaderBar->clearHeaderCellCache();
+        if ( m_xImpl->mxRowHeaderBar.is() )
+            m_xImpl->mxRowHeaderBar->clearHeaderCellCache();
+    }
+
     if ( m_xImpl->mxTable.is() )
     {
         m_xImpl->mxTable->commitEvent(_nEventId,_rNewValue,_rOldValue);
@@ -283,7 +293,11 @@ void AccessibleBrowseBox::commitHeaderBarEvent( sal_Int16 _nEventId,
 {
     rtl::Reference< AccessibleBrowseBoxHeaderBar >& xHeaderBar = _bColumnHeaderBar ? m_xImpl->mxColumnHeaderBar : m_xImpl->mxRowHeaderBar;
     if ( xHeaderBar.is() )
+    {
+        if ( _nEventId == AccessibleEventId::TABLE_MODEL_CHANGED )
+            xHeaderBar->clearHeaderCellCache();
         xHeaderBar->commitEvent(_nEventId,_rNewValue,_rOldValue);
+    }
 }
 
 
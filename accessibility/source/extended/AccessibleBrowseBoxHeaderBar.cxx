@@ -21,6 +21,8 @@
 #include <svtools/accessibletableprovider.hxx>
 #include <comphelper/servicehelper.hxx>
 
+#include <algorithm>
+
 
 using ::com::sun::star::uno::Reference;
 using ::com::sun::star::uno::Sequence;
@@ -40,7 +42,8 @@ AccessibleBrowseBoxHeaderBar::AccessibleBrowseBoxHeaderBar(
         const Reference< XAccessible >& rxParent,
         IAccessibleTableProvider&                      rBrowseBox,
         AccessibleBrowseBoxObjType      eObjType ) :
-    AccessibleBrowseBoxTableBase( rxParent, rBrowseBox,eObjType )
+    AccessibleBrowseBoxTableBase( rxParent, rBrowseBox,eObjType ),
+    m_nLiveHeaderCells( 16 )
 {
     OSL_ENSURE( isRowBar() || isColumnBar(),
         "extended/AccessibleBrowseBoxHeaderBar - invalid object type" );
@@ -322,9 +325,40 @@ sal_Int32 AccessibleBrowseBoxHeaderBar::implGetColumnCount() const
 Reference< XAccessible > AccessibleBrowseBoxHeaderBar::implGetChild(
         sal_Int32 nRow, sal_uInt16 nColumnPos )
 {
-    return isRowBar() ?
-        mpBrowseBox->CreateAccessibleRowHeader( nRow ) :
-        mpBrowseBox->CreateAccessibleColumnHeader( nColumnPos );
+    const sal_Int32 nIndex = isRowBar() ? nRow : nColumnPos;
+    if ( nIndex < 0 )
+        return Reference< XAccessible >();
+
+    auto it = m_aHeaderCells.find( nIndex );
+    Reference< XAccessible > xChild;
+    if ( it != m_aHeaderCells.end() )
+        xChild = it->second.get();
+    if ( !xChild.is() )
+    {
+        // drop the cells nobody holds any more, once there are as many new ones as live ones
+        if ( m_aHeaderCells.size() >= 2 * m_nLiveHeaderCells )
+        {
+            for ( auto aIt = m_aHeaderCells.begin(); aIt != m_aHeaderCells.end(); )
+            {
+                if ( aIt->second.get().is() )
+                    ++aIt;
+                else
+                    aIt = m_aHeaderCells.erase( aIt );
+            }
+            m_nLiveHeaderCells = std::max< size_t >( m_aHeaderCells.size(), 16 );
+        }
+        xChild = isRowBar() ?
+            mpBrowseBox->CreateAccessibleRowHeader( nRow ) :
+            mpBrowseBox->CreateAccessibleColumnHeader( nColumnPos );
+        m_aHeaderCells[ nIndex ] = xChild;
+    }
+    return xChild;
+}
+
+void AccessibleBrowseBoxHeaderBar::clearHeaderCellCache()
+{
+    m_aHeaderCells.clear();
+    m_nLiveHeaderCells = 16;
 }
 
 sal_Int32 AccessibleBrowseBoxHeaderBar::implGetChildIndexFromSelectedIndex(
@@ -336,6 +336,12 @@ void AccessibleGridControl::commitTableEvent(sal_Int16 _nEventId,const Any& _rNe
         }
         else if(_nEventId == AccessibleEventId::TABLE_MODEL_CHANGED)
         {
+            // the header cells know their index
+            if ( m_xImpl->m_xColumnHeaderBar.is() )
+                m_xImpl->m_xColumnHeaderBar->clearHeaderCellCache();
+            if ( m_xImpl->m_xRowHeaderBar.is() )
+                m_xImpl->m_xRowHeaderBar->clearHeaderCellCache();
+
             AccessibleTableModelChange aChange;
             if(_rNewValue >>= aChange)
             {
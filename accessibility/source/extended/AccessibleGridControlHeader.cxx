@@ -23,6 +23,8 @@
 #include <svtools/accessibletable.hxx>
 #include <comphelper/servicehelper.hxx>
 
+#include <algorithm>
+
 
 using ::com::sun::star::uno::Reference;
 using ::com::sun::star::uno::Sequence;
@@ -42,7 +44,8 @@ AccessibleGridControlHeader::AccessibleGridControlHeader(
         const Reference< XAccessible >& rxParent,
         ::svt::table::IAccessibleTable&                      rTable,
         ::svt::table::AccessibleTableControlObjType      eObjType):
-        AccessibleGridControlTableBase( rxParent, rTable, eObjType )
+        AccessibleGridControlTableBase( rxParent, rTable, eObjType ),
+        m_nLiveHeaderCells( 16 )
 {
     OSL_ENSURE( isRowBar() || isColumnBar(),
         "extended/AccessibleGridControlHeaderBar - invalid object type" );
@@ -62,18 +65,7 @@ AccessibleGridControlHeader::getAccessibleChild( sal_Int32 nChildIndex )
     if (nChildIndex<0 || nChildIndex>=getAccessibleChildCount())
         throw IndexOutOfBoundsException();
     ensureIsAlive();
-    Reference< XAccessible > xChild;
-    if(m_eObjType == svt::table::TCTYPE_COLUMNHEADERBAR)
-    {
-        AccessibleGridControlHeaderCell* pColHeaderCell = new AccessibleGridControlHeaderCell(nChildIndex, this, m_aTable, svt::table::TCTYPE_COLUMNHEADERCELL);
-        xChild = pColHeaderCell;
-    }
-    else if(m_eObjType == svt::table::TCTYPE_ROWHEADERBAR)
-    {
-        AccessibleGridControlHeaderCell* pRowHeaderCell = new AccessibleGridControlHeaderCell(nChildIndex, this, m_aTable, svt::table::TCTYPE_ROWHEADERCELL);
-        xChild = pRowHeaderCell;
-    }
-    return xChild;
+    return implGetChild( nChildIndex, nChildIndex );
 }
 
 sal_Int32 SAL_CALL AccessibleGridControlHeader::getAccessibleIndexInParent()
@@ -188,6 +180,12 @@ Sequence< sal_Int8 > SAL_CALL AccessibleGridControlHeader::getImplementationId()
     return css::uno::Sequence<sal_Int8>();
 }
 
+void AccessibleGridControlHeader::clearHeaderCellCache()
+{
+    m_aHeaderCells.clear();
+    m_nLiveHeaderCells = 16;
+}
+
 // internal virtual methods ---------------------------------------------------
 
 tools::Rectangle AccessibleGridControlHeader::implGetBoundingBox()
@@ -216,16 +214,31 @@ tools::Rectangle AccessibleGridControlHeader::implGetBoundingBoxOnScreen()
 Reference< XAccessible > AccessibleGridControlHeader::implGetChild(
         sal_Int32 nRow, sal_uInt32 nColumnPos )
 {
+    const sal_Int32 nIndex = isColumnBar() ? static_cast< sal_Int32 >( nColumnPos ) : nRow;
+    if ( nIndex < 0 || !( isColumnBar() || isRowBar() ) )
+        return Reference< XAccessible >();
+
+    auto it = m_aHeaderCells.find( nIndex );
     Reference< XAccessible > xChild;
-    if(m_eObjType == svt::table::TCTYPE_COLUMNHEADERBAR)
-    {
-        AccessibleGridControlHeaderCell* pColHeaderCell = new AccessibleGridControlHeaderCell(nColumnPos, this, m_aTable, svt::table::TCTYPE_COLUMNHEADERCELL);
-        xChild = pColHeaderCell;
-    }
-    else if(m_eObjType == svt::table::TCTYPE_ROWHEADERBAR)
+    if ( it != m_aHeaderCells.end() )
+        xChild = it->second.get();
+    if ( !xChild.is() )
     {
-        AccessibleGridControlHeaderCell* pRowHeaderCell = new AccessibleGridControlHeaderCell(nRow, this, m_aTable, svt::table::TCTYPE_ROWHEADERCELL);
-        xChild = pRowHeaderCell;
+        // drop the cells nobody holds any more, once there are as many new ones as live ones
+        if ( m_aHeaderCells.size() >= 2 * m_nLiveHeaderCells )
+        {
+            for ( auto aIt = m_aHeaderCells.begin(); aIt != m_aHeaderCells.end(); )
+            {
+                if ( aIt->second.get().is() )
+                    ++aIt;
+                else
+                    aIt = m_aHeaderCells.erase( aIt );
+            }
+            m_nLiveHeaderCells = std::max< size_t >( m_aHeaderCells.size(), 16 );
+        }
+        xChild = new AccessibleGridControlHeaderCell( nIndex, this, m_aTable,
+            isColumnBar() ? svt::table::TCTYPE_COLUMNHEADERCELL : svt::table::TCTYPE_ROWHEADERCELL );
+        m_aHeaderCells[ nIndex ] = xChild;
     }
     return xChild;
 }
@@ -428,8 +428,10 @@ namespace accessibility
         awt::Rectangle aBounds( 0, 0, 0, 0 );
         if ( m_pIconCtrl )
         {
+            // GetEntryCharacterBounds would record the layout of the whole entry for each character
             tools::Rectangle aItemRect = GetBoundingBox_Impl();
-            tools::Rectangle aCharRect = m_pIconCtrl->GetEntryCharacterBounds( m_nIndex, _nIndex );
+            const vcl::ControlLayoutData& rLayoutData = m_aLayoutCache.Get( *m_pIconCtrl, implGetText(), aItemRect );
+            tools::Rectangle aCharRect = rLayoutData.GetCharacterBounds( _nIndex );
             aCharRect.Move( -aItemRect.Left(), -aItemRect.Top() );
             aBounds = AWTRectangle( aCharRect );
         }
@@ -445,22 +447,11 @@ namespace accessibility
         sal_Int32 nIndex = -1;
         if ( m_pIconCtrl )
         {
-            vcl::ControlLayoutData aLayoutData;
             tools::Rectangle aItemRect = GetBoundingBox_Impl();
-            m_pIconCtrl->RecordLayoutData( &aLayoutData, aItemRect );
+            m_aLayoutCache.Get( *m_pIconCtrl, implGetText(), aItemRect );
             Point aPnt( VCLPoint( aPoint ) );
             aPnt += aItemRect.TopLeft();
-            nIndex = aLayoutData.GetIndexForPoint( aPnt );
-
-            long nLen = aLayoutData.m_aUnicodeBoundRects.size();
-            for ( long i = 0; i < nLen; ++i )
-            {
-                tools::Rectangle aRect = aLayoutData.GetCharacterBounds(i);
-                bool bInside = aRect.IsInside( aPnt );
-
-                if ( bInside )
-                    break;
-            }
+            nIndex = m_aLayoutCache.GetIndexForPoint( aPnt );
         }
 
         return nIndex;
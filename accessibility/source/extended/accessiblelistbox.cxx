@@ -208,6 +208,19 @@ namespace accessibility
                     }
                 }
                 break;
+            case VclEventId::ListboxScrolled:
+                {
+                    // the text layout of the entries is recorded at their old position
+                    for (auto const& rEntry : m_mapEntry)
+                    {
+                        AccessibleListBoxEntry* pAccListBoxEntry =
+                            static_cast< AccessibleListBoxEntry* >( rEntry.second.get() );
+                        if ( pAccListBoxEntry )
+                            pAccListBoxEntry->InvalidateLayoutData();
+                    }
+                    VCLXAccessibleComponent::ProcessWindowEvent (rVclWindowEvent);
+                }
+                break;
             default:
                 VCLXAccessibleComponent::ProcessWindowEvent (rVclWindowEvent);
             }
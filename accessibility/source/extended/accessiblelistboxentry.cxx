@@ -647,10 +647,9 @@ namespace accessibility
         SvTreeListEntry* pEntry = getListBox()->GetEntryFromPath( m_aEntryPath );
         if ( pEntry )
         {
-            vcl::ControlLayoutData aLayoutData;
             tools::Rectangle aItemRect = GetBoundingBox();
-            getListBox()->RecordLayoutData( &aLayoutData, aItemRect );
-            tools::Rectangle aCharRect = aLayoutData.GetCharacterBounds( nIndex );
+            const vcl::ControlLayoutData& rLayoutData = m_aLayoutCache.Get( *getListBox(), implGetText(), aItemRect );
+            tools::Rectangle aCharRect = rLayoutData.GetCharacterBounds( nIndex );
             aCharRect.Move( -aItemRect.Left(), -aItemRect.Top() );
             aBounds = AWTRectangle( aCharRect );
         }
@@ -669,12 +668,11 @@ namespace accessibility
         SvTreeListEntry* pEntry = getListBox()->GetEntryFromPath( m_aEntryPath );
         if ( pEntry )
         {
-            vcl::ControlLayoutData aLayoutData;
             tools::Rectangle aItemRect = GetBoundingBox();
-            getListBox()->RecordLayoutData( &aLayoutData, aItemRect );
+            m_aLayoutCache.Get( *getListBox(), implGetText(), aItemRect );
             Point aPnt( VCLPoint( aPoint ) );
             aPnt += aItemRect.TopLeft();
-            nIndex = aLayoutData.GetIndexForPoint( aPnt );
+            nIndex = m_aLayoutCache.GetIndexForPoint( aPnt );
         }
 
         return nIndex;
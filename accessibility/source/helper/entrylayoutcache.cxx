@@ -0,0 +1,100 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <helper/entrylayoutcache.hxx>
+
+#include <algorithm>
+
+
+// class EntryLayoutCache
+
+
+EntryLayoutCache::EntryLayoutCache()
+    :m_bOrdered( false )
+{
+}
+
+
+EntryLayoutCache::~EntryLayoutCache()
+{
+}
+
+
+bool EntryLayoutCache::IsValid( const OUString& rText, const vcl::Font& rFont, const tools::Rectangle& rItemRect ) const
+{
+    return m_pLayoutData && m_aItemRect == rItemRect && m_sText == rText && m_aFont == rFont;
+}
+
+
+vcl::ControlLayoutData& EntryLayoutCache::Reset( const OUString& rText, const vcl::Font& rFont, const tools::Rectangle& rItemRect )
+{
+    m_pLayoutData.reset( new vcl::ControlLayoutData );
+    m_sText = rText;
+    m_aFont = rFont;
+    m_aItemRect = rItemRect;
+    m_bOrdered = false;
+    return *m_pLayoutData;
+}
+
+
+void EntryLayoutCache::Recorded()
+{
+    // right-to-left or mixed text, and empty rectangles, are left to the linear search
+    const std::vector< tools::Rectangle >& rRects = m_pLayoutData->m_aUnicodeBoundRects;
+    m_bOrdered = true;
+    for ( long nLine = 0, nLineCount = m_pLayoutData->GetLineCount(); nLine < nLineCount && m_bOrdered; ++nLine )
+    {
+        Pair aLine = m_pLayoutData->GetLineStartEnd( nLine );
+        if ( aLine.A() < 0 || aLine.B() >= static_cast< long >( rRects.size() ) )
+            m_bOrdered = false;
+        for ( long i = aLine.A(); i <= aLine.B() && m_bOrdered; ++i )
+        {
+            if ( rRects[i].IsEmpty() )
+                m_bOrdered = false;
+            else if ( i > aLine.A()
+                      && ( rRects[i].Left() < rRects[i-1].Left() || rRects[i].Right() < rRects[i-1].Right() ) )
+                m_bOrdered = false;
+        }
+    }
+}
+
+
+void EntryLayoutCache::Invalidate()
+{
+    m_pLayoutData.reset();
+    m_sText.clear();
+    m_bOrdered = false;
+}
+
+
+sal_Int32 EntryLayoutCache::GetIndexForPoint( const Point& rPoint ) const
+{
+    if ( !m_pLayoutData )
+        return -1;
+    if ( !m_bOrdered )
+        return m_pLayoutData->GetIndexForPoint( rPoint );
+
+    const std::vector< tools::Rectangle >& rRects = m_pLayoutData->m_aUnicodeBoundRects;
+    for ( long nLine = 0, nLineCount = m_pLayoutData->GetLineCount(); nLine < nLineCount; ++nLine )
+    {
+        Pair aLine = m_pLayoutData->GetLineStartEnd( nLine );
+        if ( aLine.A() < 0 || aLine.B() < aLine.A() )
+            continue;
+        auto aBegin = rRects.begin() + aLine.A();
+        auto aEnd = rRects.begin() + aLine.B() + 1;
+        // the first glyph that does not end left of the point
+        auto aIter = std::lower_bound( aBegin, aEnd, rPoint.X(),
+            []( const tools::Rectangle& rRect, long nX ) { return rRect.Right() < nX; } );
+        if ( aIter != aEnd && aIter->IsInside( rPoint ) )
+            return aIter - rRects.begin();
+    }
+    return -1;
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,38 @@
+# -*- Mode: makefile-gmake; tab-width: 4; indent-tabs-mode: t -*-
+#*************************************************************************
+#
+# This file is part of the LibreOffice project.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+#*************************************************************************
+
+$(eval $(call gb_CppunitTest_CppunitTest,animations_structure_test))
+
+$(eval $(call gb_CppunitTest_add_exception_objects,animations_structure_test, \
+    animations/qa/unit/animations-structure-test \
+))
+
+$(eval $(call gb_CppunitTest_use_library_objects,animations_structure_test, \
+    animcore \
+))
+
+$(eval $(call gb_CppunitTest_set_include,animations_structure_test,\
+    -I$(SRCDIR)/animations/source/animcore \
+    $$(INCLUDE) \
+))
+
+$(eval $(call gb_CppunitTest_use_libraries,animations_structure_test, \
+    comphelper \
+    cppu \
+    cppuhelper \
+    sal \
+))
+
+$(eval $(call gb_CppunitTest_use_external,animations_structure_test,boost_headers))
+
+$(eval $(call gb_CppunitTest_use_sdk_api,animations_structure_test))
+
+# vim: set noet sw=4 ts=4:
@@ -34,6 +34,8 @@ $(eval $(call gb_Library_use_libraries,animcore,\
 
 $(eval $(call gb_Library_add_exception_objects,animcore,\
     animations/source/animcore/animcore \
+    animations/source/animcore/animationsampler \
+    animations/source/animcore/animationsnapshot \
 ))
 
 # vim: set noet sw=4 ts=4:
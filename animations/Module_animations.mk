@@ -23,4 +23,11 @@ $(eval $(call gb_Module_add_targets,animations,\
     Library_animcore \
 ))
 
+$(eval $(call gb_Module_add_check_targets,animations,\
+    CppunitTest_animations_index_test \
+    CppunitTest_animations_sampler_test \
+    CppunitTest_animations_snapshot_test \
+    CppunitTest_animations_structure_test \
+))
+
 # vim: set noet sw=4 ts=4:
@@ -0,0 +1,218 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <algorithm>
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/plugin/TestPlugIn.h>
+
+#include <com/sun/star/animations/XAnimate.hpp>
+#include <com/sun/star/animations/XTimeContainer.hpp>
+#include <com/sun/star/beans/NamedValue.hpp>
+#include <com/sun/star/lang/IllegalArgumentException.hpp>
+
+#include "animationnodeindex.hxx"
+
+using namespace ::com::sun::star;
+
+// the factories of the nodes, from the objects of the animcore library
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_ParallelTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_SequenceTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_Animate_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+namespace
+{
+
+typedef uno::XInterface* (SAL_CALL * Factory_t)(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+uno::Reference<animations::XAnimationNode> createNode(Factory_t pFactory)
+{
+    uno::Reference<uno::XInterface> xNode(pFactory(nullptr, uno::Sequence<uno::Any>()), SAL_NO_ACQUIRE);
+    return uno::Reference<animations::XAnimationNode>(xNode, uno::UNO_QUERY_THROW);
+}
+
+beans::NamedValue makeNamedValue(const OUString& rName, const uno::Any& rValue)
+{
+    beans::NamedValue aValue;
+    aValue.Name = rName;
+    aValue.Value = rValue;
+    return aValue;
+}
+
+bool contains(const std::vector<uno::Reference<animations::XAnimationNode>>& rNodes,
+              const uno::Reference<animations::XAnimationNode>& rxNode)
+{
+    return std::find(rNodes.begin(), rNodes.end(), rxNode) != rNodes.end();
+}
+
+/// Tests finding the nodes of animation node trees by target and by user data
+class AnimationsIndexTest : public CppUnit::TestFixture
+{
+public:
+    void testFindByTarget();
+    void testFindByUserData();
+    void testSetTarget();
+    void testInsertRemove();
+    void testForeignNode();
+
+    CPPUNIT_TEST_SUITE(AnimationsIndexTest);
+    CPPUNIT_TEST(testFindByTarget);
+    CPPUNIT_TEST(testFindByUserData);
+    CPPUNIT_TEST(testSetTarget);
+    CPPUNIT_TEST(testInsertRemove);
+    CPPUNIT_TEST(testForeignNode);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// an effect with the given preset that animates the given shape
+    uno::Reference<animations::XAnimationNode> createEffect(const OUString& rPresetId,
+                                                            const uno::Reference<uno::XInterface>& rxShape);
+    /// a main sequence with an effect for each of the two shapes
+    uno::Reference<animations::XAnimationNode> createTree();
+
+    /// stand in for the shapes that are animated
+    uno::Reference<uno::XInterface> mxFirstShape;
+    uno::Reference<uno::XInterface> mxSecondShape;
+    uno::Reference<animations::XTimeContainer> mxSequence;
+};
+
+uno::Reference<animations::XAnimationNode> AnimationsIndexTest::createEffect(
+    const OUString& rPresetId, const uno::Reference<uno::XInterface>& rxShape)
+{
+    uno::Reference<animations::XAnimationNode> xEffect
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    xEffect->setUserData({ makeNamedValue("node-type", uno::Any(sal_Int16(1))),
+                           makeNamedValue("preset-id", uno::Any(rPresetId)) });
+
+    uno::Reference<animations::XAnimate> xAnimate(
+        createNode(com_sun_star_animations_Animate_get_implementation), uno::UNO_QUERY_THROW);
+    xAnimate->setTarget(uno::Any(rxShape));
+    xAnimate->setAttributeName("Visibility");
+    uno::Reference<animations::XTimeContainer>(xEffect, uno::UNO_QUERY_THROW)->appendChild(xAnimate);
+    return xEffect;
+}
+
+uno::Reference<animations::XAnimationNode> AnimationsIndexTest::createTree()
+{
+    mxFirstShape = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    mxSecondShape = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+
+    uno::Reference<animations::XAnimationNode> xRoot
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    mxSequence.set(createNode(com_sun_star_animations_SequenceTimeContainer_get_implementation),
+                   uno::UNO_QUERY_THROW);
+    mxSequence->appendChild(createEffect("ooo-entrance-appear", mxFirstShape));
+    mxSequence->appendChild(createEffect("ooo-entrance-fade-in", mxSecondShape));
+    uno::Reference<animations::XTimeContainer>(xRoot, uno::UNO_QUERY_THROW)->appendChild(
+        uno::Reference<animations::XAnimationNode>(mxSequence, uno::UNO_QUERY_THROW));
+    return xRoot;
+}
+
+void AnimationsIndexTest::testFindByTarget()
+{
+    uno::Reference<animations::XAnimationNode> xRoot = createTree();
+
+    std::vector<uno::Reference<animations::XAnimationNode>> aNodes
+        = animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aNodes.size());
+    CPPUNIT_ASSERT(uno::Reference<animations::XAnimate>(aNodes[0], uno::UNO_QUERY)->getTarget()
+                   == uno::Any(mxFirstShape));
+
+    // any node of the tree can be asked
+    CPPUNIT_ASSERT_EQUAL(size_t(1), animcore::findNodesByTarget(aNodes[0], uno::Any(mxSecondShape)).size());
+    CPPUNIT_ASSERT(animcore::findNodesByTarget(xRoot, uno::Any(xRoot)).empty());
+}
+
+void AnimationsIndexTest::testFindByUserData()
+{
+    uno::Reference<animations::XAnimationNode> xRoot = createTree();
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), animcore::findNodesByUserData(xRoot, "node-type", uno::Any(sal_Int16(1))).size());
+    // the value is compared like Any::operator== does
+    CPPUNIT_ASSERT_EQUAL(size_t(2), animcore::findNodesByUserData(xRoot, "node-type", uno::Any(sal_Int32(1))).size());
+
+    std::vector<uno::Reference<animations::XAnimationNode>> aNodes
+        = animcore::findNodesByUserData(xRoot, "preset-id", uno::Any(OUString("ooo-entrance-fade-in")));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aNodes.size());
+    CPPUNIT_ASSERT(aNodes[0]->getUserData()[1].Value == uno::Any(OUString("ooo-entrance-fade-in")));
+
+    // the index follows changes of the user data
+    aNodes[0]->setUserData({ makeNamedValue("preset-id", uno::Any(OUString("ooo-entrance-appear"))) });
+    CPPUNIT_ASSERT(animcore::findNodesByUserData(xRoot, "preset-id", uno::Any(OUString("ooo-entrance-fade-in"))).empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), animcore::findNodesByUserData(xRoot, "preset-id", uno::Any(OUString("ooo-entrance-appear"))).size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), animcore::findNodesByUserData(xRoot, "node-type", uno::Any(sal_Int16(1))).size());
+}
+
+void AnimationsIndexTest::testSetTarget()
+{
+    uno::Reference<animations::XAnimationNode> xRoot = createTree();
+    std::vector<uno::Reference<animations::XAnimationNode>> aNodes
+        = animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aNodes.size());
+
+    uno::Reference<animations::XAnimate>(aNodes[0], uno::UNO_QUERY_THROW)->setTarget(uno::Any(mxSecondShape));
+    CPPUNIT_ASSERT(animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)).empty());
+    aNodes = animcore::findNodesByTarget(xRoot, uno::Any(mxSecondShape));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), aNodes.size());
+}
+
+void AnimationsIndexTest::testInsertRemove()
+{
+    uno::Reference<animations::XAnimationNode> xRoot = createTree();
+    CPPUNIT_ASSERT_EQUAL(size_t(1), animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)).size());
+
+    // a subtree inserted after the first query is indexed
+    uno::Reference<animations::XAnimationNode> xEffect = createEffect("ooo-emphasis-spin", mxFirstShape);
+    mxSequence->appendChild(xEffect);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)).size());
+    std::vector<uno::Reference<animations::XAnimationNode>> aNodes
+        = animcore::findNodesByUserData(xRoot, "preset-id", uno::Any(OUString("ooo-emphasis-spin")));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aNodes.size());
+    CPPUNIT_ASSERT(aNodes[0] == xEffect);
+
+    // and a removed one is not, nor is it found in the tree it was removed from any more
+    mxSequence->removeChild(xEffect);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)).size());
+    CPPUNIT_ASSERT(animcore::findNodesByUserData(xRoot, "preset-id", uno::Any(OUString("ooo-emphasis-spin"))).empty());
+    aNodes = animcore::findNodesByTarget(xEffect, uno::Any(mxFirstShape));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aNodes.size());
+    CPPUNIT_ASSERT(!contains(animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)), aNodes[0]));
+
+    // nodes that are gone are not found
+    xEffect.clear();
+    aNodes.clear();
+    uno::Reference<animations::XAnimationNode> xSequence(mxSequence, uno::UNO_QUERY_THROW);
+    mxSequence.clear();
+    uno::Reference<animations::XTimeContainer>(xRoot, uno::UNO_QUERY_THROW)->removeChild(xSequence);
+    xSequence.clear();
+    CPPUNIT_ASSERT(animcore::findNodesByTarget(xRoot, uno::Any(mxFirstShape)).empty());
+    CPPUNIT_ASSERT(animcore::findNodesByUserData(xRoot, "node-type", uno::Any(sal_Int16(1))).empty());
+}
+
+void AnimationsIndexTest::testForeignNode()
+{
+    CPPUNIT_ASSERT_THROW(animcore::findNodesByTarget(nullptr, uno::Any()), lang::IllegalArgumentException);
+    CPPUNIT_ASSERT_THROW(animcore::findNodesByUserData(nullptr, "node-type", uno::Any()),
+                         lang::IllegalArgumentException);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AnimationsIndexTest);
+
+}
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,317 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <utility>
+#include <vector>
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/plugin/TestPlugIn.h>
+
+#include <com/sun/star/animations/AnimationCalcMode.hpp>
+#include <com/sun/star/animations/AnimationColorSpace.hpp>
+#include <com/sun/star/animations/ValuePair.hpp>
+#include <com/sun/star/animations/XAnimate.hpp>
+#include <com/sun/star/animations/XAnimateColor.hpp>
+#include <com/sun/star/lang/IllegalArgumentException.hpp>
+
+#include "animationsampler.hxx"
+
+using namespace ::com::sun::star;
+
+// the factories of the nodes, from the objects of the animcore library
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_Animate_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_AnimateSet_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_AnimateColor_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+namespace
+{
+
+typedef uno::XInterface* (SAL_CALL * Factory_t)(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+uno::Reference<animations::XAnimate> createNode(Factory_t pFactory)
+{
+    uno::Reference<uno::XInterface> xNode(pFactory(nullptr, uno::Sequence<uno::Any>()), SAL_NO_ACQUIRE);
+    return uno::Reference<animations::XAnimate>(xNode, uno::UNO_QUERY_THROW);
+}
+
+double toDouble(const uno::Any& rValue)
+{
+    double fValue = 0.0;
+    CPPUNIT_ASSERT(rValue >>= fValue);
+    return fValue;
+}
+
+sal_Int32 toColor(const uno::Any& rValue)
+{
+    // colors are sampled as sal_Int32, not as a number widened to double
+    sal_Int32 nColor = 0;
+    CPPUNIT_ASSERT(rValue >>= nColor);
+    return nColor;
+}
+
+/// Tests sampling the values of animation nodes over their simple duration
+class AnimationsSamplerTest : public CppUnit::TestFixture
+{
+public:
+    void testDiscrete();
+    void testLinear();
+    void testPaced();
+    void testSpline();
+    void testNotInterpolated();
+    void testBulk();
+    void testCreate();
+    void testHSL();
+    void testCreateColor();
+
+    CPPUNIT_TEST_SUITE(AnimationsSamplerTest);
+    CPPUNIT_TEST(testDiscrete);
+    CPPUNIT_TEST(testLinear);
+    CPPUNIT_TEST(testPaced);
+    CPPUNIT_TEST(testSpline);
+    CPPUNIT_TEST(testNotInterpolated);
+    CPPUNIT_TEST(testBulk);
+    CPPUNIT_TEST(testCreate);
+    CPPUNIT_TEST(testHSL);
+    CPPUNIT_TEST(testCreateColor);
+    CPPUNIT_TEST_SUITE_END();
+};
+
+void AnimationsSamplerTest::testDiscrete()
+{
+    // without key times, each value gets an equal step
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::DISCRETE, {},
+                                        { uno::Any(0.0), uno::Any(10.0), uno::Any(20.0) }, {});
+    CPPUNIT_ASSERT(aSampler.isValid());
+    CPPUNIT_ASSERT_EQUAL(0.0, toDouble(aSampler.sample(0.0)));
+    CPPUNIT_ASSERT_EQUAL(0.0, toDouble(aSampler.sample(0.3)));
+    CPPUNIT_ASSERT_EQUAL(10.0, toDouble(aSampler.sample(0.5)));
+    CPPUNIT_ASSERT_EQUAL(20.0, toDouble(aSampler.sample(0.9)));
+    CPPUNIT_ASSERT_EQUAL(20.0, toDouble(aSampler.sample(1.0)));
+
+    // with key times, the steps are where they say
+    animcore::AnimationSampler aKeyed(animations::AnimationCalcMode::DISCRETE, { 0.0, 0.8 },
+                                      { uno::Any(0.0), uno::Any(10.0) }, {});
+    CPPUNIT_ASSERT_EQUAL(0.0, toDouble(aKeyed.sample(0.7)));
+    CPPUNIT_ASSERT_EQUAL(10.0, toDouble(aKeyed.sample(0.8)));
+}
+
+void AnimationsSamplerTest::testLinear()
+{
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::LINEAR, { 0.0, 0.5, 1.0 },
+                                        { uno::Any(0.0), uno::Any(10.0), uno::Any(30.0) }, {});
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, toDouble(aSampler.sample(0.25)), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(20.0, toDouble(aSampler.sample(0.75)), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, toDouble(aSampler.sample(1.0)), 1E-9);
+    // times outside of the simple duration are clamped
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, toDouble(aSampler.sample(-1.0)), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, toDouble(aSampler.sample(2.0)), 1E-9);
+
+    // pairs are interpolated per member
+    animcore::AnimationSampler aPairs(
+        animations::AnimationCalcMode::LINEAR, {},
+        { uno::Any(animations::ValuePair(uno::Any(0.0), uno::Any(1.0))),
+          uno::Any(animations::ValuePair(uno::Any(1.0), uno::Any(0.0))) },
+        {});
+    animations::ValuePair aPair;
+    CPPUNIT_ASSERT(aPairs.sample(0.25) >>= aPair);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, toDouble(aPair.First), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, toDouble(aPair.Second), 1E-9);
+
+    // and colors per channel
+    animcore::AnimationSampler aColors(animations::AnimationCalcMode::LINEAR, {},
+                                       { uno::Any(sal_Int32(0x000000)), uno::Any(sal_Int32(0xff0040)) },
+                                       {}, animcore::AnimationSampler::Colors::RGB);
+    CPPUNIT_ASSERT(aColors.sample(0.5) == uno::Any(sal_Int32(0x800020)));
+}
+
+void AnimationsSamplerTest::testPaced()
+{
+    // the key times follow from the distances between the values, given ones are ignored
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::PACED, { 0.0, 0.5, 1.0 },
+                                        { uno::Any(0.0), uno::Any(10.0), uno::Any(40.0) }, {});
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, toDouble(aSampler.sample(0.125)), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, toDouble(aSampler.sample(0.25)), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(25.0, toDouble(aSampler.sample(0.625)), 1E-9);
+
+    // values that do not move are evenly spaced
+    animcore::AnimationSampler aStill(animations::AnimationCalcMode::PACED, {},
+                                      { uno::Any(3.0), uno::Any(3.0) }, {});
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, toDouble(aStill.sample(0.5)), 1E-9);
+}
+
+void AnimationsSamplerTest::testSpline()
+{
+    animations::TimeFilterPair aFirst, aSecond;
+    aFirst.Time = 0.42;
+    aFirst.Progress = 0.0;
+    aSecond.Time = 0.58;
+    aSecond.Progress = 1.0;
+
+    // ease in and out: symmetric around the middle, slow at the start
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::SPLINE, { 0.0, 1.0 },
+                                        { uno::Any(0.0), uno::Any(10.0) }, { aFirst, aSecond });
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, toDouble(aSampler.sample(0.5)), 1E-6);
+    CPPUNIT_ASSERT(toDouble(aSampler.sample(0.25)) < 2.5);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 - toDouble(aSampler.sample(0.25)), toDouble(aSampler.sample(0.75)), 1E-6);
+
+    // control points on the diagonal make it linear
+    aFirst.Progress = aFirst.Time;
+    aSecond.Progress = aSecond.Time;
+    animcore::AnimationSampler aLinear(animations::AnimationCalcMode::SPLINE, { 0.0, 1.0 },
+                                       { uno::Any(0.0), uno::Any(10.0) }, { aFirst, aSecond });
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, toDouble(aLinear.sample(0.3)), 1E-6);
+
+    // without two control points per segment, the values are interpolated linearly
+    animcore::AnimationSampler aMissing(animations::AnimationCalcMode::SPLINE, { 0.0, 1.0 },
+                                        { uno::Any(0.0), uno::Any(10.0) }, { aFirst });
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, toDouble(aMissing.sample(0.25)), 1E-9);
+}
+
+void AnimationsSamplerTest::testNotInterpolated()
+{
+    // strings are stepped, even in linear mode
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::LINEAR, {},
+                                        { uno::Any(OUString("hidden")), uno::Any(OUString("visible")) },
+                                        {});
+    CPPUNIT_ASSERT(aSampler.sample(0.25) == uno::Any(OUString("hidden")));
+    CPPUNIT_ASSERT(aSampler.sample(0.75) == uno::Any(OUString("visible")));
+
+    animcore::AnimationSampler aEmpty(animations::AnimationCalcMode::LINEAR, {}, {}, {});
+    CPPUNIT_ASSERT(!aEmpty.isValid());
+    CPPUNIT_ASSERT(!aEmpty.sample(0.5).hasValue());
+}
+
+void AnimationsSamplerTest::testBulk()
+{
+    animcore::AnimationSampler aSampler(animations::AnimationCalcMode::LINEAR, { 0.0, 0.2, 0.7, 1.0 },
+                                        { uno::Any(0.0), uno::Any(4.0), uno::Any(-1.0), uno::Any(8.0) },
+                                        {});
+    std::vector<double> aTimes;
+    for (int i = 0; i <= 100; ++i)
+        aTimes.push_back(i / 100.0);
+
+    // ascending, as for a timeline preview, and in no order, give the same as single samples
+    std::vector<uno::Any> aAscending = aSampler.sample(aTimes);
+    std::vector<double> aShuffled(aTimes.rbegin(), aTimes.rend());
+    std::swap(aShuffled[10], aShuffled[60]);
+    std::vector<uno::Any> aDescending = aSampler.sample(aShuffled);
+    CPPUNIT_ASSERT_EQUAL(aTimes.size(), aAscending.size());
+    CPPUNIT_ASSERT_EQUAL(aTimes.size(), aDescending.size());
+
+    animcore::AnimationSampler aSingle(animations::AnimationCalcMode::LINEAR, { 0.0, 0.2, 0.7, 1.0 },
+                                       { uno::Any(0.0), uno::Any(4.0), uno::Any(-1.0), uno::Any(8.0) },
+                                       {});
+    for (size_t i = 0; i < aTimes.size(); ++i)
+    {
+        const double fExpected = toDouble(aSingle.sample(aTimes[i]));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(fExpected, toDouble(aAscending[i]), 1E-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(toDouble(aSingle.sample(aShuffled[i])), toDouble(aDescending[i]), 1E-9);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, toDouble(aAscending[20]), 1E-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, toDouble(aAscending[45]), 1E-9);
+}
+
+void AnimationsSamplerTest::testCreate()
+{
+    uno::Reference<animations::XAnimate> xAnimate(createNode(com_sun_star_animations_Animate_get_implementation));
+    xAnimate->setCalcMode(animations::AnimationCalcMode::LINEAR);
+    xAnimate->setValues({ uno::Any(0.0), uno::Any(10.0) });
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, toDouble(animcore::AnimationSampler::create(xAnimate).sample(0.25)), 1E-9);
+
+    // from and to, or from and by, when there are no values
+    xAnimate->setValues({});
+    xAnimate->setFrom(uno::Any(1.0));
+    xAnimate->setTo(uno::Any(3.0));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, toDouble(animcore::AnimationSampler::create(xAnimate).sample(0.5)), 1E-9);
+    xAnimate->setTo(uno::Any());
+    xAnimate->setBy(uno::Any(4.0));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, toDouble(animcore::AnimationSampler::create(xAnimate).sample(0.5)), 1E-9);
+
+    // a set node has the value it sets all the time
+    uno::Reference<animations::XAnimate> xSet(createNode(com_sun_star_animations_AnimateSet_get_implementation));
+    xSet->setTo(uno::Any(OUString("visible")));
+    CPPUNIT_ASSERT(animcore::AnimationSampler::create(xSet).sample(0.0) == uno::Any(OUString("visible")));
+
+    CPPUNIT_ASSERT_THROW(animcore::AnimationSampler::create(nullptr), lang::IllegalArgumentException);
+}
+
+void AnimationsSamplerTest::testHSL()
+{
+    const uno::Sequence<uno::Any> aRedToBlue{ uno::Any(sal_Int32(0xff0000)), uno::Any(sal_Int32(0x0000ff)) };
+
+    // clockwise the hue decreases, from red through magenta to blue
+    animcore::AnimationSampler aClockwise(animations::AnimationCalcMode::LINEAR, {}, aRedToBlue, {},
+                                          animcore::AnimationSampler::Colors::HSLClockwise);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0xff0000), toColor(aClockwise.sample(0.0)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0xff00ff), toColor(aClockwise.sample(0.5)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x0000ff), toColor(aClockwise.sample(1.0)));
+
+    // counterclockwise it increases, through green
+    animcore::AnimationSampler aCounterClockwise(animations::AnimationCalcMode::LINEAR, {}, aRedToBlue, {},
+                                                 animcore::AnimationSampler::Colors::HSLCounterClockwise);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x00ff00), toColor(aCounterClockwise.sample(0.5)));
+
+    // while in RGB it is a mix of the channels
+    animcore::AnimationSampler aRGB(animations::AnimationCalcMode::LINEAR, {}, aRedToBlue, {},
+                                    animcore::AnimationSampler::Colors::RGB);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x800080), toColor(aRGB.sample(0.5)));
+
+    // HSL values may also be given as hue in degrees, saturation and lightness, and are
+    // sampled as RGB, in discrete mode too
+    animcore::AnimationSampler aTriples(
+        animations::AnimationCalcMode::DISCRETE, {},
+        { uno::Any(uno::Sequence<double>{ 120.0, 1.0, 0.5 }), uno::Any(uno::Sequence<double>{ 0.0, 0.0, 1.0 }) },
+        {}, animcore::AnimationSampler::Colors::HSLCounterClockwise);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x00ff00), toColor(aTriples.sample(0.25)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0xffffff), toColor(aTriples.sample(0.75)));
+}
+
+void AnimationsSamplerTest::testCreateColor()
+{
+    uno::Reference<animations::XAnimate> xAnimate(createNode(com_sun_star_animations_AnimateColor_get_implementation));
+    uno::Reference<animations::XAnimateColor> xColor(xAnimate, uno::UNO_QUERY_THROW);
+    xAnimate->setCalcMode(animations::AnimationCalcMode::LINEAR);
+
+    // from and by in RGB add per channel, each up to its maximum
+    xAnimate->setFrom(uno::Any(sal_Int32(0x102030)));
+    xAnimate->setBy(uno::Any(sal_Int32(0x0101f0)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x102030), toColor(animcore::AnimationSampler::create(xAnimate).sample(0.0)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x112198), toColor(animcore::AnimationSampler::create(xAnimate).sample(0.5)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x1121ff), toColor(animcore::AnimationSampler::create(xAnimate).sample(1.0)));
+
+    // in HSL, by is a hue in degrees, a saturation and a lightness, and the hue goes round
+    // in the direction of the node
+    xColor->setColorInterpolation(animations::AnimationColorSpace::HSL);
+    xAnimate->setFrom(uno::Any(sal_Int32(0xff0000)));
+    xAnimate->setBy(uno::Any(uno::Sequence<double>{ 120.0, 0.0, 0.0 }));
+    xColor->setDirection(false);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0xffff00), toColor(animcore::AnimationSampler::create(xAnimate).sample(0.5)));
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x00ff00), toColor(animcore::AnimationSampler::create(xAnimate).sample(1.0)));
+    xColor->setDirection(true);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(0x0000ff), toColor(animcore::AnimationSampler::create(xAnimate).sample(0.5)));
+
+    // a by value that is no HSL triple cannot be added
+    xAnimate->setBy(uno::Any(sal_Int32(0x000010)));
+    CPPUNIT_ASSERT(!animcore::AnimationSampler::create(xAnimate).isValid());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AnimationsSamplerTest);
+
+}
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
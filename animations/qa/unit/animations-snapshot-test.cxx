@@ -0,0 +1,269 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/plugin/TestPlugIn.h>
+
+#include <com/sun/star/animations/AnimationCalcMode.hpp>
+#include <com/sun/star/animations/AnimationFill.hpp>
+#include <com/sun/star/animations/Event.hpp>
+#include <com/sun/star/animations/EventTrigger.hpp>
+#include <com/sun/star/animations/Timing.hpp>
+#include <com/sun/star/animations/ValuePair.hpp>
+#include <com/sun/star/animations/XAnimate.hpp>
+#include <com/sun/star/animations/XAnimateColor.hpp>
+#include <com/sun/star/animations/XTimeContainer.hpp>
+#include <com/sun/star/beans/NamedValue.hpp>
+#include <com/sun/star/container/XEnumeration.hpp>
+#include <com/sun/star/container/XEnumerationAccess.hpp>
+#include <com/sun/star/lang/IllegalArgumentException.hpp>
+
+#include "animationsnapshot.hxx"
+
+using namespace ::com::sun::star;
+
+// the factories of the nodes, from the objects of the animcore library
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_ParallelTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_SequenceTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_Animate_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_AnimateColor_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+namespace
+{
+
+typedef uno::XInterface* (SAL_CALL * Factory_t)(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+uno::Reference<animations::XAnimationNode> createNode(Factory_t pFactory)
+{
+    uno::Reference<uno::XInterface> xNode(pFactory(nullptr, uno::Sequence<uno::Any>()), SAL_NO_ACQUIRE);
+    return uno::Reference<animations::XAnimationNode>(xNode, uno::UNO_QUERY_THROW);
+}
+
+/// Tests the binary snapshots of animation node trees
+class AnimationsSnapshotTest : public CppUnit::TestFixture
+{
+public:
+    void testRoundTrip();
+    void testAttributes();
+    void testEventSource();
+    void testReferences();
+    void testDamaged();
+
+    CPPUNIT_TEST_SUITE(AnimationsSnapshotTest);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testAttributes);
+    CPPUNIT_TEST(testEventSource);
+    CPPUNIT_TEST(testReferences);
+    CPPUNIT_TEST(testDamaged);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// a main sequence with an effect of an animate and an animate color node
+    uno::Reference<animations::XAnimationNode> createTree();
+
+    /// stands in for the shape that is animated
+    uno::Reference<animations::XAnimationNode> mxShape;
+};
+
+uno::Reference<animations::XAnimationNode> AnimationsSnapshotTest::createTree()
+{
+    if (!mxShape.is())
+        mxShape = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+
+    uno::Reference<animations::XAnimationNode> xRoot
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    uno::Reference<animations::XAnimationNode> xSequence
+        = createNode(com_sun_star_animations_SequenceTimeContainer_get_implementation);
+    uno::Reference<animations::XAnimationNode> xEffect
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+
+    beans::NamedValue aNodeType;
+    aNodeType.Name = "node-type";
+    aNodeType.Value <<= sal_Int16(1);
+    xSequence->setUserData({ aNodeType });
+    xSequence->setBegin(uno::Any(animations::Timing_INDEFINITE));
+
+    beans::NamedValue aPresetId;
+    aPresetId.Name = "preset-id";
+    aPresetId.Value <<= OUString("ooo-entrance-appear");
+    xEffect->setUserData({ aNodeType, aPresetId });
+    xEffect->setBegin(uno::Any(0.5));
+    xEffect->setFill(animations::AnimationFill::HOLD);
+
+    uno::Reference<animations::XAnimate> xAnimate(
+        createNode(com_sun_star_animations_Animate_get_implementation), uno::UNO_QUERY_THROW);
+    xAnimate->setTarget(uno::Any(mxShape));
+    xAnimate->setAttributeName("X");
+    xAnimate->setDuration(uno::Any(2.0));
+    xAnimate->setCalcMode(animations::AnimationCalcMode::SPLINE);
+    xAnimate->setValues({ uno::Any(0.0),
+                          uno::Any(animations::ValuePair(uno::Any(sal_Int32(-1)), uno::Any(OUString("x+width")))),
+                          uno::Any(float(1.5)) });
+    xAnimate->setKeyTimes({ 0.0, 0.25, 1.0 });
+    animations::TimeFilterPair aPair;
+    aPair.Time = 0.42;
+    aPair.Progress = 0.58;
+    xAnimate->setTimeFilter({ aPair, aPair, aPair, aPair });
+    xAnimate->setAutoReverse(true);
+
+    uno::Reference<animations::XAnimateColor> xColor(
+        createNode(com_sun_star_animations_AnimateColor_get_implementation), uno::UNO_QUERY_THROW);
+    xColor->setTarget(uno::Any(mxShape));
+    xColor->setAttributeName("FillColor");
+    xColor->setTo(uno::Any(sal_Int32(0xff0000)));
+    xColor->setDirection(false);
+
+    uno::Reference<animations::XTimeContainer> xEffectContainer(xEffect, uno::UNO_QUERY_THROW);
+    xEffectContainer->appendChild(xAnimate);
+    xEffectContainer->appendChild(xColor);
+    uno::Reference<animations::XTimeContainer>(xSequence, uno::UNO_QUERY_THROW)->appendChild(xEffect);
+    uno::Reference<animations::XTimeContainer>(xRoot, uno::UNO_QUERY_THROW)->appendChild(xSequence);
+    return xRoot;
+}
+
+void AnimationsSnapshotTest::testRoundTrip()
+{
+    animcore::AnimationSnapshot aSnapshot = animcore::AnimationSnapshot::create(createTree());
+    uno::Reference<animations::XAnimationNode> xRestored = aSnapshot.restore();
+    CPPUNIT_ASSERT(xRestored.is());
+
+    // the restored tree encodes to the same bytes, with the same referenced objects
+    animcore::AnimationSnapshot aSecond = animcore::AnimationSnapshot::create(xRestored);
+    CPPUNIT_ASSERT(aSnapshot == aSecond);
+}
+
+void AnimationsSnapshotTest::testAttributes()
+{
+    uno::Reference<animations::XAnimationNode> xRestored
+        = animcore::AnimationSnapshot::create(createTree()).restore();
+
+    uno::Reference<container::XEnumerationAccess> xRootAccess(xRestored, uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimationNode> xSequence(
+        xRootAccess->createEnumeration()->nextElement(), uno::UNO_QUERY_THROW);
+    CPPUNIT_ASSERT(uno::Reference<uno::XInterface>(xRestored, uno::UNO_QUERY) == xSequence->getParent());
+    CPPUNIT_ASSERT(xSequence->getBegin() == uno::Any(animations::Timing_INDEFINITE));
+
+    uno::Reference<container::XEnumerationAccess> xSequenceAccess(xSequence, uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimationNode> xEffect(
+        xSequenceAccess->createEnumeration()->nextElement(), uno::UNO_QUERY_THROW);
+    CPPUNIT_ASSERT_EQUAL(sal_Int16(animations::AnimationFill::HOLD), xEffect->getFill());
+    CPPUNIT_ASSERT(xEffect->getBegin() == uno::Any(0.5));
+    const uno::Sequence<beans::NamedValue> aUserData = xEffect->getUserData();
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(2), aUserData.getLength());
+    CPPUNIT_ASSERT_EQUAL(OUString("preset-id"), aUserData[1].Name);
+    CPPUNIT_ASSERT(aUserData[1].Value == uno::Any(OUString("ooo-entrance-appear")));
+
+    uno::Reference<container::XEnumerationAccess> xEffectAccess(xEffect, uno::UNO_QUERY_THROW);
+    uno::Reference<container::XEnumeration> xChildren = xEffectAccess->createEnumeration();
+    uno::Reference<animations::XAnimate> xAnimate(xChildren->nextElement(), uno::UNO_QUERY_THROW);
+    CPPUNIT_ASSERT(xAnimate->getTarget() == uno::Any(mxShape));
+    CPPUNIT_ASSERT_EQUAL(OUString("X"), xAnimate->getAttributeName());
+    CPPUNIT_ASSERT_EQUAL(animations::AnimationCalcMode::SPLINE, xAnimate->getCalcMode());
+    CPPUNIT_ASSERT(xAnimate->getAutoReverse());
+    const uno::Sequence<uno::Any> aValues = xAnimate->getValues();
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(3), aValues.getLength());
+    CPPUNIT_ASSERT(aValues[1] == uno::Any(animations::ValuePair(uno::Any(sal_Int32(-1)), uno::Any(OUString("x+width")))));
+    CPPUNIT_ASSERT(aValues[2] == uno::Any(float(1.5)));
+    CPPUNIT_ASSERT_EQUAL(0.25, xAnimate->getKeyTimes()[1]);
+    CPPUNIT_ASSERT_EQUAL(sal_Int32(4), xAnimate->getTimeFilter().getLength());
+
+    uno::Reference<animations::XAnimateColor> xColor(xChildren->nextElement(), uno::UNO_QUERY_THROW);
+    CPPUNIT_ASSERT(!xColor->getDirection());
+    CPPUNIT_ASSERT(xColor->getTo() == uno::Any(sal_Int32(0xff0000)));
+    CPPUNIT_ASSERT(!xChildren->hasMoreElements());
+}
+
+void AnimationsSnapshotTest::testEventSource()
+{
+    uno::Reference<animations::XAnimationNode> xRoot = createTree();
+    uno::Reference<container::XEnumerationAccess> xRootAccess(xRoot, uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimationNode> xSequence(
+        xRootAccess->createEnumeration()->nextElement(), uno::UNO_QUERY_THROW);
+
+    // the root begins when a node that comes later in the tree ends
+    animations::Event aEvent;
+    aEvent.Source <<= xSequence;
+    aEvent.Trigger = animations::EventTrigger::END_EVENT;
+    aEvent.Offset <<= 1.0;
+    xRoot->setBegin(uno::Any(aEvent));
+
+    uno::Reference<animations::XAnimationNode> xRestored
+        = animcore::AnimationSnapshot::create(xRoot).restore();
+
+    // the event source is the restored node, not the original one
+    uno::Reference<container::XEnumerationAccess> xRestoredAccess(xRestored, uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimationNode> xRestoredSequence(
+        xRestoredAccess->createEnumeration()->nextElement(), uno::UNO_QUERY_THROW);
+    animations::Event aRestoredEvent;
+    CPPUNIT_ASSERT(xRestored->getBegin() >>= aRestoredEvent);
+    CPPUNIT_ASSERT(aRestoredEvent.Source == uno::Any(xRestoredSequence));
+    CPPUNIT_ASSERT_EQUAL(animations::EventTrigger::END_EVENT, aRestoredEvent.Trigger);
+    CPPUNIT_ASSERT(aRestoredEvent.Offset == uno::Any(1.0));
+}
+
+void AnimationsSnapshotTest::testReferences()
+{
+    animcore::AnimationSnapshot aSnapshot = animcore::AnimationSnapshot::create(createTree());
+
+    // both effect nodes animate the same shape, which is referenced once
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aSnapshot.getReferences().size());
+    CPPUNIT_ASSERT(aSnapshot.getReferences()[0] == uno::Any(mxShape));
+
+    // another shape, as when the slide is copied to another document
+    uno::Reference<animations::XAnimationNode> xOtherShape
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    aSnapshot.setReferences({ uno::Any(xOtherShape) });
+    CPPUNIT_ASSERT_THROW(aSnapshot.setReferences({}), lang::IllegalArgumentException);
+
+    animcore::AnimationSnapshot aCopy = animcore::AnimationSnapshot::create(aSnapshot.restore());
+    CPPUNIT_ASSERT(aCopy == aSnapshot);
+    CPPUNIT_ASSERT(aCopy.getReferences()[0] == uno::Any(xOtherShape));
+}
+
+void AnimationsSnapshotTest::testDamaged()
+{
+    animcore::AnimationSnapshot aSnapshot = animcore::AnimationSnapshot::create(createTree());
+    const std::vector<sal_uInt8>& rData = aSnapshot.getData();
+
+    // every truncation is detected
+    for (size_t i = 0; i < rData.size(); ++i)
+    {
+        animcore::AnimationSnapshot aTruncated(
+            std::vector<sal_uInt8>(rData.begin(), rData.begin() + i), aSnapshot.getReferences());
+        CPPUNIT_ASSERT_THROW(aTruncated.restore(), lang::IllegalArgumentException);
+    }
+
+    // a newer version is refused
+    std::vector<sal_uInt8> aNewer(rData);
+    aNewer[4] = animcore::AnimationSnapshot::nFormatVersion + 1;
+    CPPUNIT_ASSERT_THROW(animcore::AnimationSnapshot(aNewer, aSnapshot.getReferences()).restore(),
+                         lang::IllegalArgumentException);
+
+    // the data must not refer to more objects than there are
+    CPPUNIT_ASSERT_THROW(animcore::AnimationSnapshot(rData, std::vector<uno::Any>()).restore(),
+                         lang::IllegalArgumentException);
+
+    CPPUNIT_ASSERT_THROW(animcore::AnimationSnapshot::create(nullptr), lang::IllegalArgumentException);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AnimationsSnapshotTest);
+
+}
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,236 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <set>
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/plugin/TestPlugIn.h>
+
+#include <com/sun/star/animations/XAnimate.hpp>
+#include <com/sun/star/animations/XTimeContainer.hpp>
+#include <com/sun/star/beans/NamedValue.hpp>
+#include <com/sun/star/container/XEnumeration.hpp>
+#include <com/sun/star/container/XEnumerationAccess.hpp>
+#include <com/sun/star/lang/IllegalArgumentException.hpp>
+
+#include "animationstructure.hxx"
+
+using namespace ::com::sun::star;
+
+// the factories of the nodes, from the objects of the animcore library
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_ParallelTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_SequenceTimeContainer_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+extern "C" uno::XInterface* SAL_CALL
+com_sun_star_animations_Animate_get_implementation(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+namespace
+{
+
+typedef uno::XInterface* (SAL_CALL * Factory_t)(uno::XComponentContext*, uno::Sequence<uno::Any> const &);
+
+uno::Reference<animations::XAnimationNode> createNode(Factory_t pFactory)
+{
+    uno::Reference<uno::XInterface> xNode(pFactory(nullptr, uno::Sequence<uno::Any>()), SAL_NO_ACQUIRE);
+    return uno::Reference<animations::XAnimationNode>(xNode, uno::UNO_QUERY_THROW);
+}
+
+beans::NamedValue makeNamedValue(const OUString& rName, const uno::Any& rValue)
+{
+    beans::NamedValue aValue;
+    aValue.Name = rName;
+    aValue.Value = rValue;
+    return aValue;
+}
+
+const int nTemplates = 3;
+const int nSlides = 10;
+const int nEffectsPerSlide = 30;
+
+/// Tests comparing effects apart from their targets, and sharing their payloads
+class AnimationsStructureTest : public CppUnit::TestFixture
+{
+public:
+    void testEqualsStructure();
+    void testChangeInvalidatesHash();
+    void testSharePayloads();
+    void testForeignNode();
+
+    CPPUNIT_TEST_SUITE(AnimationsStructureTest);
+    CPPUNIT_TEST(testEqualsStructure);
+    CPPUNIT_TEST(testChangeInvalidatesHash);
+    CPPUNIT_TEST(testSharePayloads);
+    CPPUNIT_TEST(testForeignNode);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /** an effect made from one of the templates that animates the given shape, with
+        all its sequences built anew, as an import would
+    */
+    static uno::Reference<animations::XAnimationNode> createEffect(int nTemplate,
+                                                                   const uno::Reference<uno::XInterface>& rxShape);
+    /// the main sequences of a deck generated from the templates, each effect with a shape of its own
+    static std::vector<uno::Reference<animations::XAnimationNode>> createDeck();
+
+    static uno::Reference<animations::XAnimate> getAnimate(const uno::Reference<animations::XAnimationNode>& rxEffect);
+};
+
+uno::Reference<animations::XAnimationNode> AnimationsStructureTest::createEffect(
+    int nTemplate, const uno::Reference<uno::XInterface>& rxShape)
+{
+    uno::Reference<animations::XAnimationNode> xEffect
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    xEffect->setUserData({ makeNamedValue("node-type", uno::Any(sal_Int16(1))),
+                           makeNamedValue("preset-id", uno::Any(OUString("ooo-entrance-" + OUString::number(nTemplate)))) });
+
+    uno::Reference<animations::XAnimate> xAnimate(
+        createNode(com_sun_star_animations_Animate_get_implementation), uno::UNO_QUERY_THROW);
+    xAnimate->setTarget(uno::Any(rxShape));
+    xAnimate->setAttributeName(nTemplate == 0 ? OUString("Opacity") : OUString("X"));
+    xAnimate->setDuration(uno::Any(0.5 * (nTemplate + 1)));
+    xAnimate->setKeyTimes({ 0.0, 0.5, 1.0 });
+    xAnimate->setValues({ uno::Any(0.0), uno::Any(0.5 * nTemplate), uno::Any(1.0) });
+    uno::Reference<animations::XTimeContainer>(xEffect, uno::UNO_QUERY_THROW)->appendChild(xAnimate);
+    return xEffect;
+}
+
+std::vector<uno::Reference<animations::XAnimationNode>> AnimationsStructureTest::createDeck()
+{
+    std::vector<uno::Reference<animations::XAnimationNode>> aRoots;
+    for (int nSlide = 0; nSlide < nSlides; ++nSlide)
+    {
+        uno::Reference<animations::XTimeContainer> xSequence(
+            createNode(com_sun_star_animations_SequenceTimeContainer_get_implementation), uno::UNO_QUERY_THROW);
+        for (int nEffect = 0; nEffect < nEffectsPerSlide; ++nEffect)
+        {
+            uno::Reference<uno::XInterface> xShape
+                = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+            xSequence->appendChild(createEffect(nEffect % nTemplates, xShape));
+        }
+        aRoots.push_back(uno::Reference<animations::XAnimationNode>(xSequence, uno::UNO_QUERY_THROW));
+    }
+    return aRoots;
+}
+
+uno::Reference<animations::XAnimate> AnimationsStructureTest::getAnimate(
+    const uno::Reference<animations::XAnimationNode>& rxEffect)
+{
+    uno::Reference<container::XEnumerationAccess> xAccess(rxEffect, uno::UNO_QUERY_THROW);
+    return uno::Reference<animations::XAnimate>(xAccess->createEnumeration()->nextElement(), uno::UNO_QUERY_THROW);
+}
+
+void AnimationsStructureTest::testEqualsStructure()
+{
+    uno::Reference<uno::XInterface> xFirstShape
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    uno::Reference<uno::XInterface> xSecondShape
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+
+    // effects that differ only in their targets are alike
+    uno::Reference<animations::XAnimationNode> xFirst = createEffect(0, xFirstShape);
+    uno::Reference<animations::XAnimationNode> xSecond = createEffect(0, xSecondShape);
+    CPPUNIT_ASSERT_EQUAL(animcore::getStructureHash(xFirst), animcore::getStructureHash(xSecond));
+    CPPUNIT_ASSERT(animcore::equalsStructure(xFirst, xSecond));
+
+    // others are not
+    uno::Reference<animations::XAnimationNode> xOther = createEffect(1, xFirstShape);
+    CPPUNIT_ASSERT(!animcore::equalsStructure(xFirst, xOther));
+    CPPUNIT_ASSERT(!animcore::equalsStructure(xOther, xSecond));
+}
+
+void AnimationsStructureTest::testChangeInvalidatesHash()
+{
+    uno::Reference<uno::XInterface> xShape
+        = createNode(com_sun_star_animations_ParallelTimeContainer_get_implementation);
+    uno::Reference<animations::XAnimationNode> xFirst = createEffect(0, xShape);
+    uno::Reference<animations::XAnimationNode> xSecond = createEffect(0, xShape);
+    CPPUNIT_ASSERT(animcore::equalsStructure(xFirst, xSecond));
+
+    // a change of a child reaches the cached hash of its effect
+    uno::Reference<animations::XAnimate> xAnimate = getAnimate(xSecond);
+    xAnimate->setDuration(uno::Any(2.0));
+    CPPUNIT_ASSERT(!animcore::equalsStructure(xFirst, xSecond));
+    xAnimate->setDuration(uno::Any(0.5));
+    CPPUNIT_ASSERT(animcore::equalsStructure(xFirst, xSecond));
+    xAnimate->setKeyTimes({ 0.0, 0.25, 1.0 });
+    CPPUNIT_ASSERT(!animcore::equalsStructure(xFirst, xSecond));
+}
+
+void AnimationsStructureTest::testSharePayloads()
+{
+    std::vector<uno::Reference<animations::XAnimationNode>> aRoots = createDeck();
+
+    // the buffers that hold the payloads, which only exist once each when shared
+    auto countBuffers = [&aRoots](std::set<const void*>& rValues, std::set<const void*>& rKeyTimes,
+                                  std::set<const void*>& rUserData)
+    {
+        for (const auto& rxRoot : aRoots)
+        {
+            uno::Reference<container::XEnumerationAccess> xAccess(rxRoot, uno::UNO_QUERY_THROW);
+            uno::Reference<container::XEnumeration> xEnumeration = xAccess->createEnumeration();
+            while (xEnumeration->hasMoreElements())
+            {
+                uno::Reference<animations::XAnimationNode> xEffect(xEnumeration->nextElement(), uno::UNO_QUERY_THROW);
+                uno::Reference<animations::XAnimate> xAnimate = getAnimate(xEffect);
+                rValues.insert(xAnimate->getValues().getConstArray());
+                rKeyTimes.insert(xAnimate->getKeyTimes().getConstArray());
+                rUserData.insert(xEffect->getUserData().getConstArray());
+            }
+        }
+    };
+
+    const size_t nEffects = nSlides * nEffectsPerSlide;
+    std::set<const void*> aValues, aKeyTimes, aUserData;
+    countBuffers(aValues, aKeyTimes, aUserData);
+    CPPUNIT_ASSERT_EQUAL(nEffects, aValues.size());
+    CPPUNIT_ASSERT_EQUAL(nEffects, aKeyTimes.size());
+    CPPUNIT_ASSERT_EQUAL(nEffects, aUserData.size());
+
+    // once shared, the memory grows with the distinct effects instead of all of them
+    animcore::sharePayloads(aRoots);
+    aValues.clear();
+    aKeyTimes.clear();
+    aUserData.clear();
+    countBuffers(aValues, aKeyTimes, aUserData);
+    CPPUNIT_ASSERT_EQUAL(size_t(nTemplates), aValues.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aKeyTimes.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(nTemplates), aUserData.size());
+
+    // and a node that is changed afterwards gets a buffer of its own again
+    uno::Reference<container::XEnumerationAccess> xAccess(aRoots[0], uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimationNode> xEffect(xAccess->createEnumeration()->nextElement(),
+                                                       uno::UNO_QUERY_THROW);
+    uno::Reference<animations::XAnimate> xAnimate = getAnimate(xEffect);
+    xAnimate->setKeyTimes({ 0.0, 0.25, 1.0 });
+    aValues.clear();
+    aKeyTimes.clear();
+    aUserData.clear();
+    countBuffers(aValues, aKeyTimes, aUserData);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), aKeyTimes.size());
+    CPPUNIT_ASSERT_EQUAL(0.25, xAnimate->getKeyTimes()[1]);
+}
+
+void AnimationsStructureTest::testForeignNode()
+{
+    CPPUNIT_ASSERT_THROW(animcore::getStructureHash(nullptr), lang::IllegalArgumentException);
+    CPPUNIT_ASSERT_THROW(animcore::sharePayloads({ nullptr }), lang::IllegalArgumentException);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AnimationsStructureTest);
+
+}
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
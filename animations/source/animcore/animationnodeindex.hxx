@@ -0,0 +1,53 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONNODEINDEX_HXX
+#define INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONNODEINDEX_HXX
+
+#include <com/sun/star/animations/XAnimationNode.hpp>
+#include <com/sun/star/uno/Any.hxx>
+#include <com/sun/star/uno/Reference.hxx>
+#include <rtl/ustring.hxx>
+
+#include <vector>
+
+namespace animcore
+{
+
+/*  Queries for the nodes of an animation tree, like the effects of a shape that is
+    deleted or all effects of a preset, without walking the tree and copying the user
+    data of every node.
+
+    The first query creates an index at the root of the tree, which is kept up to date
+    from then on, so that a query costs as much as the nodes it finds.
+*/
+
+/** all nodes in the tree that rxNode is in with the given target
+
+    @throws css::lang::IllegalArgumentException
+        if rxNode is not implemented by this library
+*/
+std::vector< css::uno::Reference< css::animations::XAnimationNode > > findNodesByTarget(
+    const css::uno::Reference< css::animations::XAnimationNode >& rxNode, const css::uno::Any& rTarget );
+
+/** all nodes in the tree that rxNode is in with the given user data entry, like
+    "preset-id" or "node-type"
+
+    @throws css::lang::IllegalArgumentException
+        if rxNode is not implemented by this library
+*/
+std::vector< css::uno::Reference< css::animations::XAnimationNode > > findNodesByUserData(
+    const css::uno::Reference< css::animations::XAnimationNode >& rxNode,
+    const OUString& rName, const css::uno::Any& rValue );
+
+} // namespace animcore
+
+#endif // INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONNODEINDEX_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
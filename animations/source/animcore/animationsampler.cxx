@@ -0,0 +1,441 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "animationsampler.hxx"
+
+#include <com/sun/star/animations/AnimationCalcMode.hpp>
+#include <com/sun/star/animations/ValuePair.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using ::com::sun::star::uno::Any;
+using ::com::sun::star::uno::Sequence;
+using ::com::sun::star::animations::TimeFilterPair;
+using ::com::sun::star::animations::ValuePair;
+
+namespace AnimationCalcMode = ::com::sun::star::animations::AnimationCalcMode;
+
+namespace animcore
+{
+
+namespace
+{
+
+/// the channels of a color are its transparency and its red, green and blue, or hue, saturation and lightness
+const size_t nColorChannels = 4;
+
+sal_uInt32 toByte( double fValue )
+{
+    return static_cast< sal_uInt32 >( std::min( std::max( std::lround( fValue ), 0L ), 255L ) );
+}
+
+/// the hue in turns from 0 to 1, saturation and lightness of the red, green and blue of nColor
+void rgbToHsl( sal_uInt32 nColor, double* pHsl )
+{
+    const double fRed = ( ( nColor >> 16 ) & 0xff ) / 255.0;
+    const double fGreen = ( ( nColor >> 8 ) & 0xff ) / 255.0;
+    const double fBlue = ( nColor & 0xff ) / 255.0;
+    const double fMax = std::max( std::max( fRed, fGreen ), fBlue );
+    const double fMin = std::min( std::min( fRed, fGreen ), fBlue );
+    const double fDelta = fMax - fMin;
+
+    pHsl[0] = 0.0;
+    pHsl[1] = 0.0;
+    pHsl[2] = ( fMax + fMin ) / 2.0;
+    if( fDelta <= 0.0 )
+        return;
+
+    pHsl[1] = pHsl[2] > 0.5 ? fDelta / ( 2.0 - fMax - fMin ) : fDelta / ( fMax + fMin );
+    if( fMax == fRed )
+        pHsl[0] = ( fGreen - fBlue ) / fDelta + ( fGreen < fBlue ? 6.0 : 0.0 );
+    else if( fMax == fGreen )
+        pHsl[0] = ( fBlue - fRed ) / fDelta + 2.0;
+    else
+        pHsl[0] = ( fRed - fGreen ) / fDelta + 4.0;
+    pHsl[0] /= 6.0;
+}
+
+double hueToChannel( double fLow, double fHigh, double fHue )
+{
+    fHue -= std::floor( fHue );
+    if( fHue < 1.0 / 6.0 )
+        return fLow + ( fHigh - fLow ) * 6.0 * fHue;
+    if( fHue < 0.5 )
+        return fHigh;
+    if( fHue < 2.0 / 3.0 )
+        return fLow + ( fHigh - fLow ) * ( 2.0 / 3.0 - fHue ) * 6.0;
+    return fLow;
+}
+
+/// the red, green and blue of a hue in turns, which may be outside of [0,1), saturation and lightness
+sal_uInt32 hslToRgb( const double* pHsl )
+{
+    const double fSaturation = std::min( std::max( pHsl[1], 0.0 ), 1.0 );
+    const double fLightness = std::min( std::max( pHsl[2], 0.0 ), 1.0 );
+    const double fHigh = fLightness <= 0.5 ? fLightness * ( 1.0 + fSaturation )
+                                           : fLightness + fSaturation - fLightness * fSaturation;
+    const double fLow = 2.0 * fLightness - fHigh;
+    return ( toByte( 255.0 * hueToChannel( fLow, fHigh, pHsl[0] + 1.0 / 3.0 ) ) << 16 )
+        | ( toByte( 255.0 * hueToChannel( fLow, fHigh, pHsl[0] ) ) << 8 )
+        | toByte( 255.0 * hueToChannel( fLow, fHigh, pHsl[0] - 1.0 / 3.0 ) );
+}
+
+bool unpackColor( const Any& rValue, AnimationSampler::Colors eColors, double* pChannels )
+{
+    sal_Int32 nColor = 0;
+    if( rValue >>= nColor )
+    {
+        const sal_uInt32 nUnsigned = static_cast< sal_uInt32 >( nColor );
+        if( eColors == AnimationSampler::Colors::RGB )
+        {
+            for( size_t c = 0; c < nColorChannels; ++c )
+                pChannels[c] = ( nUnsigned >> ( 24 - 8 * c ) ) & 0xff;
+        }
+        else
+        {
+            pChannels[0] = nUnsigned >> 24;
+            rgbToHsl( nUnsigned, pChannels + 1 );
+        }
+        return true;
+    }
+
+    // hue in degrees, saturation and lightness
+    Sequence< double > aHsl;
+    if( eColors == AnimationSampler::Colors::RGB || !( rValue >>= aHsl ) || aHsl.getLength() != 3 )
+        return false;
+    pChannels[0] = 0.0;
+    pChannels[1] = aHsl[0] / 360.0 - std::floor( aHsl[0] / 360.0 );
+    pChannels[2] = aHsl[1];
+    pChannels[3] = aHsl[2];
+    return true;
+}
+
+Any packColor( const double* pChannels, AnimationSampler::Colors eColors )
+{
+    sal_uInt32 nColor = toByte( pChannels[0] ) << 24;
+    if( eColors == AnimationSampler::Colors::RGB )
+    {
+        for( size_t c = 1; c < nColorChannels; ++c )
+            nColor |= toByte( pChannels[c] ) << ( 24 - 8 * c );
+    }
+    else
+        nColor |= hslToRgb( pChannels + 1 );
+    return Any( static_cast< sal_Int32 >( nColor ) );
+}
+
+}
+
+AnimationSampler::AnimationSampler( sal_Int16 nCalcMode,
+                                    const Sequence< double >& rKeyTimes,
+                                    const Sequence< Any >& rValues,
+                                    const Sequence< TimeFilterPair >& rKeySplines,
+                                    Colors eColors )
+:   mnCalcMode( nCalcMode ),
+    meKind( ValueKind::Other ),
+    meColors( eColors ),
+    mnChannels( 0 ),
+    maValues( rValues.begin(), rValues.end() ),
+    mnLastSegment( 0 )
+{
+    if( maValues.empty() )
+        return;
+
+    ValuePair aPair;
+    if( meColors != Colors::None )
+    {
+        meKind = ValueKind::Color;
+        mnChannels = nColorChannels;
+    }
+    else if( maValues[0] >>= aPair )
+    {
+        meKind = ValueKind::Pair;
+        mnChannels = 2;
+    }
+    else
+    {
+        meKind = ValueKind::Number;
+        mnChannels = 1;
+    }
+
+    maChannels.resize( maValues.size() * mnChannels );
+    for( size_t i = 0; i < maValues.size(); ++i )
+    {
+        if( !unpack( maValues[i], &maChannels[ i * mnChannels ] ) )
+        {
+            // SMIL: values that cannot be interpolated are animated discretely
+            meKind = ValueKind::Other;
+            mnChannels = 0;
+            maChannels.clear();
+            mnCalcMode = AnimationCalcMode::DISCRETE;
+            break;
+        }
+    }
+
+    if( mnCalcMode == AnimationCalcMode::PACED )
+        setPacedKeyTimes();
+    else
+        setKeyTimes( rKeyTimes );
+
+    if( mnCalcMode == AnimationCalcMode::SPLINE )
+    {
+        // two control points per segment
+        if( static_cast< size_t >( rKeySplines.getLength() ) == 2 * ( maValues.size() - 1 ) )
+        {
+            maSplines.reserve( 2 * rKeySplines.getLength() );
+            for( const TimeFilterPair& rPair : rKeySplines )
+            {
+                maSplines.push_back( rPair.Time );
+                maSplines.push_back( rPair.Progress );
+            }
+        }
+        else
+            mnCalcMode = AnimationCalcMode::LINEAR;
+    }
+}
+
+
+void AnimationSampler::setKeyTimes( const Sequence< double >& rKeyTimes )
+{
+    const size_t nValues = maValues.size();
+
+    bool bValid = static_cast< size_t >( rKeyTimes.getLength() ) == nValues;
+    for( size_t i = 1; bValid && i < nValues; ++i )
+        bValid = rKeyTimes[i - 1] <= rKeyTimes[i];
+
+    if( bValid )
+    {
+        maKeyTimes.assign( rKeyTimes.begin(), rKeyTimes.end() );
+        return;
+    }
+
+    // evenly spaced; in discrete mode the last value gets a step of its own, otherwise it
+    // is reached at the end
+    const double fSteps = ( mnCalcMode == AnimationCalcMode::DISCRETE || nValues == 1 ) ? nValues : nValues - 1;
+    maKeyTimes.resize( nValues );
+    for( size_t i = 0; i < nValues; ++i )
+        maKeyTimes[i] = i / fSteps;
+}
+
+
+void AnimationSampler::setPacedKeyTimes()
+{
+    // the key times are in proportion to the distance between the values
+    const size_t nValues = maValues.size();
+    maKeyTimes.resize( nValues );
+    double fTotal = 0.0;
+    for( size_t i = 0; i < nValues; ++i )
+    {
+        if( i > 0 )
+        {
+            double fSquares = 0.0;
+            for( size_t c = 0; c < mnChannels; ++c )
+            {
+                const double fDelta = getDelta( i - 1, c );
+                fSquares += fDelta * fDelta;
+            }
+            fTotal += std::sqrt( fSquares );
+        }
+        maKeyTimes[i] = fTotal;
+    }
+
+    if( fTotal > 0.0 )
+    {
+        for( double& rKeyTime : maKeyTimes )
+            rKeyTime /= fTotal;
+    }
+    else
+        setKeyTimes( Sequence< double >() );
+}
+
+
+bool AnimationSampler::unpack( const Any& rValue, double* pChannels ) const
+{
+    switch( meKind )
+    {
+    case ValueKind::Number:
+        return rValue >>= pChannels[0];
+    case ValueKind::Pair:
+    {
+        ValuePair aPair;
+        return ( rValue >>= aPair ) && ( aPair.First >>= pChannels[0] ) && ( aPair.Second >>= pChannels[1] );
+    }
+    case ValueKind::Color:
+        return unpackColor( rValue, meColors, pChannels );
+    default:
+        return false;
+    }
+}
+
+
+double AnimationSampler::getDelta( size_t nSegment, size_t c ) const
+{
+    const double fFrom = maChannels[ nSegment * mnChannels + c ];
+    const double fTo = maChannels[ ( nSegment + 1 ) * mnChannels + c ];
+    double fDelta = fTo - fFrom;
+    // like the presentation engine, go round the hue circle in the given direction, which
+    // is a full turn for equal hues clockwise
+    if( meKind == ValueKind::Color && c == 1 )
+    {
+        if( meColors == Colors::HSLClockwise && fFrom <= fTo )
+            fDelta -= 1.0;
+        else if( meColors == Colors::HSLCounterClockwise && fFrom > fTo )
+            fDelta += 1.0;
+    }
+    return fDelta;
+}
+
+
+Any AnimationSampler::add( const Any& rFrom, const Any& rBy, Colors eColors )
+{
+    switch( eColors )
+    {
+    case Colors::None:
+    {
+        double fFrom = 0.0, fBy = 0.0;
+        if( ( rFrom >>= fFrom ) && ( rBy >>= fBy ) )
+            return Any( fFrom + fBy );
+        break;
+    }
+    case Colors::RGB:
+    {
+        double aFrom[ nColorChannels ], aBy[ nColorChannels ];
+        if( unpackColor( rFrom, eColors, aFrom ) && unpackColor( rBy, eColors, aBy ) )
+        {
+            for( size_t c = 0; c < nColorChannels; ++c )
+                aFrom[c] += aBy[c];
+            return packColor( aFrom, eColors );
+        }
+        break;
+    }
+    default:
+    {
+        double aFrom[ nColorChannels ];
+        Sequence< double > aBy;
+        if( unpackColor( rFrom, eColors, aFrom ) && ( rBy >>= aBy ) && aBy.getLength() == 3 )
+        {
+            const double fSaturation = std::min( std::max( aFrom[2] + aBy[1], 0.0 ), 1.0 );
+            const double fLightness = std::min( std::max( aFrom[3] + aBy[2], 0.0 ), 1.0 );
+            return Any( Sequence< double >{ aFrom[1] * 360.0 + aBy[0], fSaturation, fLightness } );
+        }
+        break;
+    }
+    }
+    return Any();
+}
+
+
+size_t AnimationSampler::findSegment( double fTime )
+{
+    const size_t nKeyTimes = maKeyTimes.size();
+
+    // when sampling at ascending times, it is the segment of the last sample or the next one
+    for( size_t i = mnLastSegment; i < nKeyTimes && i <= mnLastSegment + 1; ++i )
+    {
+        if( maKeyTimes[i] <= fTime && ( i + 1 == nKeyTimes || fTime < maKeyTimes[i + 1] ) )
+        {
+            mnLastSegment = i;
+            return i;
+        }
+    }
+
+    auto aIter = std::upper_bound( maKeyTimes.begin(), maKeyTimes.end(), fTime );
+    mnLastSegment = ( aIter == maKeyTimes.begin() ) ? 0 : ( aIter - maKeyTimes.begin() ) - 1;
+    return mnLastSegment;
+}
+
+
+double AnimationSampler::applySpline( size_t nSegment, double fProgress ) const
+{
+    // cubic bezier from (0,0) to (1,1) with the control points of the segment
+    const double* pSpline = &maSplines[ nSegment * 4 ];
+    auto bezier = []( double fFirst, double fSecond, double s )
+    {
+        const double r = 1.0 - s;
+        return 3.0 * r * r * s * fFirst + 3.0 * r * s * s * fSecond + s * s * s;
+    };
+
+    // x(s) is monotonic for control points within the unit square, so bisect for the s
+    // at which it reaches fProgress
+    double fLow = 0.0;
+    double fHigh = 1.0;
+    double s = fProgress;
+    for( int i = 0; i < 32; ++i )
+    {
+        s = ( fLow + fHigh ) / 2.0;
+        if( bezier( pSpline[0], pSpline[2], s ) < fProgress )
+            fLow = s;
+        else
+            fHigh = s;
+    }
+    return bezier( pSpline[1], pSpline[3], s );
+}
+
+
+Any AnimationSampler::getValue( size_t nIndex ) const
+{
+    if( meKind == ValueKind::Color )
+        return packColor( &maChannels[ nIndex * mnChannels ], meColors );
+    return maValues[ nIndex ];
+}
+
+
+Any AnimationSampler::interpolate( size_t nSegment, double fProgress ) const
+{
+    const double* pFrom = &maChannels[ nSegment * mnChannels ];
+    double aResult[ nColorChannels ];
+    for( size_t c = 0; c < mnChannels; ++c )
+        aResult[c] = pFrom[c] + getDelta( nSegment, c ) * fProgress;
+
+    switch( meKind )
+    {
+    case ValueKind::Number:
+        return Any( aResult[0] );
+    case ValueKind::Pair:
+        return Any( ValuePair( Any( aResult[0] ), Any( aResult[1] ) ) );
+    case ValueKind::Color:
+        return packColor( aResult, meColors );
+    default:
+        return maValues[ nSegment ];
+    }
+}
+
+
+Any AnimationSampler::sample( double fTime )
+{
+    if( maValues.empty() )
+        return Any();
+
+    fTime = std::min( std::max( fTime, 0.0 ), 1.0 );
+    const size_t nSegment = findSegment( fTime );
+    if( mnCalcMode == AnimationCalcMode::DISCRETE || nSegment + 1 >= maValues.size() )
+        return getValue( nSegment );
+
+    const double fLength = maKeyTimes[ nSegment + 1 ] - maKeyTimes[ nSegment ];
+    double fProgress = ( fLength > 0.0 ) ? ( fTime - maKeyTimes[ nSegment ] ) / fLength : 1.0;
+    fProgress = std::min( std::max( fProgress, 0.0 ), 1.0 );
+    if( mnCalcMode == AnimationCalcMode::SPLINE )
+        fProgress = applySpline( nSegment, fProgress );
+
+    return interpolate( nSegment, fProgress );
+}
+
+
+std::vector< Any > AnimationSampler::sample( const std::vector< double >& rTimes )
+{
+    std::vector< Any > aSamples;
+    aSamples.reserve( rTimes.size() );
+    for( double fTime : rTimes )
+        aSamples.push_back( sample( fTime ) );
+    return aSamples;
+}
+
+} // namespace animcore
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
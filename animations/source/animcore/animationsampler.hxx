@@ -0,0 +1,148 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSAMPLER_HXX
+#define INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSAMPLER_HXX
+
+#include <com/sun/star/animations/TimeFilterPair.hpp>
+#include <com/sun/star/animations/XAnimationNode.hpp>
+#include <com/sun/star/uno/Any.hxx>
+#include <com/sun/star/uno/Reference.hxx>
+#include <com/sun/star/uno/Sequence.hxx>
+
+#include <vector>
+
+namespace animcore
+{
+
+/** Computes the value of an animated attribute at a point of the simple duration,
+    following the SMIL interpolation rules for the calc modes discrete, linear, paced
+    and spline.
+
+    The key times and values of a node are turned into a table of segments once, with the
+    numeric values unpacked, so that many samples (e.g. for a timeline preview) cost a
+    lookup of the segment and an interpolation each.  The segment of the previous sample
+    is tried first, which makes sampling at ascending times O(1) per sample; other times
+    are found by binary search.
+
+    Numbers, css::animations::ValuePair of numbers and (for AnimateColor) colors are
+    interpolated; other values, like strings, and all values in discrete mode are sampled
+    as steps.  Colors are RGB colors as sal_Int32, or in HSL also a sequence of hue in
+    degrees, saturation and lightness, and are sampled as RGB colors.  They are interpolated
+    per channel in the color space of the node, and in HSL the hue goes round in the
+    direction of the node, as in the presentation engine.  Formulas, accumulation and
+    additive composition with an underlying value need the presentation engine and are not
+    applied.
+*/
+class AnimationSampler
+{
+public:
+    /// how the values are interpolated if they are colors
+    enum class Colors
+    {
+        /// they are not colors
+        None,
+        /// per channel of red, green and blue
+        RGB,
+        /// per channel of hue, saturation and lightness, with the hue decreasing
+        HSLClockwise,
+        /// per channel of hue, saturation and lightness, with the hue increasing
+        HSLCounterClockwise
+    };
+
+    /**
+        @param nCalcMode
+            one of css::animations::AnimationCalcMode
+
+        @param rKeyTimes
+            the key times, ascending from 0 to 1, one per value, or empty for evenly
+            spaced values
+
+        @param rValues
+            the values
+
+        @param rKeySplines
+            for AnimationCalcMode::SPLINE, the two control points of the cubic bezier
+            curve of each segment, as stored in XAnimate::TimeFilter
+
+        @param eColors
+            whether the values are colors (of an AnimateColor node), and in which color
+            space they are interpolated
+    */
+    AnimationSampler( sal_Int16 nCalcMode,
+                      const css::uno::Sequence< double >& rKeyTimes,
+                      const css::uno::Sequence< css::uno::Any >& rValues,
+                      const css::uno::Sequence< css::animations::TimeFilterPair >& rKeySplines,
+                      Colors eColors = Colors::None );
+
+    /** the end value of a from/by animation: the sum of two numbers, or of two colors per
+        channel of the color space, where a by value in HSL is a sequence of the hue in
+        degrees, the saturation and the lightness to add
+
+        @return
+            void if the values cannot be added
+    */
+    static css::uno::Any add( const css::uno::Any& rFrom, const css::uno::Any& rBy, Colors eColors );
+
+    /** a sampler for the values of an animate node, or for its from/to/by values or the
+        value it sets if it has none
+
+        @throws css::lang::IllegalArgumentException
+            if rxNode is not implemented by this library
+    */
+    static AnimationSampler create( const css::uno::Reference< css::animations::XAnimationNode >& rxNode );
+
+    /// there are values to sample
+    bool isValid() const { return !maValues.empty(); }
+
+    /** the value at fTime, which is clamped to the simple duration [0,1]
+     */
+    css::uno::Any sample( double fTime );
+
+    /** the values at all the given times, fastest if they are ascending
+     */
+    std::vector< css::uno::Any > sample( const std::vector< double >& rTimes );
+
+private:
+    enum class ValueKind { Number, Pair, Color, Other };
+
+    void        setKeyTimes( const css::uno::Sequence< double >& rKeyTimes );
+    void        setPacedKeyTimes();
+    bool        unpack( const css::uno::Any& rValue, double* pChannels ) const;
+    /// the change of channel c from value nSegment to the next, along the hue direction
+    double      getDelta( size_t nSegment, size_t c ) const;
+    size_t      findSegment( double fTime );
+    double      applySpline( size_t nSegment, double fProgress ) const;
+    /// value nIndex, with colors as RGB
+    css::uno::Any getValue( size_t nIndex ) const;
+    css::uno::Any interpolate( size_t nSegment, double fProgress ) const;
+
+    sal_Int16   mnCalcMode;
+    ValueKind   meKind;
+    Colors      meColors;
+    /// number of doubles per value in maChannels
+    size_t      mnChannels;
+
+    std::vector< css::uno::Any > maValues;
+    /// the start of the segment of each value, ascending
+    std::vector< double > maKeyTimes;
+    /// the values unpacked to mnChannels doubles each, if they are interpolated
+    std::vector< double > maChannels;
+    /// x1, y1, x2, y2 of the bezier curve of each segment in spline mode
+    std::vector< double > maSplines;
+
+    /// the segment of the last sample
+    size_t      mnLastSegment;
+};
+
+} // namespace animcore
+
+#endif // INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSAMPLER_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
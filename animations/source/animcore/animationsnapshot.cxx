@@ -0,0 +1,522 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "animationsnapshot.hxx"
+
+#include <com/sun/star/animations/AnimationNodeType.hpp>
+#include <com/sun/star/animations/Event.hpp>
+#include <com/sun/star/animations/ParagraphTarget.hpp>
+#include <com/sun/star/animations/Timing.hpp>
+#include <com/sun/star/animations/ValuePair.hpp>
+#include <com/sun/star/lang/IllegalArgumentException.hpp>
+#include <cppu/unotype.hxx>
+#include <rtl/ustrbuf.hxx>
+
+#include <string.h>
+#include <utility>
+
+using ::com::sun::star::uno::Any;
+using ::com::sun::star::uno::Reference;
+using ::com::sun::star::uno::Sequence;
+using ::com::sun::star::uno::UNO_QUERY;
+using ::com::sun::star::uno::XInterface;
+using ::com::sun::star::lang::IllegalArgumentException;
+using ::com::sun::star::animations::Event;
+using ::com::sun::star::animations::ParagraphTarget;
+using ::com::sun::star::animations::Timing;
+using ::com::sun::star::animations::ValuePair;
+using ::com::sun::star::animations::XAnimationNode;
+
+namespace animcore
+{
+
+namespace
+{
+
+const sal_uInt8 aMagic[4] = { 'A', 'N', 'S', 'N' };
+
+/// the first byte of an encoded Any
+enum class AnyTag : sal_uInt8
+{
+    Void, False, True, Byte, Short, UnsignedShort, Long, UnsignedLong, Hyper, UnsignedHyper,
+    Float, Double, String, ValuePair, Timing, Event, Sequence, ParagraphTarget,
+    /// a node of the tree, by its index
+    Node,
+    /// an entry of the reference table
+    Reference
+};
+
+}
+
+
+AnimationSnapshot::AnimationSnapshot()
+{
+}
+
+
+AnimationSnapshot::AnimationSnapshot( const std::vector< sal_uInt8 >& rData,
+                                      const std::vector< Any >& rReferences )
+:   maData( rData ),
+    maReferences( rReferences )
+{
+}
+
+
+void AnimationSnapshot::setReferences( const std::vector< Any >& rReferences )
+{
+    if( rReferences.size() != maReferences.size() )
+        throw IllegalArgumentException();
+    maReferences = rReferences;
+}
+
+
+bool AnimationSnapshot::operator==( const AnimationSnapshot& rOther ) const
+{
+    return maData == rOther.maData && maReferences == rOther.maReferences;
+}
+
+
+SnapshotWriter::SnapshotWriter()
+{
+    maSnapshot.maData.assign( aMagic, aMagic + sizeof( aMagic ) );
+    writeUInt( AnimationSnapshot::nFormatVersion );
+}
+
+
+void SnapshotWriter::writeNode( const Reference< XInterface >& rxNode, sal_Int16 nNodeType )
+{
+    const sal_uInt32 nIndex = maNodes.size();
+    maNodes.emplace( rxNode.get(), nIndex );
+    writeUInt( nNodeType );
+}
+
+
+void SnapshotWriter::writeUInt( sal_uInt64 nValue )
+{
+    // seven bits per byte, the high bit set on all but the last byte
+    while( nValue >= 0x80 )
+    {
+        writeByte( static_cast< sal_uInt8 >( nValue ) | 0x80 );
+        nValue >>= 7;
+    }
+    writeByte( static_cast< sal_uInt8 >( nValue ) );
+}
+
+
+void SnapshotWriter::writeInt( sal_Int64 nValue )
+{
+    // zigzag, so that small negative numbers are small too
+    writeUInt( ( static_cast< sal_uInt64 >( nValue ) << 1 ) ^ static_cast< sal_uInt64 >( nValue >> 63 ) );
+}
+
+
+void SnapshotWriter::writeBool( bool bValue )
+{
+    writeByte( bValue ? 1 : 0 );
+}
+
+
+void SnapshotWriter::writeFixed( sal_uInt64 nValue, int nBytes )
+{
+    for( int i = 0; i < nBytes; ++i )
+        writeByte( static_cast< sal_uInt8 >( nValue >> ( 8 * i ) ) );
+}
+
+
+void SnapshotWriter::writeDouble( double fValue )
+{
+    sal_uInt64 nBits;
+    memcpy( &nBits, &fValue, sizeof( nBits ) );
+    writeFixed( nBits, 8 );
+}
+
+
+void SnapshotWriter::writeString( const OUString& rValue )
+{
+    auto aIter = maStrings.find( rValue );
+    if( aIter != maStrings.end() )
+    {
+        writeUInt( aIter->second + 1 );
+        return;
+    }
+
+    const sal_uInt32 nIndex = maStrings.size();
+    maStrings.emplace( rValue, nIndex );
+    writeUInt( 0 );
+    writeUInt( rValue.getLength() );
+    for( sal_Int32 i = 0; i < rValue.getLength(); ++i )
+        writeUInt( rValue[i] );
+}
+
+
+void SnapshotWriter::writeAny( const Any& rValue )
+{
+    switch( rValue.getValueTypeClass() )
+    {
+    case css::uno::TypeClass_VOID:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Void ) );
+        return;
+    case css::uno::TypeClass_BOOLEAN:
+        writeByte( static_cast< sal_uInt8 >( rValue.get< bool >() ? AnyTag::True : AnyTag::False ) );
+        return;
+    case css::uno::TypeClass_BYTE:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Byte ) );
+        writeInt( rValue.get< sal_Int8 >() );
+        return;
+    case css::uno::TypeClass_SHORT:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Short ) );
+        writeInt( rValue.get< sal_Int16 >() );
+        return;
+    case css::uno::TypeClass_UNSIGNED_SHORT:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::UnsignedShort ) );
+        writeUInt( rValue.get< sal_uInt16 >() );
+        return;
+    case css::uno::TypeClass_LONG:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Long ) );
+        writeInt( rValue.get< sal_Int32 >() );
+        return;
+    case css::uno::TypeClass_UNSIGNED_LONG:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::UnsignedLong ) );
+        writeUInt( rValue.get< sal_uInt32 >() );
+        return;
+    case css::uno::TypeClass_HYPER:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Hyper ) );
+        writeInt( rValue.get< sal_Int64 >() );
+        return;
+    case css::uno::TypeClass_UNSIGNED_HYPER:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::UnsignedHyper ) );
+        writeUInt( rValue.get< sal_uInt64 >() );
+        return;
+    case css::uno::TypeClass_FLOAT:
+    {
+        const float fValue = rValue.get< float >();
+        sal_uInt32 nBits;
+        memcpy( &nBits, &fValue, sizeof( nBits ) );
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Float ) );
+        writeFixed( nBits, 4 );
+        return;
+    }
+    case css::uno::TypeClass_DOUBLE:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::Double ) );
+        writeDouble( rValue.get< double >() );
+        return;
+    case css::uno::TypeClass_STRING:
+        writeByte( static_cast< sal_uInt8 >( AnyTag::String ) );
+        writeString( rValue.get< OUString >() );
+        return;
+    case css::uno::TypeClass_ENUM:
+        if( rValue.getValueType() == cppu::UnoType< Timing >::get() )
+        {
+            writeByte( static_cast< sal_uInt8 >( AnyTag::Timing ) );
+            writeUInt( static_cast< sal_uInt32 >( rValue.get< Timing >() ) );
+            return;
+        }
+        break;
+    case css::uno::TypeClass_STRUCT:
+        if( rValue.getValueType() == cppu::UnoType< ValuePair >::get() )
+        {
+            const ValuePair& rPair = *static_cast< const ValuePair* >( rValue.getValue() );
+            writeByte( static_cast< sal_uInt8 >( AnyTag::ValuePair ) );
+            writeAny( rPair.First );
+            writeAny( rPair.Second );
+            return;
+        }
+        if( rValue.getValueType() == cppu::UnoType< Event >::get() )
+        {
+            const Event& rEvent = *static_cast< const Event* >( rValue.getValue() );
+            writeByte( static_cast< sal_uInt8 >( AnyTag::Event ) );
+            writeAny( rEvent.Source );
+            writeInt( rEvent.Trigger );
+            writeAny( rEvent.Offset );
+            writeUInt( rEvent.Repeat );
+            return;
+        }
+        if( rValue.getValueType() == cppu::UnoType< ParagraphTarget >::get() )
+        {
+            const ParagraphTarget& rTarget = *static_cast< const ParagraphTarget* >( rValue.getValue() );
+            writeByte( static_cast< sal_uInt8 >( AnyTag::ParagraphTarget ) );
+            writeReference( Any( rTarget.Shape ) );
+            writeInt( rTarget.Paragraph );
+            return;
+        }
+        break;
+    case css::uno::TypeClass_SEQUENCE:
+        if( rValue.getValueType() == cppu::UnoType< Sequence< Any > >::get() )
+        {
+            const Sequence< Any >& rSequence = *static_cast< const Sequence< Any >* >( rValue.getValue() );
+            writeByte( static_cast< sal_uInt8 >( AnyTag::Sequence ) );
+            writeUInt( rSequence.getLength() );
+            for( const Any& rElement : rSequence )
+                writeAny( rElement );
+            return;
+        }
+        break;
+    case css::uno::TypeClass_INTERFACE:
+    {
+        // e.g. the event source of a begin time, which is a node of the same tree
+        Reference< XInterface > xInterface( rValue, UNO_QUERY );
+        auto aIter = maNodes.find( xInterface.get() );
+        if( aIter != maNodes.end() )
+        {
+            writeByte( static_cast< sal_uInt8 >( AnyTag::Node ) );
+            writeUInt( aIter->second );
+            return;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    writeByte( static_cast< sal_uInt8 >( AnyTag::Reference ) );
+    writeReference( rValue );
+}
+
+
+void SnapshotWriter::writeReference( const Any& rValue )
+{
+    if( rValue.getValueTypeClass() == css::uno::TypeClass_INTERFACE )
+    {
+        Reference< XInterface > xInterface( rValue, UNO_QUERY );
+        auto aIter = maInterfaces.find( xInterface.get() );
+        if( aIter != maInterfaces.end() )
+        {
+            writeUInt( aIter->second );
+            return;
+        }
+        maInterfaces.emplace( xInterface.get(), maSnapshot.maReferences.size() );
+    }
+
+    writeUInt( maSnapshot.maReferences.size() );
+    maSnapshot.maReferences.push_back( rValue );
+}
+
+
+AnimationSnapshot SnapshotWriter::finish()
+{
+    maStrings.clear();
+    maInterfaces.clear();
+    maNodes.clear();
+    return std::move( maSnapshot );
+}
+
+
+SnapshotReader::SnapshotReader( const AnimationSnapshot& rSnapshot )
+:   mrSnapshot( rSnapshot ),
+    mnPos( 0 ),
+    mnVersion( 0 )
+{
+    for( sal_uInt8 nMagic : aMagic )
+    {
+        if( readByte() != nMagic )
+            fail();
+    }
+
+    const sal_uInt64 nVersion = readUInt();
+    if( nVersion == 0 || nVersion > AnimationSnapshot::nFormatVersion )
+        fail();
+    mnVersion = static_cast< sal_uInt16 >( nVersion );
+}
+
+
+void SnapshotReader::fail()
+{
+    throw IllegalArgumentException();
+}
+
+
+sal_Int16 SnapshotReader::readNodeType()
+{
+    const sal_uInt64 nNodeType = readUInt();
+    if( nNodeType > css::animations::AnimationNodeType::COMMAND )
+        fail();
+    return static_cast< sal_Int16 >( nNodeType );
+}
+
+
+void SnapshotReader::addNode( const Reference< XAnimationNode >& rxNode )
+{
+    maNodes.push_back( rxNode );
+}
+
+
+sal_uInt8 SnapshotReader::readByte()
+{
+    if( mnPos >= mrSnapshot.maData.size() )
+        fail();
+    return mrSnapshot.maData[ mnPos++ ];
+}
+
+
+sal_uInt64 SnapshotReader::readUInt()
+{
+    sal_uInt64 nValue = 0;
+    for( int nShift = 0; nShift < 64; nShift += 7 )
+    {
+        const sal_uInt8 nByte = readByte();
+        nValue |= static_cast< sal_uInt64 >( nByte & 0x7f ) << nShift;
+        if( !( nByte & 0x80 ) )
+            return nValue;
+    }
+    fail();
+}
+
+
+sal_Int32 SnapshotReader::readCount()
+{
+    // so that a damaged count cannot allocate much
+    const sal_uInt64 nCount = readUInt();
+    if( nCount > mrSnapshot.maData.size() - mnPos )
+        fail();
+    return static_cast< sal_Int32 >( nCount );
+}
+
+
+sal_Int64 SnapshotReader::readInt()
+{
+    const sal_uInt64 nValue = readUInt();
+    return static_cast< sal_Int64 >( ( nValue >> 1 ) ^ ( ~( nValue & 1 ) + 1 ) );
+}
+
+
+bool SnapshotReader::readBool()
+{
+    return readByte() != 0;
+}
+
+
+sal_uInt64 SnapshotReader::readFixed( int nBytes )
+{
+    sal_uInt64 nValue = 0;
+    for( int i = 0; i < nBytes; ++i )
+        nValue |= static_cast< sal_uInt64 >( readByte() ) << ( 8 * i );
+    return nValue;
+}
+
+
+double SnapshotReader::readDouble()
+{
+    const sal_uInt64 nBits = readFixed( 8 );
+    double fValue;
+    memcpy( &fValue, &nBits, sizeof( fValue ) );
+    return fValue;
+}
+
+
+OUString SnapshotReader::readString()
+{
+    const sal_uInt64 nIndex = readUInt();
+    if( nIndex > 0 )
+    {
+        if( nIndex > maStrings.size() )
+            fail();
+        return maStrings[ nIndex - 1 ];
+    }
+
+    const sal_Int32 nLength = readCount();
+    OUStringBuffer aBuffer( nLength );
+    for( sal_Int32 i = 0; i < nLength; ++i )
+        aBuffer.append( static_cast< sal_Unicode >( readUInt() ) );
+    maStrings.push_back( aBuffer.makeStringAndClear() );
+    return maStrings.back();
+}
+
+
+Any SnapshotReader::readAny()
+{
+    switch( static_cast< AnyTag >( readByte() ) )
+    {
+    case AnyTag::Void:
+        return Any();
+    case AnyTag::False:
+        return Any( false );
+    case AnyTag::True:
+        return Any( true );
+    case AnyTag::Byte:
+        return Any( static_cast< sal_Int8 >( readInt() ) );
+    case AnyTag::Short:
+        return Any( static_cast< sal_Int16 >( readInt() ) );
+    case AnyTag::UnsignedShort:
+        return Any( static_cast< sal_uInt16 >( readUInt() ) );
+    case AnyTag::Long:
+        return Any( static_cast< sal_Int32 >( readInt() ) );
+    case AnyTag::UnsignedLong:
+        return Any( static_cast< sal_uInt32 >( readUInt() ) );
+    case AnyTag::Hyper:
+        return Any( readInt() );
+    case AnyTag::UnsignedHyper:
+        return Any( readUInt() );
+    case AnyTag::Float:
+    {
+        const sal_uInt32 nBits = static_cast< sal_uInt32 >( readFixed( 4 ) );
+        float fValue;
+        memcpy( &fValue, &nBits, sizeof( fValue ) );
+        return Any( fValue );
+    }
+    case AnyTag::Double:
+        return Any( readDouble() );
+    case AnyTag::String:
+        return Any( readString() );
+    case AnyTag::ValuePair:
+    {
+        ValuePair aPair;
+        aPair.First = readAny();
+        aPair.Second = readAny();
+        return Any( aPair );
+    }
+    case AnyTag::Timing:
+        return Any( static_cast< Timing >( readUInt() ) );
+    case AnyTag::Event:
+    {
+        Event aEvent;
+        aEvent.Source = readAny();
+        aEvent.Trigger = static_cast< sal_Int16 >( readInt() );
+        aEvent.Offset = readAny();
+        aEvent.Repeat = static_cast< sal_uInt16 >( readUInt() );
+        return Any( aEvent );
+    }
+    case AnyTag::Sequence:
+    {
+        Sequence< Any > aSequence( readCount() );
+        for( Any& rElement : aSequence )
+            rElement = readAny();
+        return Any( aSequence );
+    }
+    case AnyTag::ParagraphTarget:
+    {
+        ParagraphTarget aTarget;
+        aTarget.Shape.set( readReference(), UNO_QUERY );
+        aTarget.Paragraph = static_cast< sal_Int16 >( readInt() );
+        return Any( aTarget );
+    }
+    case AnyTag::Node:
+    {
+        const sal_uInt64 nIndex = readUInt();
+        if( nIndex >= maNodes.size() )
+            fail();
+        return Any( maNodes[ nIndex ] );
+    }
+    case AnyTag::Reference:
+        return readReference();
+    }
+    fail();
+}
+
+
+Any SnapshotReader::readReference()
+{
+    const sal_uInt64 nIndex = readUInt();
+    if( nIndex >= mrSnapshot.maReferences.size() )
+        fail();
+    return mrSnapshot.maReferences[ nIndex ];
+}
+
+} // namespace animcore
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,163 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSNAPSHOT_HXX
+#define INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSNAPSHOT_HXX
+
+#include <com/sun/star/animations/XAnimationNode.hpp>
+#include <com/sun/star/uno/Any.hxx>
+#include <com/sun/star/uno/Reference.hxx>
+#include <rtl/ustring.hxx>
+
+#include <unordered_map>
+#include <vector>
+
+namespace animcore
+{
+
+/** A compact binary copy of an animation node tree, for undo stacks and for copying
+    effects between documents without a deep UNO clone or an export to XML.
+
+    The data holds the type, the timing and animation attributes, the values and the
+    user data of every node, with attributes that have their default value left out.
+    Objects like the shapes that are animated cannot be encoded; they are kept in the
+    reference table, and the data refers to them by their index there, which is the
+    same for all occurrences of an object.  To copy a tree to another document,
+    replace the references with their counterparts in that document before restoring.
+    Values of types the format does not know are kept in the reference table too, so
+    a snapshot restored in the same process is always complete.
+
+    Restoring creates the nodes of the tree in one go and sets their attributes and
+    links them directly, without going through their UNO interfaces.
+*/
+class AnimationSnapshot
+{
+public:
+    /// the version of the format that is written; older versions can be restored
+    static const sal_uInt16 nFormatVersion = 1;
+
+    AnimationSnapshot();
+    AnimationSnapshot( const std::vector< sal_uInt8 >& rData,
+                       const std::vector< css::uno::Any >& rReferences );
+
+    /** encodes the tree of which rxRoot is the root
+
+        @throws css::lang::IllegalArgumentException
+            if rxRoot is not implemented by this library
+    */
+    static AnimationSnapshot create( const css::uno::Reference< css::animations::XAnimationNode >& rxRoot );
+
+    /** builds a new tree, without a parent, from the snapshot
+
+        @throws css::lang::IllegalArgumentException
+            if the data is not a snapshot, is of a newer version or is damaged
+    */
+    css::uno::Reference< css::animations::XAnimationNode > restore() const;
+
+    const std::vector< sal_uInt8 >& getData() const { return maData; }
+    const std::vector< css::uno::Any >& getReferences() const { return maReferences; }
+
+    /** replaces the referenced objects, e.g. the shapes of a page by those of its copy
+
+        @throws css::lang::IllegalArgumentException
+            if the number of references differs
+    */
+    void setReferences( const std::vector< css::uno::Any >& rReferences );
+
+    bool operator==( const AnimationSnapshot& rOther ) const;
+    bool operator!=( const AnimationSnapshot& rOther ) const { return !( *this == rOther ); }
+
+private:
+    friend class SnapshotWriter;
+    friend class SnapshotReader;
+
+    std::vector< sal_uInt8 >        maData;
+    std::vector< css::uno::Any >    maReferences;
+};
+
+
+/** writes the primitive values of a snapshot; the nodes are written by AnimationNode
+ */
+class SnapshotWriter
+{
+public:
+    SnapshotWriter();
+
+    /// registers the node with the next index, for values that refer to it
+    void writeNode( const css::uno::Reference< css::uno::XInterface >& rxNode, sal_Int16 nNodeType );
+
+    void writeUInt( sal_uInt64 nValue );
+    void writeInt( sal_Int64 nValue );
+    void writeBool( bool bValue );
+    void writeDouble( double fValue );
+    void writeString( const OUString& rValue );
+    void writeAny( const css::uno::Any& rValue );
+    /// writes the index of rValue in the reference table, adding it if it is not there
+    void writeReference( const css::uno::Any& rValue );
+
+    AnimationSnapshot finish();
+
+private:
+    void writeByte( sal_uInt8 nValue ) { maSnapshot.maData.push_back( nValue ); }
+    void writeFixed( sal_uInt64 nValue, int nBytes );
+
+    AnimationSnapshot maSnapshot;
+    /// strings that occur again are written as the index of their first occurrence
+    std::unordered_map< OUString, sal_uInt32, OUStringHash > maStrings;
+    std::unordered_map< css::uno::XInterface*, sal_uInt32 > maInterfaces;
+    std::unordered_map< css::uno::XInterface*, sal_uInt32 > maNodes;
+};
+
+
+/** reads the primitive values of a snapshot; all reads throw
+    css::lang::IllegalArgumentException if the data is damaged
+ */
+class SnapshotReader
+{
+public:
+    /// @throws css::lang::IllegalArgumentException if the header is not that of a known version
+    explicit SnapshotReader( const AnimationSnapshot& rSnapshot );
+
+    sal_uInt16 getVersion() const { return mnVersion; }
+
+    /// reads the type of the next node, which the caller creates and registers with addNode
+    sal_Int16 readNodeType();
+    void addNode( const css::uno::Reference< css::animations::XAnimationNode >& rxNode );
+
+    /// a number of elements that follow, each of which takes at least a byte
+    sal_Int32 readCount();
+    sal_uInt64 readUInt();
+    sal_Int64 readInt();
+    bool readBool();
+    double readDouble();
+    OUString readString();
+    css::uno::Any readAny();
+    css::uno::Any readReference();
+
+    bool atEnd() const { return mnPos == mrSnapshot.maData.size(); }
+
+    /// @throws css::lang::IllegalArgumentException
+    [[noreturn]] static void fail();
+
+private:
+    sal_uInt8 readByte();
+    sal_uInt64 readFixed( int nBytes );
+
+    const AnimationSnapshot&    mrSnapshot;
+    size_t                      mnPos;
+    sal_uInt16                  mnVersion;
+    std::vector< OUString >     maStrings;
+    std::vector< css::uno::Reference< css::animations::XAnimationNode > > maNodes;
+};
+
+} // namespace animcore
+
+#endif // INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSNAPSHOT_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,58 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSTRUCTURE_HXX
+#define INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSTRUCTURE_HXX
+
+#include <com/sun/star/animations/XAnimationNode.hpp>
+#include <com/sun/star/uno/Reference.hxx>
+
+#include <vector>
+
+namespace animcore
+{
+
+/*  Decks generated from templates repeat the same effects many times over, differing
+    only in the shapes they animate.  These compare effects apart from their targets,
+    and let equal effects share their payloads, so that the memory the values, key
+    times, time filters and user data take grows with the number of distinct effects.
+*/
+
+/** a hash of the tree below rxNode that leaves out the targets; it is cached at each
+    node until the node or one of its descendants changes
+
+    @throws css::lang::IllegalArgumentException
+        if rxNode is not implemented by this library
+*/
+size_t getStructureHash( const css::uno::Reference< css::animations::XAnimationNode >& rxNode );
+
+/** the trees below rxFirst and rxSecond are equal, apart from their targets
+
+    @throws css::lang::IllegalArgumentException
+        if rxFirst or rxSecond is not implemented by this library
+*/
+bool equalsStructure( const css::uno::Reference< css::animations::XAnimationNode >& rxFirst,
+                      const css::uno::Reference< css::animations::XAnimationNode >& rxSecond );
+
+/** lets all nodes in the trees of rRoots with equal values, key times, time filters or
+    user data share one buffer for them, e.g. after the import of a deck
+
+    Nothing is kept once this returns, so payloads that are set later are only shared
+    by another call.
+
+    @throws css::lang::IllegalArgumentException
+        if one of rRoots is not implemented by this library
+*/
+void sharePayloads( const std::vector< css::uno::Reference< css::animations::XAnimationNode > >& rRoots );
+
+} // namespace animcore
+
+#endif // INCLUDED_ANIMATIONS_SOURCE_ANIMCORE_ANIMATIONSTRUCTURE_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -39,8 +39,11 @@
 #include <com/sun/star/animations/AnimationColorSpace.hpp>
 #include <com/sun/star/animations/AnimationAdditiveMode.hpp>
 #include <com/sun/star/animations/AnimationTransformType.hpp>
+#include <com/sun/star/animations/Event.hpp>
+#include <com/sun/star/animations/ParagraphTarget.hpp>
 #include <com/sun/star/animations/TransitionType.hpp>
 #include <com/sun/star/animations/TransitionSubType.hpp>
+#include <com/sun/star/animations/ValuePair.hpp>
 #include <com/sun/star/presentation/ShapeAnimationSubType.hpp>
 #include <com/sun/star/container/ElementExistException.hpp>
 #include <com/sun/star/container/XEnumerationAccess.hpp>
@@ -56,10 +59,21 @@
 #include <cppuhelper/implbase.hxx>
 
 #include <osl/mutex.hxx>
+#include <rtl/ref.hxx>
 #include <list>
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include <string.h>
 
+#include "animationnodeindex.hxx"
+#include "animationsampler.hxx"
+#include "animationsnapshot.hxx"
+#include "animationstructure.hxx"
+
 using ::osl::Mutex;
 using ::osl::Guard;
 using ::comphelper::OInterfaceContainerHelper2;
@@ -103,6 +117,256 @@ namespace animcore
 
 typedef std::list< Reference< XAnimationNode > > ChildList_t;
 
+class AnimationNode;
+
+/// consistent with Any::operator==, which compares interfaces by identity and numbers by value
+struct AnyHash
+{
+    size_t operator()( const Any& rAny ) const;
+};
+
+/** Finds the nodes of an animation tree by target, and by user data entry like
+    "node-type" or "preset-id", without walking the tree and copying the user data
+    of every node.
+
+    It is created by the root node of a tree when it is first queried, and kept up to
+    date when the target or the user data of a node changes, when subtrees are
+    inserted or removed, and when a node dies.  Only nodes implemented here are
+    indexed, together with their own descendants.  The nodes are held weakly, so a
+    query never returns a node that is being destroyed.
+*/
+class AnimationNodeIndex
+{
+public:
+    void insertTarget( AnimationNode* pNode, const Any& rTarget );
+    void removeTarget( AnimationNode* pNode, const Any& rTarget );
+    void insertUserData( AnimationNode* pNode, const Sequence< NamedValue >& rUserData );
+    void removeUserData( AnimationNode* pNode, const Sequence< NamedValue >& rUserData );
+
+    std::vector< Reference< XAnimationNode > > findByTarget( const Any& rTarget );
+    std::vector< Reference< XAnimationNode > > findByUserData( const OUString& rName, const Any& rValue );
+
+private:
+    typedef std::unordered_map< AnimationNode*, WeakReference< XAnimationNode > > Nodes_t;
+    typedef std::unordered_map< Any, Nodes_t, AnyHash > NodeMap_t;
+
+    static WeakReference< XAnimationNode > getWeakNode( AnimationNode* pNode );
+
+    static std::vector< Reference< XAnimationNode > > getNodes( const NodeMap_t& rMap, const Any& rKey );
+
+    /// only held while the maps are changed or read, never while calling out
+    Mutex maMutex;
+    NodeMap_t maTargets;
+    /// per user data name, the nodes by value
+    std::unordered_map< OUString, NodeMap_t > maUserData;
+};
+
+
+static size_t hashPayload( double fValue )
+{
+    return std::hash< double >()( fValue );
+}
+
+static size_t hashPayload( const TimeFilterPair& rPair )
+{
+    return hashPayload( rPair.Time ) * 31 + hashPayload( rPair.Progress );
+}
+
+static size_t hashPayload( const Any& rValue )
+{
+    return AnyHash()( rValue );
+}
+
+static size_t hashPayload( const NamedValue& rValue )
+{
+    return rValue.Name.hashCode() * 31 + AnyHash()( rValue.Value );
+}
+
+// unlike Any::operator==, these are exact, as the pooled payload replaces the other one
+
+static bool samePayload( double fFirst, double fSecond )
+{
+    return memcmp( &fFirst, &fSecond, sizeof( double ) ) == 0;
+}
+
+static bool samePayload( const TimeFilterPair& rFirst, const TimeFilterPair& rSecond )
+{
+    return samePayload( rFirst.Time, rSecond.Time ) && samePayload( rFirst.Progress, rSecond.Progress );
+}
+
+static bool samePayload( const Any& rFirst, const Any& rSecond );
+
+static bool samePayload( const NamedValue& rFirst, const NamedValue& rSecond )
+{
+    return rFirst.Name == rSecond.Name && samePayload( rFirst.Value, rSecond.Value );
+}
+
+template< class T, class Equal >
+static bool equalSequences( const Sequence< T >& rFirst, const Sequence< T >& rSecond, Equal aEqual )
+{
+    // shared payloads are the same buffer
+    if( rFirst.get() == rSecond.get() )
+        return true;
+    return rFirst.getLength() == rSecond.getLength()
+        && std::equal( rFirst.begin(), rFirst.end(), rSecond.begin(), aEqual );
+}
+
+template< class T >
+static bool samePayload( const Sequence< T >& rFirst, const Sequence< T >& rSecond )
+{
+    return equalSequences( rFirst, rSecond, []( const T& rA, const T& rB ) { return samePayload( rA, rB ); } );
+}
+
+static bool samePayload( const Any& rFirst, const Any& rSecond )
+{
+    if( rFirst.getValueType() != rSecond.getValueType() )
+        return false;
+
+    ValuePair aFirstPair, aSecondPair;
+    if( ( rFirst >>= aFirstPair ) && ( rSecond >>= aSecondPair ) )
+        return samePayload( aFirstPair.First, aSecondPair.First ) && samePayload( aFirstPair.Second, aSecondPair.Second );
+
+    Sequence< Any > aFirstSequence, aSecondSequence;
+    if( ( rFirst >>= aFirstSequence ) && ( rSecond >>= aSecondSequence ) )
+        return samePayload( aFirstSequence, aSecondSequence );
+
+    return rFirst == rSecond;
+}
+
+
+/** Lets nodes with equal values, key times, time filters or user data share one buffer.
+
+    Sequences are reference counted and copied on write, so nodes can share them
+    safely.  A pool only lives as long as one call of sharePayloads, so it never keeps
+    values alive by itself.
+*/
+template< class T >
+class SequencePool
+{
+public:
+    /// replaces rSequence with an equal sequence from the pool, or adds it to the pool
+    void intern( Sequence< T >& rSequence );
+
+private:
+    std::unordered_multimap< size_t, Sequence< T > > maEntries;
+};
+
+
+template< class T >
+void SequencePool< T >::intern( Sequence< T >& rSequence )
+{
+    if( !rSequence.hasElements() )
+        return;
+
+    size_t nHash = 0;
+    for( const T& rElement : rSequence )
+        nHash = nHash * 31 + hashPayload( rElement );
+
+    auto aRange = maEntries.equal_range( nHash );
+    for( auto aIter = aRange.first; aIter != aRange.second; ++aIter )
+    {
+        if( samePayload( aIter->second, rSequence ) )
+        {
+            rSequence = aIter->second;
+            return;
+        }
+    }
+
+    maEntries.emplace( nHash, rSequence );
+}
+
+
+struct PayloadPool
+{
+    SequencePool< NamedValue > maUserData;
+    SequencePool< Any > maValues;
+    SequencePool< double > maKeyTimes;
+    SequencePool< TimeFilterPair > maTimeFilter;
+};
+
+
+/** hashes like AnyHash, except that all objects, like the shape of a paragraph target or
+    the source of an event, hash alike
+*/
+static size_t hashStructure( const Any& rValue )
+{
+    switch( rValue.getValueTypeClass() )
+    {
+    case css::uno::TypeClass_INTERFACE:
+        return 0;
+    case css::uno::TypeClass_STRUCT:
+    {
+        ValuePair aPair;
+        if( rValue >>= aPair )
+            return hashStructure( aPair.First ) * 31 + hashStructure( aPair.Second );
+        Event aEvent;
+        if( rValue >>= aEvent )
+            return ( ( hashStructure( aEvent.Source ) * 31 + aEvent.Trigger ) * 31 + hashStructure( aEvent.Offset ) ) * 31 + aEvent.Repeat;
+        ParagraphTarget aTarget;
+        if( rValue >>= aTarget )
+            return aTarget.Paragraph;
+        break;
+    }
+    case css::uno::TypeClass_SEQUENCE:
+    {
+        Sequence< Any > aSequence;
+        if( rValue >>= aSequence )
+        {
+            size_t nHash = 0;
+            for( const Any& rElement : aSequence )
+                nHash = nHash * 31 + hashStructure( rElement );
+            return nHash;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return AnyHash()( rValue );
+}
+
+
+/// compares like Any::operator==, except that all objects are alike, as in hashStructure
+static bool equalStructure( const Any& rFirst, const Any& rSecond )
+{
+    if( rFirst.getValueTypeClass() == css::uno::TypeClass_INTERFACE )
+        return rSecond.getValueTypeClass() == css::uno::TypeClass_INTERFACE;
+
+    ValuePair aFirstPair, aSecondPair;
+    if( ( rFirst >>= aFirstPair ) && ( rSecond >>= aSecondPair ) )
+        return equalStructure( aFirstPair.First, aSecondPair.First ) && equalStructure( aFirstPair.Second, aSecondPair.Second );
+
+    Event aFirstEvent, aSecondEvent;
+    if( ( rFirst >>= aFirstEvent ) && ( rSecond >>= aSecondEvent ) )
+        return equalStructure( aFirstEvent.Source, aSecondEvent.Source ) && aFirstEvent.Trigger == aSecondEvent.Trigger
+            && equalStructure( aFirstEvent.Offset, aSecondEvent.Offset ) && aFirstEvent.Repeat == aSecondEvent.Repeat;
+
+    ParagraphTarget aFirstTarget, aSecondTarget;
+    if( ( rFirst >>= aFirstTarget ) && ( rSecond >>= aSecondTarget ) )
+        return aFirstTarget.Paragraph == aSecondTarget.Paragraph;
+
+    Sequence< Any > aFirstSequence, aSecondSequence;
+    if( ( rFirst >>= aFirstSequence ) && ( rSecond >>= aSecondSequence ) )
+        return equalSequences( aFirstSequence, aSecondSequence, equalStructure );
+
+    return rFirst == rSecond;
+}
+
+
+/// the attributes of a node in a snapshot, in the order of their bits in its mask
+enum SnapshotAttribute
+{
+    SNAPSHOT_BEGIN, SNAPSHOT_DURATION, SNAPSHOT_END, SNAPSHOT_ENDSYNC, SNAPSHOT_REPEATCOUNT,
+    SNAPSHOT_REPEATDURATION, SNAPSHOT_FILL, SNAPSHOT_FILLDEFAULT, SNAPSHOT_RESTART,
+    SNAPSHOT_RESTARTDEFAULT, SNAPSHOT_ACCELERATION, SNAPSHOT_DECELERATE, SNAPSHOT_AUTOREVERSE,
+    SNAPSHOT_USERDATA, SNAPSHOT_TARGET, SNAPSHOT_ATTRIBUTENAME, SNAPSHOT_FORMULA, SNAPSHOT_VALUES,
+    SNAPSHOT_KEYTIMES, SNAPSHOT_VALUETYPE, SNAPSHOT_SUBITEM, SNAPSHOT_CALCMODE, SNAPSHOT_ADDITIVE,
+    SNAPSHOT_ACCUMULATE, SNAPSHOT_FROM, SNAPSHOT_TO, SNAPSHOT_BY, SNAPSHOT_TIMEFILTER,
+    SNAPSHOT_COLORSPACE, SNAPSHOT_DIRECTION, SNAPSHOT_PATH, SNAPSHOT_ORIGIN, SNAPSHOT_TRANSFORMTYPE,
+    SNAPSHOT_TRANSITION, SNAPSHOT_SUBTYPE, SNAPSHOT_MODE, SNAPSHOT_FADECOLOR, SNAPSHOT_VOLUME,
+    SNAPSHOT_COMMAND, SNAPSHOT_PARAMETER, SNAPSHOT_ITERATETYPE, SNAPSHOT_ITERATEINTERVAL,
+    SNAPSHOT_ATTRIBUTE_COUNT
+};
 
 class AnimationNodeBase :   public XAnimateMotion,
                             public XAnimateColor,
@@ -130,6 +394,7 @@ class AnimationNode : public AnimationNodeBase
 public:
     explicit AnimationNode(sal_Int16 nNodeType);
     explicit AnimationNode(const AnimationNode& rNode);
+    virtual ~AnimationNode() override;
 
     // XInterface
     virtual Any SAL_CALL queryInterface( const Type& aType ) override;
@@ -284,7 +549,63 @@ public:
     static const Sequence< sal_Int8 > & getUnoTunnelId();
     void fireChangeListener();
 
+    /// all nodes in the tree of this node with the given target
+    std::vector< Reference< XAnimationNode > > findNodesByTarget( const Any& rTarget );
+    /// all nodes in the tree of this node with the given user data entry
+    std::vector< Reference< XAnimationNode > > findNodesByUserData( const OUString& rName, const Any& rValue );
+
+    /// a sampler for the values of this node over its simple duration
+    AnimationSampler createSampler();
+
+    /** a hash of the subtree of this node that leaves out the targets, so that effects
+        that differ only in the shapes they animate hash alike
+    */
+    size_t getStructureHash();
+    /// the subtree of rxOther equals that of this node, apart from the targets
+    bool equalsStructure( const Reference< XAnimationNode >& rxOther );
+    /// lets the payloads of this node and its descendants share buffers with equal ones in rPool
+    void sharePayloads( PayloadPool& rPool );
+
+    /// the node implemented here behind rxNode, if any
+    static AnimationNode* getImplementation( const Reference< XInterface >& rxNode );
+
+    /// writes the tree of which this node is the root
+    void writeSnapshot( SnapshotWriter& rWriter );
+    /// builds a tree from a snapshot and returns its root
+    static Reference< XAnimationNode > readSnapshot( SnapshotReader& rReader );
+
 private:
+    bool compareStructure( AnimationNode& rOther );
+    /// the structure hashes of this node and its ancestors are out of date
+    void invalidateStructureHash();
+
+    /// this node and its descendants in document order
+    void collectNodes( std::vector< rtl::Reference< AnimationNode > >& rNodes );
+    /// the attributes that differ from those of a new node, and the children by index
+    void writeNodeSnapshot( SnapshotWriter& rWriter, const std::unordered_map< AnimationNode*, sal_uInt32 >& rIndexes );
+    void readNodeSnapshot( SnapshotReader& rReader );
+
+    /** the index of the tree this node is in, if it has one
+
+        This is called with the mutex of this node held, so it cannot lock the ancestors
+        and only follows their parents, like fireChangeListener.
+    */
+    AnimationNodeIndex* getIndex();
+
+    /** the root of the tree this node is in
+
+        Locks one node at a time, so it must be called without holding the mutex of any
+        node: the tree is locked from the parents to the children everywhere else.
+    */
+    rtl::Reference< AnimationNode > getRoot();
+
+    /// runs rQuery on the index of the tree of this node, which is created if needed
+    std::vector< Reference< XAnimationNode > > queryIndex(
+        const std::function< std::vector< Reference< XAnimationNode > >( AnimationNodeIndex& ) >& rQuery );
+
+    /// add this node and its descendants to the index, or remove them from it
+    void updateIndex( AnimationNodeIndex& rIndex, bool bInsert );
+
     OInterfaceContainerHelper2   maChangeListener;
 
     static void initTypeProvider( sal_Int16 nNodeType ) throw();
@@ -345,6 +666,13 @@ private:
 
     /** sorted list of child nodes for XTimeContainer*/
     ChildList_t             maChildren;
+
+    /** index of the tree, only at its root node and only once it has been queried */
+    std::unique_ptr< AnimationNodeIndex > mpIndex;
+
+    /** hash of the subtree, if mbStructureHashValid */
+    size_t                  mnStructureHash;
+    bool                    mbStructureHashValid;
 };
 
 
@@ -421,7 +749,9 @@ AnimationNode::AnimationNode( sal_Int16 nNodeType )
     mfVolume(1.0),
     mnCommand(0),
     mnIterateType( css::presentation::ShapeAnimationSubType::AS_WHOLE ),
-    mfIterateInterval(0.0)
+    mfIterateInterval(0.0),
+    mnStructureHash(0),
+    mbStructureHashValid(false)
 {
     assert(nNodeType < int(SAL_N_ELEMENTS(mpTypes)));
 }
@@ -490,10 +820,26 @@ AnimationNode::AnimationNode( const AnimationNode& rNode )
 
     // XIterateContainer
     mnIterateType( rNode.mnIterateType ),
-    mfIterateInterval( rNode.mfIterateInterval )
+    mfIterateInterval( rNode.mfIterateInterval ),
+    mnStructureHash( 0 ),
+    mbStructureHashValid( false )
 {
 }
 
+AnimationNode::~AnimationNode()
+{
+    // a node is removed from the index when it is removed from its tree, this is for the
+    // nodes that are dropped while their tree still holds the index
+    if( !mpIndex )
+    {
+        if( AnimationNodeIndex* pIndex = getIndex() )
+        {
+            pIndex->removeTarget( this, maTarget );
+            pIndex->removeUserData( this, maUserData );
+        }
+    }
+}
+
 Sequence<OUString> getSupportedServiceNames_PAR()
 {
     return { "com.sun.star.animations.ParallelTimeContainer" };
@@ -1146,7 +1492,12 @@ Sequence< NamedValue > SAL_CALL AnimationNode::getUserData()
 void SAL_CALL AnimationNode::setUserData( const Sequence< NamedValue >& _userdata )
 {
     Guard< Mutex > aGuard( maMutex );
+    AnimationNodeIndex* pIndex = getIndex();
+    if( pIndex )
+        pIndex->removeUserData( this, maUserData );
     maUserData = _userdata;
+    if( pIndex )
+        pIndex->insertUserData( this, maUserData );
     fireChangeListener();
 }
 
@@ -1165,12 +1516,21 @@ void SAL_CALL AnimationNode::setParent( const Reference< XInterface >& Parent )
     Guard< Mutex > aGuard( maMutex );
     if( Parent != mxParent.get() )
     {
+        // this subtree moves from the index of one tree to that of another
+        if( mpIndex )
+            mpIndex.reset();
+        else if( AnimationNodeIndex* pIndex = getIndex() )
+            updateIndex( *pIndex, false );
+
         mxParent = Parent;
 
-        mpParent = nullptr;
-        Reference< XUnoTunnel > xTunnel( mxParent.get(), UNO_QUERY );
-        if( xTunnel.is() )
-            mpParent = reinterpret_cast< AnimationNode* >( sal::static_int_cast< sal_IntPtr >(xTunnel->getSomething( getUnoTunnelId() )));
+        mpParent = getImplementation( mxParent.get() );
+
+        if( mpParent )
+        {
+            if( AnimationNodeIndex* pIndex = getIndex() )
+                updateIndex( *pIndex, true );
+        }
 
         fireChangeListener();
     }
@@ -1234,7 +1594,12 @@ void SAL_CALL AnimationNode::setTarget( const Any& _target )
     Guard< Mutex > aGuard( maMutex );
     if( _target != maTarget )
     {
+        AnimationNodeIndex* pIndex = getIndex();
+        if( pIndex )
+            pIndex->removeTarget( this, maTarget );
         maTarget= _target;
+        if( pIndex )
+            pIndex->insertTarget( this, maTarget );
         fireChangeListener();
     }
 }
@@ -1855,6 +2220,7 @@ Reference< XAnimationNode > SAL_CALL AnimationNode::removeChild( const Reference
     oldChild->setParent( xNull );
 
     maChildren.erase( old );
+    invalidateStructureHash();
 
     return oldChild;
 }
@@ -1968,6 +2334,9 @@ void AnimationNode::fireChangeListener()
 {
     Guard< Mutex > aGuard( maMutex );
 
+    // changes of this node reach its ancestors below, so their hashes are reset too
+    mbStructureHashValid = false;
+
     OInterfaceIteratorHelper2 aIterator( maChangeListener );
     if( aIterator.hasMoreElements() )
     {
@@ -1992,6 +2361,932 @@ void AnimationNode::fireChangeListener()
 }
 
 
+AnimationNode* AnimationNode::getImplementation( const Reference< XInterface >& rxNode )
+{
+    Reference< XUnoTunnel > xTunnel( rxNode, UNO_QUERY );
+    if( !xTunnel.is() )
+        return nullptr;
+    return reinterpret_cast< AnimationNode* >( sal::static_int_cast< sal_IntPtr >(xTunnel->getSomething( getUnoTunnelId() )));
+}
+
+
+AnimationNodeIndex* AnimationNode::getIndex()
+{
+    AnimationNode* pRoot = this;
+    while( pRoot->mpParent )
+    {
+        //fdo#69645 use WeakReference of mxParent to test if mpParent is still valid
+        Reference< XInterface > xGuard( pRoot->mxParent );
+        if( !xGuard.is() )
+            break;
+        pRoot = pRoot->mpParent;
+    }
+    return pRoot->mpIndex.get();
+}
+
+
+rtl::Reference< AnimationNode > AnimationNode::getRoot()
+{
+    rtl::Reference< AnimationNode > xRoot( this );
+    for(;;)
+    {
+        rtl::Reference< AnimationNode > xParent;
+        {
+            Guard< Mutex > aGuard( xRoot->maMutex );
+            //fdo#69645 use WeakReference of mxParent to test if mpParent is still valid
+            Reference< XInterface > xGuard( xRoot->mxParent );
+            if( xGuard.is() )
+                xParent = xRoot->mpParent;
+        }
+        if( !xParent.is() )
+            return xRoot;
+        xRoot = xParent;
+    }
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNode::queryIndex(
+    const std::function< std::vector< Reference< XAnimationNode > >( AnimationNodeIndex& ) >& rQuery )
+{
+    for(;;)
+    {
+        rtl::Reference< AnimationNode > xRoot( getRoot() );
+        Guard< Mutex > aGuard( xRoot->maMutex );
+
+        // the root was inserted into another tree meanwhile
+        Reference< XInterface > xGuard( xRoot->mxParent );
+        if( xGuard.is() && xRoot->mpParent )
+            continue;
+
+        if( !xRoot->mpIndex )
+        {
+            xRoot->mpIndex.reset( new AnimationNodeIndex );
+            xRoot->updateIndex( *xRoot->mpIndex, true );
+        }
+        return rQuery( *xRoot->mpIndex );
+    }
+}
+
+
+void AnimationNode::updateIndex( AnimationNodeIndex& rIndex, bool bInsert )
+{
+    Guard< Mutex > aGuard( maMutex );
+
+    if( bInsert )
+    {
+        rIndex.insertTarget( this, maTarget );
+        rIndex.insertUserData( this, maUserData );
+    }
+    else
+    {
+        rIndex.removeTarget( this, maTarget );
+        rIndex.removeUserData( this, maUserData );
+    }
+
+    for( const auto& rxChild : maChildren )
+    {
+        if( AnimationNode* pChild = getImplementation( rxChild ) )
+            pChild->updateIndex( rIndex, bInsert );
+    }
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNode::findNodesByTarget( const Any& rTarget )
+{
+    return queryIndex( [&rTarget]( AnimationNodeIndex& rIndex ) { return rIndex.findByTarget( rTarget ); } );
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNode::findNodesByUserData( const OUString& rName, const Any& rValue )
+{
+    return queryIndex( [&rName, &rValue]( AnimationNodeIndex& rIndex ) { return rIndex.findByUserData( rName, rValue ); } );
+}
+
+
+AnimationSampler AnimationNode::createSampler()
+{
+    Guard< Mutex > aGuard( maMutex );
+
+    AnimationSampler::Colors eColors = AnimationSampler::Colors::None;
+    if( mnNodeType == AnimationNodeType::ANIMATECOLOR )
+    {
+        if( mnColorSpace == AnimationColorSpace::HSL )
+            eColors = mbDirection ? AnimationSampler::Colors::HSLClockwise : AnimationSampler::Colors::HSLCounterClockwise;
+        else
+            eColors = AnimationSampler::Colors::RGB;
+    }
+
+    Sequence< Any > aValues( maValues );
+    if( !aValues.hasElements() )
+    {
+        // the from/to/by forms, as far as they do not depend on the underlying value
+        if( mnNodeType == AnimationNodeType::SET && maTo.hasValue() )
+            aValues = { maTo };
+        else if( maFrom.hasValue() && maTo.hasValue() )
+            aValues = { maFrom, maTo };
+        else if( maFrom.hasValue() && maBy.hasValue() )
+        {
+            Any aTo( AnimationSampler::add( maFrom, maBy, eColors ) );
+            if( aTo.hasValue() )
+                aValues = { maFrom, aTo };
+        }
+    }
+
+    return AnimationSampler( mnCalcMode, maKeyTimes, aValues, maTimeFilter, eColors );
+}
+
+
+size_t AnimationNode::getStructureHash()
+{
+    Guard< Mutex > aGuard( maMutex );
+    if( mbStructureHashValid )
+        return mnStructureHash;
+
+    size_t nHash = mnNodeType;
+    auto combine = [&nHash]( size_t nValue ) { nHash = nHash * 31 + nValue; };
+
+    combine( hashStructure( maBegin ) );
+    combine( hashStructure( maDuration ) );
+    combine( hashStructure( maEnd ) );
+    combine( hashStructure( maEndSync ) );
+    combine( hashStructure( maRepeatCount ) );
+    combine( hashStructure( maRepeatDuration ) );
+    combine( mnFill );
+    combine( mnFillDefault );
+    combine( mnRestart );
+    combine( mnRestartDefault );
+    combine( hashPayload( mfAcceleration ) );
+    combine( hashPayload( mfDecelerate ) );
+    combine( mbAutoReverse );
+    for( const NamedValue& rValue : maUserData )
+    {
+        combine( rValue.Name.hashCode() );
+        combine( hashStructure( rValue.Value ) );
+    }
+    combine( maAttributeName.hashCode() );
+    combine( maFormula.hashCode() );
+    for( const Any& rValue : maValues )
+        combine( hashStructure( rValue ) );
+    for( double fKeyTime : maKeyTimes )
+        combine( hashPayload( fKeyTime ) );
+    combine( mnValueType );
+    combine( mnSubItem );
+    combine( mnCalcMode );
+    combine( mnAdditive );
+    combine( mbAccumulate );
+    combine( hashStructure( maFrom ) );
+    combine( hashStructure( maTo ) );
+    combine( hashStructure( maBy ) );
+    for( const TimeFilterPair& rPair : maTimeFilter )
+        combine( hashPayload( rPair ) );
+    combine( mnColorSpace );
+    combine( mbDirection );
+    combine( hashStructure( maPath ) );
+    combine( hashStructure( maOrigin ) );
+    combine( mnTransformType );
+    combine( mnTransition );
+    combine( mnSubtype );
+    combine( mbMode );
+    combine( mnFadeColor );
+    combine( hashPayload( mfVolume ) );
+    combine( mnCommand );
+    combine( hashStructure( maParameter ) );
+    combine( mnIterateType );
+    combine( hashPayload( mfIterateInterval ) );
+
+    for( const auto& rxChild : maChildren )
+    {
+        AnimationNode* pChild = getImplementation( rxChild );
+        combine( pChild ? pChild->getStructureHash() : 0 );
+    }
+
+    mnStructureHash = nHash;
+    mbStructureHashValid = true;
+    return nHash;
+}
+
+
+bool AnimationNode::equalsStructure( const Reference< XAnimationNode >& rxOther )
+{
+    AnimationNode* pOther = getImplementation( rxOther );
+    return pOther && compareStructure( *pOther );
+}
+
+
+bool AnimationNode::compareStructure( AnimationNode& rOther )
+{
+    if( this == &rOther )
+        return true;
+    if( getStructureHash() != rOther.getStructureHash() )
+        return false;
+
+    // the two nodes are locked in the same order whichever way round they are compared
+    const bool bThisFirst = std::less< AnimationNode* >()( this, &rOther );
+    Guard< Mutex > aFirstGuard( bThisFirst ? maMutex : rOther.maMutex );
+    Guard< Mutex > aSecondGuard( bThisFirst ? rOther.maMutex : maMutex );
+
+    auto equalNamedValue = []( const NamedValue& rFirst, const NamedValue& rSecond )
+    {
+        return rFirst.Name == rSecond.Name && equalStructure( rFirst.Value, rSecond.Value );
+    };
+
+    if( mnNodeType != rOther.mnNodeType
+        || !equalStructure( maBegin, rOther.maBegin )
+        || !equalStructure( maDuration, rOther.maDuration )
+        || !equalStructure( maEnd, rOther.maEnd )
+        || !equalStructure( maEndSync, rOther.maEndSync )
+        || !equalStructure( maRepeatCount, rOther.maRepeatCount )
+        || !equalStructure( maRepeatDuration, rOther.maRepeatDuration )
+        || mnFill != rOther.mnFill
+        || mnFillDefault != rOther.mnFillDefault
+        || mnRestart != rOther.mnRestart
+        || mnRestartDefault != rOther.mnRestartDefault
+        || mfAcceleration != rOther.mfAcceleration
+        || mfDecelerate != rOther.mfDecelerate
+        || mbAutoReverse != rOther.mbAutoReverse
+        || !equalSequences( maUserData, rOther.maUserData, equalNamedValue )
+        || maAttributeName != rOther.maAttributeName
+        || maFormula != rOther.maFormula
+        || !equalSequences( maValues, rOther.maValues, equalStructure )
+        || !equalSequences( maKeyTimes, rOther.maKeyTimes, std::equal_to< double >() )
+        || mnValueType != rOther.mnValueType
+        || mnSubItem != rOther.mnSubItem
+        || mnCalcMode != rOther.mnCalcMode
+        || mnAdditive != rOther.mnAdditive
+        || mbAccumulate != rOther.mbAccumulate
+        || !equalStructure( maFrom, rOther.maFrom )
+        || !equalStructure( maTo, rOther.maTo )
+        || !equalStructure( maBy, rOther.maBy )
+        || !samePayload( maTimeFilter, rOther.maTimeFilter )
+        || mnColorSpace != rOther.mnColorSpace
+        || mbDirection != rOther.mbDirection
+        || !equalStructure( maPath, rOther.maPath )
+        || !equalStructure( maOrigin, rOther.maOrigin )
+        || mnTransformType != rOther.mnTransformType
+        || mnTransition != rOther.mnTransition
+        || mnSubtype != rOther.mnSubtype
+        || mbMode != rOther.mbMode
+        || mnFadeColor != rOther.mnFadeColor
+        || mfVolume != rOther.mfVolume
+        || mnCommand != rOther.mnCommand
+        || !equalStructure( maParameter, rOther.maParameter )
+        || mnIterateType != rOther.mnIterateType
+        || mfIterateInterval != rOther.mfIterateInterval
+        || maChildren.size() != rOther.maChildren.size() )
+        return false;
+
+    // children implemented elsewhere are only equal to themselves
+    auto aOtherIter = rOther.maChildren.begin();
+    for( const auto& rxChild : maChildren )
+    {
+        const Reference< XAnimationNode >& rxOtherChild = *aOtherIter++;
+        AnimationNode* pChild = getImplementation( rxChild );
+        AnimationNode* pOtherChild = getImplementation( rxOtherChild );
+        if( ( pChild && pOtherChild ) ? !pChild->compareStructure( *pOtherChild ) : rxChild != rxOtherChild )
+            return false;
+    }
+    return true;
+}
+
+
+void AnimationNode::sharePayloads( PayloadPool& rPool )
+{
+    std::vector< rtl::Reference< AnimationNode > > aNodes;
+    collectNodes( aNodes );
+
+    // the values stay the same, so neither the listeners nor the structure hashes care
+    for( const auto& rxNode : aNodes )
+    {
+        Guard< Mutex > aGuard( rxNode->maMutex );
+        rPool.maUserData.intern( rxNode->maUserData );
+        rPool.maValues.intern( rxNode->maValues );
+        rPool.maKeyTimes.intern( rxNode->maKeyTimes );
+        rPool.maTimeFilter.intern( rxNode->maTimeFilter );
+    }
+}
+
+
+void AnimationNode::invalidateStructureHash()
+{
+    for( AnimationNode* pNode = this; pNode; )
+    {
+        Guard< Mutex > aGuard( pNode->maMutex );
+        pNode->mbStructureHashValid = false;
+
+        //fdo#69645 use WeakReference of mxParent to test if mpParent is still valid
+        Reference< XInterface > xGuard( pNode->mxParent );
+        pNode = xGuard.is() ? pNode->mpParent : nullptr;
+    }
+}
+
+
+void AnimationNode::collectNodes( std::vector< rtl::Reference< AnimationNode > >& rNodes )
+{
+    Guard< Mutex > aGuard( maMutex );
+
+    rNodes.push_back( this );
+    for( const auto& rxChild : maChildren )
+    {
+        if( AnimationNode* pChild = getImplementation( rxChild ) )
+            pChild->collectNodes( rNodes );
+    }
+}
+
+
+void AnimationNode::writeSnapshot( SnapshotWriter& rWriter )
+{
+    // the types of all nodes come first, so that the restore can create the whole tree
+    // before reading attributes that refer to a node, like the event source of a begin
+    std::vector< rtl::Reference< AnimationNode > > aNodes;
+    collectNodes( aNodes );
+
+    std::unordered_map< AnimationNode*, sal_uInt32 > aIndexes;
+    rWriter.writeUInt( aNodes.size() );
+    for( const auto& rxNode : aNodes )
+    {
+        const sal_uInt32 nIndex = aIndexes.size();
+        aIndexes.emplace( rxNode.get(), nIndex );
+        rWriter.writeNode( static_cast< OWeakObject* >( rxNode.get() ), rxNode->mnNodeType );
+    }
+
+    for( const auto& rxNode : aNodes )
+        rxNode->writeNodeSnapshot( rWriter, aIndexes );
+}
+
+
+void AnimationNode::writeNodeSnapshot( SnapshotWriter& rWriter, const std::unordered_map< AnimationNode*, sal_uInt32 >& rIndexes )
+{
+    Guard< Mutex > aGuard( maMutex );
+
+    const sal_Int16 nDefaultCalcMode = ( mnNodeType == AnimationNodeType::ANIMATEMOTION ) ? AnimationCalcMode::PACED : AnimationCalcMode::LINEAR;
+
+    sal_uInt64 nMask = 0;
+    auto setBit = [&nMask]( SnapshotAttribute eAttribute, bool bSet )
+    {
+        if( bSet )
+            nMask |= sal_uInt64( 1 ) << eAttribute;
+    };
+    setBit( SNAPSHOT_BEGIN, maBegin.hasValue() );
+    setBit( SNAPSHOT_DURATION, maDuration.hasValue() );
+    setBit( SNAPSHOT_END, maEnd.hasValue() );
+    setBit( SNAPSHOT_ENDSYNC, maEndSync.hasValue() );
+    setBit( SNAPSHOT_REPEATCOUNT, maRepeatCount.hasValue() );
+    setBit( SNAPSHOT_REPEATDURATION, maRepeatDuration.hasValue() );
+    setBit( SNAPSHOT_FILL, mnFill != AnimationFill::DEFAULT );
+    setBit( SNAPSHOT_FILLDEFAULT, mnFillDefault != AnimationFill::INHERIT );
+    setBit( SNAPSHOT_RESTART, mnRestart != AnimationRestart::DEFAULT );
+    setBit( SNAPSHOT_RESTARTDEFAULT, mnRestartDefault != AnimationRestart::INHERIT );
+    setBit( SNAPSHOT_ACCELERATION, mfAcceleration != 0.0 );
+    setBit( SNAPSHOT_DECELERATE, mfDecelerate != 0.0 );
+    setBit( SNAPSHOT_AUTOREVERSE, mbAutoReverse );
+    setBit( SNAPSHOT_USERDATA, maUserData.hasElements() );
+    setBit( SNAPSHOT_TARGET, maTarget.hasValue() );
+    setBit( SNAPSHOT_ATTRIBUTENAME, !maAttributeName.isEmpty() );
+    setBit( SNAPSHOT_FORMULA, !maFormula.isEmpty() );
+    setBit( SNAPSHOT_VALUES, maValues.hasElements() );
+    setBit( SNAPSHOT_KEYTIMES, maKeyTimes.hasElements() );
+    setBit( SNAPSHOT_VALUETYPE, mnValueType != 0 );
+    setBit( SNAPSHOT_SUBITEM, mnSubItem != 0 );
+    setBit( SNAPSHOT_CALCMODE, mnCalcMode != nDefaultCalcMode );
+    setBit( SNAPSHOT_ADDITIVE, mnAdditive != AnimationAdditiveMode::REPLACE );
+    setBit( SNAPSHOT_ACCUMULATE, mbAccumulate );
+    setBit( SNAPSHOT_FROM, maFrom.hasValue() );
+    setBit( SNAPSHOT_TO, maTo.hasValue() );
+    setBit( SNAPSHOT_BY, maBy.hasValue() );
+    setBit( SNAPSHOT_TIMEFILTER, maTimeFilter.hasElements() );
+    setBit( SNAPSHOT_COLORSPACE, mnColorSpace != AnimationColorSpace::RGB );
+    setBit( SNAPSHOT_DIRECTION, !mbDirection );
+    setBit( SNAPSHOT_PATH, maPath.hasValue() );
+    setBit( SNAPSHOT_ORIGIN, maOrigin.hasValue() );
+    setBit( SNAPSHOT_TRANSFORMTYPE, mnTransformType != AnimationTransformType::TRANSLATE );
+    setBit( SNAPSHOT_TRANSITION, mnTransition != TransitionType::BARWIPE );
+    setBit( SNAPSHOT_SUBTYPE, mnSubtype != TransitionSubType::DEFAULT );
+    setBit( SNAPSHOT_MODE, !mbMode );
+    setBit( SNAPSHOT_FADECOLOR, mnFadeColor != 0 );
+    setBit( SNAPSHOT_VOLUME, mfVolume != 1.0 );
+    setBit( SNAPSHOT_COMMAND, mnCommand != 0 );
+    setBit( SNAPSHOT_PARAMETER, maParameter.hasValue() );
+    setBit( SNAPSHOT_ITERATETYPE, mnIterateType != css::presentation::ShapeAnimationSubType::AS_WHOLE );
+    setBit( SNAPSHOT_ITERATEINTERVAL, mfIterateInterval != 0.0 );
+    rWriter.writeUInt( nMask );
+
+    auto isSet = [nMask]( SnapshotAttribute eAttribute ) { return ( nMask >> eAttribute ) & 1; };
+    if( isSet( SNAPSHOT_BEGIN ) )
+        rWriter.writeAny( maBegin );
+    if( isSet( SNAPSHOT_DURATION ) )
+        rWriter.writeAny( maDuration );
+    if( isSet( SNAPSHOT_END ) )
+        rWriter.writeAny( maEnd );
+    if( isSet( SNAPSHOT_ENDSYNC ) )
+        rWriter.writeAny( maEndSync );
+    if( isSet( SNAPSHOT_REPEATCOUNT ) )
+        rWriter.writeAny( maRepeatCount );
+    if( isSet( SNAPSHOT_REPEATDURATION ) )
+        rWriter.writeAny( maRepeatDuration );
+    if( isSet( SNAPSHOT_FILL ) )
+        rWriter.writeInt( mnFill );
+    if( isSet( SNAPSHOT_FILLDEFAULT ) )
+        rWriter.writeInt( mnFillDefault );
+    if( isSet( SNAPSHOT_RESTART ) )
+        rWriter.writeInt( mnRestart );
+    if( isSet( SNAPSHOT_RESTARTDEFAULT ) )
+        rWriter.writeInt( mnRestartDefault );
+    if( isSet( SNAPSHOT_ACCELERATION ) )
+        rWriter.writeDouble( mfAcceleration );
+    if( isSet( SNAPSHOT_DECELERATE ) )
+        rWriter.writeDouble( mfDecelerate );
+    if( isSet( SNAPSHOT_USERDATA ) )
+    {
+        rWriter.writeUInt( maUserData.getLength() );
+        for( const NamedValue& rValue : maUserData )
+        {
+            rWriter.writeString( rValue.Name );
+            rWriter.writeAny( rValue.Value );
+        }
+    }
+    if( isSet( SNAPSHOT_TARGET ) )
+        rWriter.writeAny( maTarget );
+    if( isSet( SNAPSHOT_ATTRIBUTENAME ) )
+        rWriter.writeString( maAttributeName );
+    if( isSet( SNAPSHOT_FORMULA ) )
+        rWriter.writeString( maFormula );
+    if( isSet( SNAPSHOT_VALUES ) )
+    {
+        rWriter.writeUInt( maValues.getLength() );
+        for( const Any& rValue : maValues )
+            rWriter.writeAny( rValue );
+    }
+    if( isSet( SNAPSHOT_KEYTIMES ) )
+    {
+        rWriter.writeUInt( maKeyTimes.getLength() );
+        for( double fKeyTime : maKeyTimes )
+            rWriter.writeDouble( fKeyTime );
+    }
+    if( isSet( SNAPSHOT_VALUETYPE ) )
+        rWriter.writeInt( mnValueType );
+    if( isSet( SNAPSHOT_SUBITEM ) )
+        rWriter.writeInt( mnSubItem );
+    if( isSet( SNAPSHOT_CALCMODE ) )
+        rWriter.writeInt( mnCalcMode );
+    if( isSet( SNAPSHOT_ADDITIVE ) )
+        rWriter.writeInt( mnAdditive );
+    if( isSet( SNAPSHOT_FROM ) )
+        rWriter.writeAny( maFrom );
+    if( isSet( SNAPSHOT_TO ) )
+        rWriter.writeAny( maTo );
+    if( isSet( SNAPSHOT_BY ) )
+        rWriter.writeAny( maBy );
+    if( isSet( SNAPSHOT_TIMEFILTER ) )
+    {
+        rWriter.writeUInt( maTimeFilter.getLength() );
+        for( const TimeFilterPair& rPair : maTimeFilter )
+        {
+            rWriter.writeDouble( rPair.Time );
+            rWriter.writeDouble( rPair.Progress );
+        }
+    }
+    if( isSet( SNAPSHOT_COLORSPACE ) )
+        rWriter.writeInt( mnColorSpace );
+    if( isSet( SNAPSHOT_PATH ) )
+        rWriter.writeAny( maPath );
+    if( isSet( SNAPSHOT_ORIGIN ) )
+        rWriter.writeAny( maOrigin );
+    if( isSet( SNAPSHOT_TRANSFORMTYPE ) )
+        rWriter.writeInt( mnTransformType );
+    if( isSet( SNAPSHOT_TRANSITION ) )
+        rWriter.writeInt( mnTransition );
+    if( isSet( SNAPSHOT_SUBTYPE ) )
+        rWriter.writeInt( mnSubtype );
+    if( isSet( SNAPSHOT_FADECOLOR ) )
+        rWriter.writeInt( mnFadeColor );
+    if( isSet( SNAPSHOT_VOLUME ) )
+        rWriter.writeDouble( mfVolume );
+    if( isSet( SNAPSHOT_COMMAND ) )
+        rWriter.writeInt( mnCommand );
+    if( isSet( SNAPSHOT_PARAMETER ) )
+        rWriter.writeAny( maParameter );
+    if( isSet( SNAPSHOT_ITERATETYPE ) )
+        rWriter.writeInt( mnIterateType );
+    if( isSet( SNAPSHOT_ITERATEINTERVAL ) )
+        rWriter.writeDouble( mfIterateInterval );
+
+    // the children by their index, or children implemented elsewhere by reference
+    rWriter.writeUInt( maChildren.size() );
+    for( const auto& rxChild : maChildren )
+    {
+        auto aIter = rIndexes.find( getImplementation( rxChild ) );
+        if( aIter != rIndexes.end() )
+            rWriter.writeUInt( aIter->second );
+        else
+        {
+            rWriter.writeUInt( 0 );
+            rWriter.writeReference( Any( rxChild ) );
+        }
+    }
+}
+
+
+Reference< XAnimationNode > AnimationNode::readSnapshot( SnapshotReader& rReader )
+{
+    const sal_Int32 nCount = rReader.readCount();
+    if( nCount == 0 )
+        SnapshotReader::fail();
+
+    std::vector< AnimationNode* > aNodes;
+    std::vector< Reference< XAnimationNode > > aReferences;
+    for( sal_Int32 i = 0; i < nCount; ++i )
+    {
+        AnimationNode* pNode = new AnimationNode( rReader.readNodeType() );
+        aReferences.emplace_back( static_cast< XTimeContainer* >( static_cast< XIterateContainer* >( pNode ) ) );
+        aNodes.push_back( pNode );
+        rReader.addNode( aReferences.back() );
+    }
+
+    for( sal_Int32 i = 0; i < nCount; ++i )
+    {
+        AnimationNode* pNode = aNodes[i];
+        pNode->readNodeSnapshot( rReader );
+
+        const sal_Int32 nChildren = rReader.readCount();
+        for( sal_Int32 nChild = 0; nChild < nChildren; ++nChild )
+        {
+            const sal_uInt64 nIndex = rReader.readUInt();
+            if( nIndex == 0 )
+            {
+                // not ours, so it can only be cloned
+                Reference< XCloneable > xCloneable( rReader.readReference(), UNO_QUERY );
+                if( xCloneable.is() )
+                {
+                    Reference< XAnimationNode > xChild( xCloneable->createClone(), UNO_QUERY );
+                    if( xChild.is() )
+                    {
+                        xChild->setParent( static_cast< OWeakObject* >( pNode ) );
+                        pNode->maChildren.push_back( xChild );
+                    }
+                }
+                continue;
+            }
+
+            // children come after their parent, and have one parent only
+            if( nIndex <= static_cast< sal_uInt64 >( i ) || nIndex >= static_cast< sal_uInt64 >( nCount )
+                || aNodes[nIndex]->mpParent )
+                SnapshotReader::fail();
+
+            AnimationNode* pChild = aNodes[nIndex];
+            pChild->mxParent = Reference< XInterface >( static_cast< OWeakObject* >( pNode ) );
+            pChild->mpParent = pNode;
+            pNode->maChildren.push_back( aReferences[nIndex] );
+        }
+    }
+
+    if( !rReader.atEnd() )
+        SnapshotReader::fail();
+    for( sal_Int32 i = 1; i < nCount; ++i )
+    {
+        if( !aNodes[i]->mpParent )
+            SnapshotReader::fail();
+    }
+
+    return aReferences[0];
+}
+
+
+void AnimationNode::readNodeSnapshot( SnapshotReader& rReader )
+{
+    const sal_uInt64 nMask = rReader.readUInt();
+    if( nMask >> SNAPSHOT_ATTRIBUTE_COUNT )
+        SnapshotReader::fail();
+
+    auto isSet = [nMask]( SnapshotAttribute eAttribute ) { return ( nMask >> eAttribute ) & 1; };
+    if( isSet( SNAPSHOT_BEGIN ) )
+        maBegin = rReader.readAny();
+    if( isSet( SNAPSHOT_DURATION ) )
+        maDuration = rReader.readAny();
+    if( isSet( SNAPSHOT_END ) )
+        maEnd = rReader.readAny();
+    if( isSet( SNAPSHOT_ENDSYNC ) )
+        maEndSync = rReader.readAny();
+    if( isSet( SNAPSHOT_REPEATCOUNT ) )
+        maRepeatCount = rReader.readAny();
+    if( isSet( SNAPSHOT_REPEATDURATION ) )
+        maRepeatDuration = rReader.readAny();
+    if( isSet( SNAPSHOT_FILL ) )
+        mnFill = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_FILLDEFAULT ) )
+        mnFillDefault = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_RESTART ) )
+        mnRestart = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_RESTARTDEFAULT ) )
+        mnRestartDefault = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_ACCELERATION ) )
+        mfAcceleration = rReader.readDouble();
+    if( isSet( SNAPSHOT_DECELERATE ) )
+        mfDecelerate = rReader.readDouble();
+    mbAutoReverse = isSet( SNAPSHOT_AUTOREVERSE );
+    if( isSet( SNAPSHOT_USERDATA ) )
+    {
+        maUserData.realloc( rReader.readCount() );
+        for( NamedValue& rValue : maUserData )
+        {
+            rValue.Name = rReader.readString();
+            rValue.Value = rReader.readAny();
+        }
+    }
+    if( isSet( SNAPSHOT_TARGET ) )
+        maTarget = rReader.readAny();
+    if( isSet( SNAPSHOT_ATTRIBUTENAME ) )
+        maAttributeName = rReader.readString();
+    if( isSet( SNAPSHOT_FORMULA ) )
+        maFormula = rReader.readString();
+    if( isSet( SNAPSHOT_VALUES ) )
+    {
+        maValues.realloc( rReader.readCount() );
+        for( Any& rValue : maValues )
+            rValue = rReader.readAny();
+    }
+    if( isSet( SNAPSHOT_KEYTIMES ) )
+    {
+        maKeyTimes.realloc( rReader.readCount() );
+        for( double& rKeyTime : maKeyTimes )
+            rKeyTime = rReader.readDouble();
+    }
+    if( isSet( SNAPSHOT_VALUETYPE ) )
+        mnValueType = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_SUBITEM ) )
+        mnSubItem = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_CALCMODE ) )
+        mnCalcMode = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_ADDITIVE ) )
+        mnAdditive = static_cast< sal_Int16 >( rReader.readInt() );
+    mbAccumulate = isSet( SNAPSHOT_ACCUMULATE );
+    if( isSet( SNAPSHOT_FROM ) )
+        maFrom = rReader.readAny();
+    if( isSet( SNAPSHOT_TO ) )
+        maTo = rReader.readAny();
+    if( isSet( SNAPSHOT_BY ) )
+        maBy = rReader.readAny();
+    if( isSet( SNAPSHOT_TIMEFILTER ) )
+    {
+        maTimeFilter.realloc( rReader.readCount() );
+        for( TimeFilterPair& rPair : maTimeFilter )
+        {
+            rPair.Time = rReader.readDouble();
+            rPair.Progress = rReader.readDouble();
+        }
+    }
+    if( isSet( SNAPSHOT_COLORSPACE ) )
+        mnColorSpace = static_cast< sal_Int16 >( rReader.readInt() );
+    mbDirection = !isSet( SNAPSHOT_DIRECTION );
+    if( isSet( SNAPSHOT_PATH ) )
+        maPath = rReader.readAny();
+    if( isSet( SNAPSHOT_ORIGIN ) )
+        maOrigin = rReader.readAny();
+    if( isSet( SNAPSHOT_TRANSFORMTYPE ) )
+        mnTransformType = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_TRANSITION ) )
+        mnTransition = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_SUBTYPE ) )
+        mnSubtype = static_cast< sal_Int16 >( rReader.readInt() );
+    mbMode = !isSet( SNAPSHOT_MODE );
+    if( isSet( SNAPSHOT_FADECOLOR ) )
+        mnFadeColor = static_cast< sal_Int32 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_VOLUME ) )
+        mfVolume = rReader.readDouble();
+    if( isSet( SNAPSHOT_COMMAND ) )
+        mnCommand = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_PARAMETER ) )
+        maParameter = rReader.readAny();
+    if( isSet( SNAPSHOT_ITERATETYPE ) )
+        mnIterateType = static_cast< sal_Int16 >( rReader.readInt() );
+    if( isSet( SNAPSHOT_ITERATEINTERVAL ) )
+        mfIterateInterval = rReader.readDouble();
+}
+
+
+AnimationSnapshot AnimationSnapshot::create( const Reference< XAnimationNode >& rxRoot )
+{
+    AnimationNode* pRoot = AnimationNode::getImplementation( rxRoot );
+    if( !pRoot )
+        throw IllegalArgumentException();
+
+    SnapshotWriter aWriter;
+    pRoot->writeSnapshot( aWriter );
+    return aWriter.finish();
+}
+
+
+Reference< XAnimationNode > AnimationSnapshot::restore() const
+{
+    SnapshotReader aReader( *this );
+    return AnimationNode::readSnapshot( aReader );
+}
+
+
+AnimationSampler AnimationSampler::create( const Reference< XAnimationNode >& rxNode )
+{
+    AnimationNode* pNode = AnimationNode::getImplementation( rxNode );
+    if( !pNode )
+        throw IllegalArgumentException();
+    return pNode->createSampler();
+}
+
+
+size_t getStructureHash( const Reference< XAnimationNode >& rxNode )
+{
+    AnimationNode* pNode = AnimationNode::getImplementation( rxNode );
+    if( !pNode )
+        throw IllegalArgumentException();
+    return pNode->getStructureHash();
+}
+
+
+bool equalsStructure( const Reference< XAnimationNode >& rxFirst, const Reference< XAnimationNode >& rxSecond )
+{
+    AnimationNode* pFirst = AnimationNode::getImplementation( rxFirst );
+    if( !pFirst || !AnimationNode::getImplementation( rxSecond ) )
+        throw IllegalArgumentException();
+    return pFirst->equalsStructure( rxSecond );
+}
+
+
+void sharePayloads( const std::vector< Reference< XAnimationNode > >& rRoots )
+{
+    PayloadPool aPool;
+    for( const auto& rxRoot : rRoots )
+    {
+        AnimationNode* pRoot = AnimationNode::getImplementation( rxRoot );
+        if( !pRoot )
+            throw IllegalArgumentException();
+        pRoot->sharePayloads( aPool );
+    }
+}
+
+
+std::vector< Reference< XAnimationNode > > findNodesByTarget( const Reference< XAnimationNode >& rxNode, const Any& rTarget )
+{
+    AnimationNode* pNode = AnimationNode::getImplementation( rxNode );
+    if( !pNode )
+        throw IllegalArgumentException();
+    return pNode->findNodesByTarget( rTarget );
+}
+
+
+std::vector< Reference< XAnimationNode > > findNodesByUserData( const Reference< XAnimationNode >& rxNode,
+                                                                const OUString& rName, const Any& rValue )
+{
+    AnimationNode* pNode = AnimationNode::getImplementation( rxNode );
+    if( !pNode )
+        throw IllegalArgumentException();
+    return pNode->findNodesByUserData( rName, rValue );
+}
+
+
+size_t AnyHash::operator()( const Any& rAny ) const
+{
+    switch( rAny.getValueTypeClass() )
+    {
+    case css::uno::TypeClass_INTERFACE:
+    {
+        Reference< XInterface > xInterface( rAny, UNO_QUERY );
+        return std::hash< XInterface* >()( xInterface.get() );
+    }
+    case css::uno::TypeClass_STRING:
+        return rAny.get< OUString >().hashCode();
+    case css::uno::TypeClass_BOOLEAN:
+        return std::hash< bool >()( rAny.get< bool >() );
+    case css::uno::TypeClass_BYTE:
+    case css::uno::TypeClass_SHORT:
+    case css::uno::TypeClass_UNSIGNED_SHORT:
+    case css::uno::TypeClass_LONG:
+    case css::uno::TypeClass_UNSIGNED_LONG:
+    case css::uno::TypeClass_HYPER:
+        return std::hash< sal_Int64 >()( rAny.get< sal_Int64 >() );
+    case css::uno::TypeClass_FLOAT:
+    case css::uno::TypeClass_DOUBLE:
+    {
+        // integral values must hash like the integers they compare equal to; only cast
+        // what fits, anything else would be undefined
+        double fValue = rAny.get< double >();
+        if( std::isfinite( fValue ) && fValue >= -9223372036854775808.0 && fValue < 9223372036854775808.0 )
+        {
+            sal_Int64 nValue = static_cast< sal_Int64 >( fValue );
+            if( static_cast< double >( nValue ) == fValue )
+                return std::hash< sal_Int64 >()( nValue );
+        }
+        return std::hash< double >()( fValue );
+    }
+    default:
+        break;
+    }
+
+    ParagraphTarget aParaTarget;
+    if( rAny >>= aParaTarget )
+    {
+        Reference< XInterface > xShape( aParaTarget.Shape, UNO_QUERY );
+        return std::hash< XInterface* >()( xShape.get() ) ^ aParaTarget.Paragraph;
+    }
+
+    // everything else is told apart by Any::operator== only
+    return rAny.getValueTypeName().hashCode();
+}
+
+
+WeakReference< XAnimationNode > AnimationNodeIndex::getWeakNode( AnimationNode* pNode )
+{
+    return Reference< XAnimationNode >( static_cast< XTimeContainer * >( static_cast< XIterateContainer * >( pNode ) ) );
+}
+
+
+void AnimationNodeIndex::insertTarget( AnimationNode* pNode, const Any& rTarget )
+{
+    if( !rTarget.hasValue() )
+        return;
+    WeakReference< XAnimationNode > xNode( getWeakNode( pNode ) );
+    Guard< Mutex > aGuard( maMutex );
+    maTargets[ rTarget ].emplace( pNode, xNode );
+}
+
+
+void AnimationNodeIndex::removeTarget( AnimationNode* pNode, const Any& rTarget )
+{
+    if( !rTarget.hasValue() )
+        return;
+    Guard< Mutex > aGuard( maMutex );
+    NodeMap_t::iterator aIter( maTargets.find( rTarget ) );
+    if( aIter != maTargets.end() )
+    {
+        aIter->second.erase( pNode );
+        if( aIter->second.empty() )
+            maTargets.erase( aIter );
+    }
+}
+
+
+void AnimationNodeIndex::insertUserData( AnimationNode* pNode, const Sequence< NamedValue >& rUserData )
+{
+    if( !rUserData.hasElements() )
+        return;
+    WeakReference< XAnimationNode > xNode( getWeakNode( pNode ) );
+    Guard< Mutex > aGuard( maMutex );
+    for( const NamedValue& rValue : rUserData )
+        maUserData[ rValue.Name ][ rValue.Value ].emplace( pNode, xNode );
+}
+
+
+void AnimationNodeIndex::removeUserData( AnimationNode* pNode, const Sequence< NamedValue >& rUserData )
+{
+    Guard< Mutex > aGuard( maMutex );
+    for( const NamedValue& rValue : rUserData )
+    {
+        auto aNameIter( maUserData.find( rValue.Name ) );
+        if( aNameIter == maUserData.end() )
+            continue;
+        NodeMap_t::iterator aIter( aNameIter->second.find( rValue.Value ) );
+        if( aIter != aNameIter->second.end() )
+        {
+            aIter->second.erase( pNode );
+            if( aIter->second.empty() )
+                aNameIter->second.erase( aIter );
+        }
+    }
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNodeIndex::getNodes( const NodeMap_t& rMap, const Any& rKey )
+{
+    std::vector< Reference< XAnimationNode > > aNodes;
+    NodeMap_t::const_iterator aIter( rMap.find( rKey ) );
+    if( aIter != rMap.end() )
+    {
+        aNodes.reserve( aIter->second.size() );
+        for( const auto& rEntry : aIter->second )
+        {
+            Reference< XAnimationNode > xNode( rEntry.second.get() );
+            if( xNode.is() )
+                aNodes.push_back( xNode );
+        }
+    }
+    return aNodes;
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNodeIndex::findByTarget( const Any& rTarget )
+{
+    Guard< Mutex > aGuard( maMutex );
+    return getNodes( maTargets, rTarget );
+}
+
+
+std::vector< Reference< XAnimationNode > > AnimationNodeIndex::findByUserData( const OUString& rName, const Any& rValue )
+{
+    Guard< Mutex > aGuard( maMutex );
+    auto aNameIter( maUserData.find( rName ) );
+    if( aNameIter == maUserData.end() )
+        return std::vector< Reference< XAnimationNode > >();
+    return getNodes( aNameIter->second, rValue );
+}
+
+
 } // namespace animcore
 
 
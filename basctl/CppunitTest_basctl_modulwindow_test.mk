@@ -0,0 +1,73 @@
+# -*- Mode: makefile-gmake; tab-width: 4; indent-tabs-mode: t -*-
+#*************************************************************************
+#
+# This file is part of the LibreOffice project.
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+#*************************************************************************
+
+$(eval $(call gb_CppunitTest_CppunitTest,basctl_modulwindow_test))
+
+$(eval $(call gb_CppunitTest_add_exception_objects,basctl_modulwindow_test, \
+    basctl/qa/unit/basctl-modulwindow-test \
+))
+
+$(eval $(call gb_CppunitTest_use_library_objects,basctl_modulwindow_test, \
+    basctl \
+))
+
+$(eval $(call gb_CppunitTest_set_include,basctl_modulwindow_test,\
+    -I$(SRCDIR)/basctl/source/basicide \
+    -I$(SRCDIR)/basctl/source/inc \
+    -I$(SRCDIR)/basctl/inc \
+    $$(INCLUDE) \
+))
+
+$(eval $(call gb_CppunitTest_use_libraries,basctl_modulwindow_test, \
+    comphelper \
+    cppu \
+    cppuhelper \
+    editeng \
+    fwe \
+    i18nlangtag \
+    sal \
+    sb \
+    sfx \
+    sot \
+    svl \
+    svt \
+    svx \
+    svxcore \
+    test \
+    tk \
+    tl \
+    ucbhelper \
+    unotest \
+    utl \
+    vcl \
+    xmlscript \
+))
+
+$(eval $(call gb_CppunitTest_use_external,basctl_modulwindow_test,boost_headers))
+
+$(eval $(call gb_CppunitTest_use_custom_headers,basctl_modulwindow_test,\
+	officecfg/registry \
+))
+
+$(eval $(call gb_CppunitTest_use_sdk_api,basctl_modulwindow_test))
+
+$(eval $(call gb_CppunitTest_use_ure,basctl_modulwindow_test))
+$(eval $(call gb_CppunitTest_use_vcl,basctl_modulwindow_test))
+
+$(eval $(call gb_CppunitTest_use_rdb,basctl_modulwindow_test,services))
+
+$(eval $(call gb_CppunitTest_use_configuration,basctl_modulwindow_test))
+
+$(eval $(call gb_CppunitTest_use_uiconfigs,basctl_modulwindow_test,\
+	modules/BasicIDE \
+))
+
+# vim: set noet sw=4 ts=4:
@@ -97,9 +97,12 @@ $(eval $(call gb_Library_add_exception_objects,basctl,\
 	basctl/source/basicide/register \
 	basctl/source/basicide/sbxitem \
 	basctl/source/basicide/scriptdocument \
+	basctl/source/basicide/symbolindex \
+	basctl/source/basicide/undopolicy \
 	basctl/source/basicide/unomodel \
 	basctl/source/dlged/dlgedclip \
 	basctl/source/dlged/dlged \
+	basctl/source/dlged/dlgedexport \
 	basctl/source/dlged/dlgedfac \
 	basctl/source/dlged/dlgedfunc \
 	basctl/source/dlged/dlgedlist \
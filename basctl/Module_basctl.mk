@@ -30,6 +30,13 @@ $(eval $(call gb_Module_add_l10n_targets,basctl,\
 	AllLangMoTarget_basctl \
 ))
 
+$(eval $(call gb_Module_add_check_targets,basctl,\
+	CppunitTest_basctl_dialogexport_test \
+	CppunitTest_basctl_modulwindow_test \
+	CppunitTest_basctl_symbolindex_test \
+	CppunitTest_basctl_undopolicy_test \
+))
+
 endif
 
 # screenshots
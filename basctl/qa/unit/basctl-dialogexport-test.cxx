@@ -0,0 +1,208 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <test/bootstrapfixture.hxx>
+#include <com/sun/star/beans/XPropertySet.hpp>
+#include <com/sun/star/container/XNameContainer.hpp>
+#include <com/sun/star/frame/XModel.hpp>
+#include <com/sun/star/io/XInputStream.hpp>
+#include <com/sun/star/io/XInputStreamProvider.hpp>
+#include <com/sun/star/lang/XMultiServiceFactory.hpp>
+#include <com/sun/star/resource/StringResourceWithLocation.hpp>
+#include <com/sun/star/task/XInteractionHandler.hpp>
+#include <unotools/tempfile.hxx>
+#include <xmlscript/xmldlg_imexp.hxx>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dlgedexport.hxx"
+
+using namespace ::com::sun::star;
+
+namespace
+{
+
+/// Tests that the dialogs the Basic IDE stores in parallel are the bytes of the serial export
+class BasctlDialogExportTest : public test::BootstrapFixture
+{
+public:
+    void testMultiPageDialog();
+    void testLocalizedDialog();
+    void testEncodeAll();
+
+    CPPUNIT_TEST_SUITE(BasctlDialogExportTest);
+    CPPUNIT_TEST(testMultiPageDialog);
+    CPPUNIT_TEST(testLocalizedDialog);
+    CPPUNIT_TEST(testEncodeAll);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// a dialog model with a button, as the dialog editor creates it
+    uno::Reference<container::XNameContainer> createDialog(const OUString& rName, const OUString& rLabel);
+    /// exports xDialogModel like DialogWindow::StoreData does
+    uno::Sequence<sal_Int8> exportDialog(const uno::Reference<container::XNameContainer>& xDialogModel);
+    static uno::Sequence<sal_Int8> getBytes(const uno::Reference<io::XInputStreamProvider>& xISP);
+    /// the snapshot of xDialogModel encodes to the bytes of the serial export
+    void checkSnapshot(const uno::Reference<container::XNameContainer>& xDialogModel);
+};
+
+uno::Reference<container::XNameContainer> BasctlDialogExportTest::createDialog(const OUString& rName,
+                                                                               const OUString& rLabel)
+{
+    uno::Reference<container::XNameContainer> xDialogModel(
+        m_xSFactory->createInstance("com.sun.star.awt.UnoControlDialogModel"), uno::UNO_QUERY_THROW);
+    uno::Reference<beans::XPropertySet> xDialogProps(xDialogModel, uno::UNO_QUERY_THROW);
+    xDialogProps->setPropertyValue("Name", uno::Any(rName));
+    xDialogProps->setPropertyValue("Width", uno::Any(sal_Int32(200)));
+    xDialogProps->setPropertyValue("Height", uno::Any(sal_Int32(150)));
+
+    uno::Reference<lang::XMultiServiceFactory> xFactory(xDialogModel, uno::UNO_QUERY_THROW);
+    uno::Reference<beans::XPropertySet> xButton(
+        xFactory->createInstance("com.sun.star.awt.UnoControlButtonModel"), uno::UNO_QUERY_THROW);
+    xButton->setPropertyValue("Name", uno::Any(OUString("CommandButton1")));
+    xButton->setPropertyValue("Label", uno::Any(rLabel));
+    xDialogModel->insertByName("CommandButton1", uno::Any(xButton));
+    return xDialogModel;
+}
+
+uno::Sequence<sal_Int8> BasctlDialogExportTest::exportDialog(const uno::Reference<container::XNameContainer>& xDialogModel)
+{
+    return getBytes(::xmlscript::exportDialogModel(xDialogModel, m_xContext, uno::Reference<frame::XModel>()));
+}
+
+uno::Sequence<sal_Int8> BasctlDialogExportTest::getBytes(const uno::Reference<io::XInputStreamProvider>& xISP)
+{
+    CPPUNIT_ASSERT(xISP.is());
+    uno::Sequence<sal_Int8> aBytes;
+    uno::Reference<io::XInputStream> xInput(xISP->createInputStream(), uno::UNO_SET_THROW);
+    uno::Sequence<sal_Int8> aChunk;
+    while (xInput->readBytes(aChunk, 4096) > 0)
+    {
+        sal_Int32 const nOld = aBytes.getLength();
+        aBytes.realloc(nOld + aChunk.getLength());
+        std::copy(aChunk.begin(), aChunk.end(), aBytes.begin() + nOld);
+    }
+    return aBytes;
+}
+
+void BasctlDialogExportTest::checkSnapshot(const uno::Reference<container::XNameContainer>& xDialogModel)
+{
+    uno::Sequence<sal_Int8> const aBytes = exportDialog(xDialogModel);
+    CPPUNIT_ASSERT(aBytes.hasElements());
+    basctl::DialogSnapshot const aSnapshot(xDialogModel, m_xContext, uno::Reference<frame::XModel>());
+    CPPUNIT_ASSERT(aBytes == getBytes(aSnapshot.Encode()));
+}
+
+void BasctlDialogExportTest::testMultiPageDialog()
+{
+    uno::Reference<container::XNameContainer> xDialogModel = createDialog("Dialog1", "OK");
+    uno::Reference<lang::XMultiServiceFactory> xFactory(xDialogModel, uno::UNO_QUERY_THROW);
+    uno::Reference<container::XNameContainer> xMultiPage(
+        xFactory->createInstance("com.sun.star.awt.UnoMultiPageModel"), uno::UNO_QUERY_THROW);
+    uno::Reference<beans::XPropertySet>(xMultiPage, uno::UNO_QUERY_THROW)->setPropertyValue(
+        "Name", uno::Any(OUString("MultiPage1")));
+
+    uno::Reference<lang::XMultiServiceFactory> xPageFactory(xMultiPage, uno::UNO_QUERY_THROW);
+    for (sal_Int32 nPage = 1; nPage <= 2; ++nPage)
+    {
+        OUString const aPageName = "Page" + OUString::number(nPage);
+        uno::Reference<container::XNameContainer> xPage(
+            xPageFactory->createInstance("com.sun.star.awt.UnoPageModel"), uno::UNO_QUERY_THROW);
+        uno::Reference<beans::XPropertySet>(xPage, uno::UNO_QUERY_THROW)->setPropertyValue(
+            "Name", uno::Any(aPageName));
+
+        uno::Reference<lang::XMultiServiceFactory> xControlFactory(xPage, uno::UNO_QUERY_THROW);
+        uno::Reference<beans::XPropertySet> xField(
+            xControlFactory->createInstance("com.sun.star.awt.UnoControlEditModel"), uno::UNO_QUERY_THROW);
+        OUString const aFieldName = "TextField" + OUString::number(nPage);
+        xField->setPropertyValue("Name", uno::Any(aFieldName));
+        // to be escaped
+        xField->setPropertyValue("Text", uno::Any(aPageName + " <\"&'> " + OUString(sal_Unicode(0x00E4))));
+        xPage->insertByName(aFieldName, uno::Any(xField));
+
+        xMultiPage->insertByName(aPageName, uno::Any(xPage));
+    }
+    xDialogModel->insertByName("MultiPage1", uno::Any(xMultiPage));
+
+    checkSnapshot(xDialogModel);
+}
+
+void BasctlDialogExportTest::testLocalizedDialog()
+{
+    utl::TempFile aTempDir(nullptr, true);
+    aTempDir.EnableKillingFile();
+
+    lang::Locale aEnglish("en", "US", "");
+    lang::Locale aGerman("de", "DE", "");
+    uno::Reference<resource::XStringResourceWithLocation> xResource
+        = resource::StringResourceWithLocation::create(m_xContext, aTempDir.GetURL() + "/", false, aEnglish,
+                                                       "Dialog1", "# Dialog1 strings",
+                                                       uno::Reference<task::XInteractionHandler>());
+    xResource->newLocale(aEnglish);
+    xResource->newLocale(aGerman);
+    xResource->setCurrentLocale(aEnglish, false);
+    xResource->setString("0.Dialog1.Title", "Dialog");
+    xResource->setString("1.Dialog1.CommandButton1.Label", "OK");
+    xResource->setCurrentLocale(aGerman, false);
+    xResource->setString("0.Dialog1.Title", "Dialog");
+    xResource->setString("1.Dialog1.CommandButton1.Label", "Ja");
+
+    // the properties refer to the strings by their ID, as after LocalizationMgr::setResourceIDsForDialog
+    uno::Reference<container::XNameContainer> xDialogModel = createDialog("Dialog1", "&1.Dialog1.CommandButton1.Label");
+    uno::Reference<beans::XPropertySet> xDialogProps(xDialogModel, uno::UNO_QUERY_THROW);
+    xDialogProps->setPropertyValue("ResourceResolver", uno::Any(xResource));
+    xDialogProps->setPropertyValue("Title", uno::Any(OUString("&0.Dialog1.Title")));
+
+    checkSnapshot(xDialogModel);
+}
+
+void BasctlDialogExportTest::testEncodeAll()
+{
+    std::vector<uno::Sequence<sal_Int8>> aSerial;
+    std::vector<std::unique_ptr<basctl::DialogSnapshot>> aSnapshots;
+    for (sal_Int32 i = 0; i < 16; ++i)
+    {
+        // a dialog without a snapshot, as when reading the model failed
+        if (i == 5)
+        {
+            aSerial.emplace_back();
+            aSnapshots.emplace_back();
+            continue;
+        }
+        uno::Reference<container::XNameContainer> const xDialogModel
+            = createDialog("Dialog" + OUString::number(i), "Button" + OUString::number(i));
+        aSerial.push_back(exportDialog(xDialogModel));
+        aSnapshots.emplace_back(new basctl::DialogSnapshot(xDialogModel, m_xContext, uno::Reference<frame::XModel>()));
+    }
+
+    std::vector<uno::Reference<io::XInputStreamProvider>> const aExports
+        = basctl::DialogSnapshot::EncodeAll(aSnapshots);
+    CPPUNIT_ASSERT_EQUAL(aSnapshots.size(), aExports.size());
+    for (size_t i = 0; i < aExports.size(); ++i)
+    {
+        if (!aSnapshots[i])
+        {
+            CPPUNIT_ASSERT(!aExports[i].is());
+            continue;
+        }
+        CPPUNIT_ASSERT(aSerial[i] == getBytes(aExports[i]));
+    }
+}
+
+} // namespace
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BasctlDialogExportTest);
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,196 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <test/bootstrapfixture.hxx>
+#include <rtl/ustrbuf.hxx>
+#include <sfx2/app.hxx>
+#include <sfx2/dispatch.hxx>
+#include <sfx2/objsh.hxx>
+#include <sfx2/viewfrm.hxx>
+#include <svx/svxids.hrc>
+#include <vcl/textdata.hxx>
+#include <vcl/textview.hxx>
+#include <vcl/xtextedt.hxx>
+
+#include <vector>
+
+#include "baside2.hxx"
+#include "basdoc.hxx"
+#include "basidesh.hxx"
+#include "iderdll.hxx"
+#include "scriptdocument.hxx"
+
+namespace
+{
+
+const sal_uInt32 nLines = 400;
+const char aLibName[] = "BasctlModulWindowTest";
+
+/// Tests releasing the edit engine of a module window and creating it again
+class BasctlModulWindowTest : public test::BootstrapFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testEvictEditor();
+    void testEvictEditors();
+
+    CPPUNIT_TEST_SUITE(BasctlModulWindowTest);
+    CPPUNIT_TEST(testEvictEditor);
+    CPPUNIT_TEST(testEvictEditors);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// a module of nLines lines in three-line subs
+    static OUString createSource();
+    /// a window with an edit engine for a new module rModName of the application Basic
+    basctl::ModulWindow& createModulWindow(const OUString& rModName);
+
+    SfxObjectShellLock m_xDocShell;
+    std::vector<OUString> m_aModNames;
+};
+
+void BasctlModulWindowTest::setUp()
+{
+    test::BootstrapFixture::setUp();
+
+    SfxApplication::GetOrCreate();
+    basctl::EnsureIde();
+
+    m_xDocShell = new basctl::DocShell;
+    m_xDocShell->DoInitNew();
+    CPPUNIT_ASSERT(SfxViewFrame::LoadHiddenDocument(*m_xDocShell, SFX_INTERFACE_NONE));
+    CPPUNIT_ASSERT(basctl::GetShell());
+}
+
+void BasctlModulWindowTest::tearDown()
+{
+    m_xDocShell->DoClose();
+    m_xDocShell.Clear();
+
+    basctl::ScriptDocument const aDocument(basctl::ScriptDocument::getApplicationScriptDocument());
+    for (OUString const& rModName : m_aModNames)
+        aDocument.removeModule(aLibName, rModName);
+    m_aModNames.clear();
+
+    test::BootstrapFixture::tearDown();
+}
+
+OUString BasctlModulWindowTest::createSource()
+{
+    OUStringBuffer aSource;
+    for (sal_uInt32 nSub = 0; nSub < nLines / 3; ++nSub)
+    {
+        aSource.append("Sub Test" + OUString::number(nSub) + "\n");
+        aSource.append("    MsgBox \"Test" + OUString::number(nSub) + "\"\n");
+        aSource.append("End Sub\n");
+    }
+    return aSource.makeStringAndClear();
+}
+
+basctl::ModulWindow& BasctlModulWindowTest::createModulWindow(const OUString& rModName)
+{
+    basctl::ScriptDocument const aDocument(basctl::ScriptDocument::getApplicationScriptDocument());
+    aDocument.getOrCreateLibrary(basctl::E_SCRIPTS, aLibName);
+    CPPUNIT_ASSERT(aDocument.insertModule(aLibName, rModName, createSource()));
+    m_aModNames.push_back(rModName);
+
+    VclPtr<basctl::ModulWindow> pModulWin = basctl::GetShell()->FindBasWin(aDocument, aLibName, rModName, true);
+    CPPUNIT_ASSERT(pModulWin);
+    pModulWin->AssertValidEditEngine();
+    CPPUNIT_ASSERT(pModulWin->GetEditEngine());
+    return *pModulWin;
+}
+
+void BasctlModulWindowTest::testEvictEditor()
+{
+    basctl::ModulWindow& rModulWin = createModulWindow("Module1");
+    rModulWin.Activating();
+
+    // an edit that is not in the module yet
+    rModulWin.GetEditEngine()->InsertText(TextSelection(TextPaM(0, 0)), "' edited\n");
+    CPPUNIT_ASSERT(rModulWin.IsModified());
+    OUString const aText = rModulWin.GetEditEngine()->GetText();
+
+    TextSelection const aSelection(TextPaM(120, 4), TextPaM(120, 10));
+    rModulWin.GetEditView()->SetSelection(aSelection);
+    long const nTextHeight = rModulWin.GetEditEngine()->GetTextHeight();
+    long const nMaxVisAreaStart = nTextHeight - rModulWin.GetEditorWindow().GetOutputSizePixel().Height();
+    Point const aStartDocPos(0, nTextHeight / 4);
+    CPPUNIT_ASSERT(aStartDocPos.Y() <= nMaxVisAreaStart);
+    rModulWin.GetEditView()->SetStartDocPos(aStartDocPos);
+    rModulWin.GetBreakPointWindow().GetCurYOffset() = aStartDocPos.Y();
+    rModulWin.GetLineNumberWindow().GetCurYOffset() = aStartDocPos.Y();
+
+    rModulWin.Deactivating();
+    CPPUNIT_ASSERT(rModulWin.EvictEditor());
+    CPPUNIT_ASSERT(!rModulWin.GetEditEngine());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), rModulWin.GetEditorMemoryUsage());
+
+    // the edit went to the module, from where the next edit engine reads it
+    rModulWin.Activating();
+    rModulWin.AssertValidEditEngine();
+    CPPUNIT_ASSERT(rModulWin.GetEditEngine());
+    CPPUNIT_ASSERT_EQUAL(aText, rModulWin.GetEditEngine()->GetText());
+    CPPUNIT_ASSERT(!rModulWin.IsModified());
+
+    CPPUNIT_ASSERT(aSelection == rModulWin.GetEditView()->GetSelection());
+    CPPUNIT_ASSERT_EQUAL(aStartDocPos.Y(), rModulWin.GetEditView()->GetStartDocPos().Y());
+    CPPUNIT_ASSERT_EQUAL(aStartDocPos.Y(), rModulWin.GetBreakPointWindow().GetCurYOffset());
+    CPPUNIT_ASSERT_EQUAL(aStartDocPos.Y(), rModulWin.GetLineNumberWindow().GetCurYOffset());
+}
+
+void BasctlModulWindowTest::testEvictEditors()
+{
+    basctl::Shell* pShell = basctl::GetShell();
+    basctl::ModulWindow& rModulWin1 = createModulWindow("Module1");
+    basctl::ModulWindow& rModulWin2 = createModulWindow("Module2");
+    basctl::ModulWindow& rCurWin = createModulWindow("Module3");
+
+    basctl::SbxItem aSbxItem(SID_BASICIDE_ARG_SBX, basctl::ScriptDocument::getApplicationScriptDocument(),
+                             aLibName, "Module3", basctl::TYPE_MODULE);
+    pShell->GetViewFrame()->GetDispatcher()->ExecuteList(SID_BASICIDE_SHOWSBX, SfxCallMode::SYNCHRON,
+                                                         { &aSbxItem });
+    CPPUNIT_ASSERT_EQUAL(static_cast<basctl::BaseWindow*>(&rCurWin), pShell->GetCurWindow());
+
+    // recently shown and within the budget
+    pShell->SetEvictAfter(SAL_MAX_UINT64);
+    pShell->SetEditorMemoryBudget(SAL_MAX_SIZE);
+    pShell->EvictEditors();
+    CPPUNIT_ASSERT(rModulWin1.GetEditEngine());
+    CPPUNIT_ASSERT(rModulWin2.GetEditEngine());
+
+    // over the budget
+    pShell->SetEditorMemoryBudget(0);
+    pShell->EvictEditors();
+    CPPUNIT_ASSERT(!rModulWin1.GetEditEngine());
+    CPPUNIT_ASSERT(!rModulWin2.GetEditEngine());
+    CPPUNIT_ASSERT(rCurWin.GetEditEngine());
+
+    // not shown for the evict time
+    rModulWin1.AssertValidEditEngine();
+    rModulWin2.AssertValidEditEngine();
+    pShell->SetEvictAfter(0);
+    pShell->SetEditorMemoryBudget(SAL_MAX_SIZE);
+    pShell->EvictEditors();
+    CPPUNIT_ASSERT(!rModulWin1.GetEditEngine());
+    CPPUNIT_ASSERT(!rModulWin2.GetEditEngine());
+    CPPUNIT_ASSERT(rCurWin.GetEditEngine());
+}
+
+} // namespace
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BasctlModulWindowTest);
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
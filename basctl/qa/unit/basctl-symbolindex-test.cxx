@@ -0,0 +1,184 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <test/bootstrapfixture.hxx>
+#include <com/sun/star/script/XLibraryContainer.hpp>
+#include <sfx2/app.hxx>
+
+#include <memory>
+
+#include "scriptdocument.hxx"
+#include "symbolindex.hxx"
+
+using namespace ::com::sun::star;
+
+namespace
+{
+
+const char aLibName[] = "BasctlSymbolIndexTest";
+
+const char aSource[] =
+    "Sub Foo\n"
+    "    Bar 1\n"
+    "End Sub\n"
+    "\n"
+    "Sub Bar(n)\n"
+    "    BAR = n\n"
+    "End Sub\n";
+
+/// Tests keeping the index of the Basic procedures and identifiers current from the library events
+class BasctlSymbolIndexTest : public test::BootstrapFixture
+{
+public:
+    virtual void setUp() override;
+    virtual void tearDown() override;
+
+    void testInsert();
+    void testReplace();
+    void testRemove();
+    void testRename();
+    void testIgnoreCase();
+
+    CPPUNIT_TEST_SUITE(BasctlSymbolIndexTest);
+    CPPUNIT_TEST(testInsert);
+    CPPUNIT_TEST(testReplace);
+    CPPUNIT_TEST(testRemove);
+    CPPUNIT_TEST(testRename);
+    CPPUNIT_TEST(testIgnoreCase);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// checks a location in rModName of the test library
+    static void checkLocation(const basctl::SymbolLocation& rLocation, const OUString& rModName, sal_uInt32 nLine,
+                              sal_Int32 nStart, sal_Int32 nEnd);
+
+    std::unique_ptr<basctl::ScriptDocument> m_pDocument;
+    std::unique_ptr<basctl::SymbolIndex> m_pIndex;
+};
+
+void BasctlSymbolIndexTest::setUp()
+{
+    test::BootstrapFixture::setUp();
+
+    SfxApplication::GetOrCreate();
+    m_pDocument.reset(new basctl::ScriptDocument(basctl::ScriptDocument::getApplicationScriptDocument()));
+
+    // the index is there before the library, which it has to pick up from the events
+    m_pIndex.reset(new basctl::SymbolIndex);
+    CPPUNIT_ASSERT(m_pDocument->getOrCreateLibrary(basctl::E_SCRIPTS, aLibName).is());
+    CPPUNIT_ASSERT(m_pDocument->insertModule(aLibName, "Module1", aSource));
+}
+
+void BasctlSymbolIndexTest::tearDown()
+{
+    m_pIndex.reset();
+    uno::Reference<script::XLibraryContainer> xModLibContainer(m_pDocument->getLibraryContainer(basctl::E_SCRIPTS));
+    if (xModLibContainer.is() && xModLibContainer->hasByName(aLibName))
+        xModLibContainer->removeLibrary(aLibName);
+    m_pDocument.reset();
+
+    test::BootstrapFixture::tearDown();
+}
+
+void BasctlSymbolIndexTest::checkLocation(const basctl::SymbolLocation& rLocation, const OUString& rModName,
+                                          sal_uInt32 nLine, sal_Int32 nStart, sal_Int32 nEnd)
+{
+    CPPUNIT_ASSERT_EQUAL(OUString(aLibName), rLocation.aLibName);
+    CPPUNIT_ASSERT_EQUAL(rModName, rLocation.aModName);
+    CPPUNIT_ASSERT_EQUAL(nLine, rLocation.nLine);
+    CPPUNIT_ASSERT_EQUAL(nStart, rLocation.nStart);
+    CPPUNIT_ASSERT_EQUAL(nEnd, rLocation.nEnd);
+}
+
+void BasctlSymbolIndexTest::testInsert()
+{
+    std::vector<basctl::SymbolLocation> aLocations = m_pIndex->FindDefinitions("Foo");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Module1", 0, 4, 7);
+
+    // the declaration of Bar is not a reference to it
+    aLocations = m_pIndex->FindDefinitions("Bar");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Module1", 4, 4, 7);
+    aLocations = m_pIndex->FindReferences("Bar");
+    CPPUNIT_ASSERT_EQUAL(size_t(2), aLocations.size());
+    checkLocation(aLocations[0], "Module1", 1, 4, 7);
+    checkLocation(aLocations[1], "Module1", 5, 4, 7);
+
+    // a second module
+    CPPUNIT_ASSERT(m_pDocument->insertModule(aLibName, "Module2", "Sub Main\n    Foo\nEnd Sub\n"));
+    aLocations = m_pIndex->FindReferences("Foo");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Module2", 1, 4, 7);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), m_pIndex->FindDefinitions("Main").size());
+}
+
+void BasctlSymbolIndexTest::testReplace()
+{
+    CPPUNIT_ASSERT(m_pDocument->updateModule(aLibName, "Module1", "Sub Baz\n    Bar 1\nEnd Sub\n"));
+
+    // only what the new source has
+    CPPUNIT_ASSERT(m_pIndex->FindDefinitions("Foo").empty());
+    CPPUNIT_ASSERT(m_pIndex->FindDefinitions("Bar").empty());
+    std::vector<basctl::SymbolLocation> aLocations = m_pIndex->FindDefinitions("Baz");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Module1", 0, 4, 7);
+    aLocations = m_pIndex->FindReferences("Bar");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Module1", 1, 4, 7);
+}
+
+void BasctlSymbolIndexTest::testRemove()
+{
+    size_t const nModules = m_pIndex->GetModuleCount();
+    CPPUNIT_ASSERT(m_pDocument->removeModule(aLibName, "Module1"));
+
+    CPPUNIT_ASSERT_EQUAL(nModules - 1, m_pIndex->GetModuleCount());
+    CPPUNIT_ASSERT(m_pIndex->FindDefinitions("Foo").empty());
+    CPPUNIT_ASSERT(m_pIndex->FindDefinitions("Bar").empty());
+    CPPUNIT_ASSERT(m_pIndex->FindReferences("Bar").empty());
+}
+
+void BasctlSymbolIndexTest::testRename()
+{
+    size_t const nModules = m_pIndex->GetModuleCount();
+    CPPUNIT_ASSERT(m_pDocument->renameModule(aLibName, "Module1", "Renamed"));
+
+    CPPUNIT_ASSERT_EQUAL(nModules, m_pIndex->GetModuleCount());
+    std::vector<basctl::SymbolLocation> aLocations = m_pIndex->FindDefinitions("Foo");
+    CPPUNIT_ASSERT_EQUAL(size_t(1), aLocations.size());
+    checkLocation(aLocations[0], "Renamed", 0, 4, 7);
+    aLocations = m_pIndex->FindReferences("Bar");
+    CPPUNIT_ASSERT_EQUAL(size_t(2), aLocations.size());
+    checkLocation(aLocations[0], "Renamed", 1, 4, 7);
+}
+
+void BasctlSymbolIndexTest::testIgnoreCase()
+{
+    // Basic does not tell Bar from BAR, so neither does the index
+    CPPUNIT_ASSERT_EQUAL(size_t(1), m_pIndex->FindDefinitions("FOO").size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), m_pIndex->FindDefinitions("foo").size());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), m_pIndex->FindReferences("bar").size());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), m_pIndex->FindReferences("BAR").size());
+
+    // whatever the case of the name, the same positions
+    std::vector<basctl::SymbolLocation> const aLocations = m_pIndex->FindReferences("bAr");
+    CPPUNIT_ASSERT_EQUAL(size_t(2), aLocations.size());
+    checkLocation(aLocations[1], "Module1", 5, 4, 7);
+}
+
+} // namespace
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BasctlSymbolIndexTest);
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
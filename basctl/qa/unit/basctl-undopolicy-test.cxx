@@ -0,0 +1,125 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sal/config.h>
+
+#include <test/bootstrapfixture.hxx>
+#include <rtl/ustrbuf.hxx>
+#include <svl/undo.hxx>
+#include <vcl/textdata.hxx>
+#include <vcl/xtextedt.hxx>
+
+#include "undopolicy.hxx"
+
+namespace
+{
+
+const sal_uInt32 nLines = 500;
+const sal_Int32 nLineLen = 1000;
+
+/// Tests keeping the undo history of the Basic editor within its memory budget
+class BasctlUndoPolicyTest : public test::BootstrapFixture
+{
+public:
+    void testReplaceAll();
+    void testSetMemoryBudget();
+
+    CPPUNIT_TEST_SUITE(BasctlUndoPolicyTest);
+    CPPUNIT_TEST(testReplaceAll);
+    CPPUNIT_TEST(testSetMemoryBudget);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    /// a module of nLines lines of nLineLen times c
+    static OUString createSource(sal_Unicode c);
+    /// replaces every line with one of the same length, as replace-all does, in one list action
+    static void replaceAll(ExtTextEngine& rEngine, SfxUndoManager& rManager, sal_Unicode c);
+};
+
+OUString BasctlUndoPolicyTest::createSource(sal_Unicode c)
+{
+    OUStringBuffer aSource;
+    for (sal_uInt32 nLine = 0; nLine < nLines; ++nLine)
+    {
+        if (nLine)
+            aSource.append('\n');
+        for (sal_Int32 i = 0; i < nLineLen; ++i)
+            aSource.append(c);
+    }
+    return aSource.makeStringAndClear();
+}
+
+void BasctlUndoPolicyTest::replaceAll(ExtTextEngine& rEngine, SfxUndoManager& rManager, sal_Unicode c)
+{
+    OUStringBuffer aLine;
+    for (sal_Int32 i = 0; i < nLineLen; ++i)
+        aLine.append(c);
+    OUString const aNewLine(aLine.makeStringAndClear());
+
+    rManager.EnterListAction("Replace All", OUString(), 0, ViewShellId(-1));
+    for (sal_uInt32 nLine = 0; nLine < nLines; ++nLine)
+        rEngine.ReplaceText(TextSelection(TextPaM(nLine, 0), TextPaM(nLine, nLineLen)), aNewLine);
+    rManager.LeaveListAction();
+}
+
+void BasctlUndoPolicyTest::testReplaceAll()
+{
+    ExtTextEngine aEngine;
+    aEngine.SetText(createSource('a'));
+    aEngine.EnableUndo(true);
+    SfxUndoManager* pManager = dynamic_cast<SfxUndoManager*>(&aEngine.GetUndoManager());
+    CPPUNIT_ASSERT(pManager);
+
+    size_t const nTextBytes = nLines * nLineLen * sizeof(sal_Unicode);
+    basctl::UndoPolicy aPolicy(*pManager, aEngine, 100, 3 * nTextBytes);
+
+    // the text length does not change, but the history keeps the replaced and the new text
+    replaceAll(aEngine, *pManager, 'b');
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pManager->GetUndoActionCount());
+    CPPUNIT_ASSERT(aPolicy.GetMemoryUsage() >= 2 * nTextBytes);
+    CPPUNIT_ASSERT(aPolicy.GetMemoryUsage() <= aPolicy.GetMemoryBudget());
+
+    // both do not fit into the budget, so the older one is dropped
+    replaceAll(aEngine, *pManager, 'c');
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pManager->GetUndoActionCount());
+    CPPUNIT_ASSERT(aPolicy.GetMemoryUsage() >= 2 * nTextBytes);
+    CPPUNIT_ASSERT(aPolicy.GetMemoryUsage() <= aPolicy.GetMemoryBudget());
+    CPPUNIT_ASSERT_EQUAL(createSource('c'), aEngine.GetText());
+}
+
+void BasctlUndoPolicyTest::testSetMemoryBudget()
+{
+    ExtTextEngine aEngine;
+    aEngine.SetText(createSource('a'));
+    aEngine.EnableUndo(true);
+    SfxUndoManager* pManager = dynamic_cast<SfxUndoManager*>(&aEngine.GetUndoManager());
+    CPPUNIT_ASSERT(pManager);
+
+    size_t const nTextBytes = nLines * nLineLen * sizeof(sal_Unicode);
+    basctl::UndoPolicy aPolicy(*pManager, aEngine, 100, 10 * nTextBytes);
+    replaceAll(aEngine, *pManager, 'b');
+    replaceAll(aEngine, *pManager, 'c');
+    replaceAll(aEngine, *pManager, 'd');
+    CPPUNIT_ASSERT_EQUAL(size_t(3), pManager->GetUndoActionCount());
+
+    // a smaller budget applies at once, the newest action is kept whatever its size
+    aPolicy.SetMemoryBudget(3 * nTextBytes);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pManager->GetUndoActionCount());
+    aPolicy.SetMemoryBudget(nTextBytes);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pManager->GetUndoActionCount());
+    CPPUNIT_ASSERT(aPolicy.GetMemoryUsage() > aPolicy.GetMemoryBudget());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BasctlUndoPolicyTest);
+
+}
+
+CPPUNIT_PLUGIN_IMPLEMENT();
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -52,6 +52,7 @@ using namespace ::comphelper;
 AccessibleDialogControlShape::AccessibleDialogControlShape (DialogWindow* pDialogWindow, DlgEdObj* pDlgEdObj)
     :m_pDialogWindow( pDialogWindow )
     ,m_pDlgEdObj( pDlgEdObj )
+    ,m_nIndexInParent( -1 )
 {
     if ( m_pDlgEdObj )
         m_xControlModel.set( m_pDlgEdObj->GetUnoControlModel(), UNO_QUERY );
@@ -239,6 +240,7 @@ void AccessibleDialogControlShape::disposing()
 
     m_pDialogWindow = nullptr;
     m_pDlgEdObj = nullptr;
+    m_nIndexInParent = -1;
 
     if ( m_xControlModel.is() )
         m_xControlModel->removePropertyChangeListener( OUString(), static_cast< beans::XPropertyChangeListener* >( this ) );
@@ -337,30 +339,9 @@ sal_Int32 AccessibleDialogControlShape::getAccessibleIndexInParent(  )
 {
     OExternalLockGuard aGuard( this );
 
-    sal_Int32 nIndexInParent = -1;
-    Reference< XAccessible > xParent( getAccessibleParent() );
-    if ( xParent.is() )
-    {
-        Reference< XAccessibleContext > xParentContext( xParent->getAccessibleContext() );
-        if ( xParentContext.is() )
-        {
-            for ( sal_Int32 i = 0, nCount = xParentContext->getAccessibleChildCount(); i < nCount; ++i )
-            {
-                Reference< XAccessible > xChild( xParentContext->getAccessibleChild( i ) );
-                if ( xChild.is() )
-                {
-                    Reference< XAccessibleContext > xChildContext = xChild->getAccessibleContext();
-                    if ( xChildContext == static_cast<XAccessibleContext*>(this) )
-                    {
-                        nIndexInParent = i;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    return nIndexInParent;
+    // kept up to date by the parent on insert, remove and sort, so that we need not
+    // ask it for all our siblings
+    return m_nIndexInParent;
 }
 
 
@@ -239,14 +239,16 @@ void AccessibleDialogWindow::InsertChild( const ChildDescriptor& rDesc )
     // if not found, insert in child list
     if ( aIter == m_aAccessibleChildren.end() )
     {
-        // insert entry in child list
-        m_aAccessibleChildren.push_back( rDesc );
+        // insert entry at its sorted position in the child list
+        aIter = m_aAccessibleChildren.insert(
+            std::upper_bound( m_aAccessibleChildren.begin(), m_aAccessibleChildren.end(), rDesc ), rDesc );
+        size_t nIndex = aIter - m_aAccessibleChildren.begin();
 
         // get the accessible of the inserted child
-        Reference< XAccessible > xChild( getAccessibleChild( m_aAccessibleChildren.size() - 1 ) );
+        Reference< XAccessible > xChild( getAccessibleChild( nIndex ) );
 
-        // sort child list
-        SortChildren();
+        // the children behind it moved up by one
+        UpdateChildIndexes( nIndex + 1 );
 
         // send accessible child event
         if ( xChild.is() )
@@ -271,8 +273,12 @@ void AccessibleDialogWindow::RemoveChild( const ChildDescriptor& rDesc )
         Reference< XAccessible > xChild( aIter->rxAccessible );
 
         // remove entry from child list
+        size_t nIndex = aIter - m_aAccessibleChildren.begin();
         m_aAccessibleChildren.erase( aIter );
 
+        // the children behind it moved down by one
+        UpdateChildIndexes( nIndex );
+
         // send accessible child event
         if ( xChild.is() )
         {
@@ -319,6 +325,25 @@ void AccessibleDialogWindow::SortChildren()
 {
     // sort child list
     std::sort( m_aAccessibleChildren.begin(), m_aAccessibleChildren.end() );
+
+    UpdateChildIndexes( 0 );
+}
+
+
+void AccessibleDialogWindow::UpdateChildIndexes( size_t nFrom )
+{
+    // tell the children that already have an accessible where they are now, so they can
+    // answer getAccessibleIndexInParent without searching the child list
+    for ( size_t i = nFrom; i < m_aAccessibleChildren.size(); ++i )
+    {
+        Reference< XAccessible > xChild( m_aAccessibleChildren[i].rxAccessible );
+        if ( xChild.is() )
+        {
+            AccessibleDialogControlShape* pShape = static_cast< AccessibleDialogControlShape* >( xChild.get() );
+            if ( pShape )
+                pShape->m_nIndexInParent = i;
+        }
+    }
 }
 
 
@@ -612,7 +637,9 @@ Reference< XAccessible > AccessibleDialogWindow::getAccessibleChild( sal_Int32 i
             DlgEdObj* pDlgEdObj = m_aAccessibleChildren[i].pDlgEdObj;
             if ( pDlgEdObj )
             {
-                xChild = new AccessibleDialogControlShape( m_pDialogWindow, pDlgEdObj );
+                AccessibleDialogControlShape* pShape = new AccessibleDialogControlShape( m_pDialogWindow, pDlgEdObj );
+                pShape->m_nIndexInParent = i;
+                xChild = pShape;
 
                 // insert into child list
                 m_aAccessibleChildren[i].rxAccessible = xChild;
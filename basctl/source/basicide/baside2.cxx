@@ -21,7 +21,9 @@
 #include "baside3.hxx"
 #include "brkdlg.hxx"
 #include "iderdll.hxx"
+#include "iderdll2.hxx"
 #include "moduldlg.hxx"
+#include "symbolindex.hxx"
 #include "docsignature.hxx"
 #include "officecfg/Office/BasicIDE.hxx"
 
@@ -50,7 +52,9 @@
 #include <svx/svxids.hrc>
 #include <vcl/xtextedt.hxx>
 #include <vcl/settings.hxx>
+#include <tools/time.hxx>
 #include <toolkit/helper/vclunohelper.hxx>
+#include <algorithm>
 #include <cassert>
 
 namespace basctl
@@ -183,6 +187,7 @@ ModulWindow::ModulWindow (ModulWindowLayout* pParent, ScriptDocument const& rDoc
     , m_nValid(ValidWindow)
     , m_aXEditorWindow(VclPtr<ComplexEditorWindow>::Create(this))
     , m_aModule(aModule)
+    , m_nDeactivatedTicks(0)
 {
     m_aXEditorWindow->Show();
     SetBackground();
@@ -709,29 +714,75 @@ void ModulWindow::EditMacro( const OUString& rMacroName )
                     nStart--;
                     nEnd--;
                 }
-                TextSelection aSel( TextPaM( nStart, 0 ), TextPaM( nStart, 0 ) );
-                AssertValidEditEngine();
-                TextView * pView = GetEditView();
-                // scroll if applicable so that first line is at the top
-                long nVisHeight = GetOutputSizePixel().Height();
-                if ( pView->GetTextEngine()->GetTextHeight() > nVisHeight )
-                {
-                    long nMaxY = pView->GetTextEngine()->GetTextHeight() - nVisHeight;
-                    long nOldStartY = pView->GetStartDocPos().Y();
-                    long nNewStartY = (long)nStart * pView->GetTextEngine()->GetCharHeight();
-                    nNewStartY = std::min( nNewStartY, nMaxY );
-                    pView->Scroll( 0, -(nNewStartY-nOldStartY) );
-                    pView->ShowCursor( false );
-                    GetEditVScrollBar().SetThumbPos( pView->GetStartDocPos().Y() );
-                }
-                pView->SetSelection( aSel );
-                pView->ShowCursor();
-                pView->GetWindow()->GrabFocus();
+                ShowSelection( TextSelection( TextPaM( nStart, 0 ), TextPaM( nStart, 0 ) ) );
             }
         }
     }
 }
 
+void ModulWindow::ShowSelection( const TextSelection& rSel )
+{
+    AssertValidEditEngine();
+    TextView * pView = GetEditView();
+    // scroll if applicable so that first line is at the top
+    long nVisHeight = GetOutputSizePixel().Height();
+    if ( pView->GetTextEngine()->GetTextHeight() > nVisHeight )
+    {
+        long nMaxY = pView->GetTextEngine()->GetTextHeight() - nVisHeight;
+        long nOldStartY = pView->GetStartDocPos().Y();
+        long nNewStartY = (long)rSel.GetStart().GetPara() * pView->GetTextEngine()->GetCharHeight();
+        nNewStartY = std::min( nNewStartY, nMaxY );
+        pView->Scroll( 0, -(nNewStartY-nOldStartY) );
+        pView->ShowCursor( false );
+        GetEditVScrollBar().SetThumbPos( pView->GetStartDocPos().Y() );
+    }
+    pView->SetSelection( rSel );
+    pView->ShowCursor();
+    pView->GetWindow()->GrabFocus();
+}
+
+void ModulWindow::GoToSymbol( bool bDefinition )
+{
+    AssertValidEditEngine();
+    TextPaM const aCursor = GetEditView()->GetSelection().GetEnd();
+    OUString const aLine( GetEditEngine()->GetText( aCursor.GetPara() ) );
+
+    // the identifier the cursor is in or at
+    std::vector<HighlightPortion> aPortions;
+    SyntaxHighlighter( HighlighterLanguage::Basic ).getHighlightPortions( aLine, aPortions );
+    std::vector<HighlightPortion>::const_iterator const itName = std::find_if( aPortions.begin(), aPortions.end(),
+        [&aCursor]( HighlightPortion const& rPortion )
+        {
+            return rPortion.tokenType == TokenType::Identifier
+                && rPortion.nBegin <= aCursor.GetIndex() && aCursor.GetIndex() <= rPortion.nEnd;
+        } );
+    if ( itName == aPortions.end() )
+        return;
+    OUString const aName( aLine.copy( itName->nBegin, itName->nEnd - itName->nBegin ) );
+
+    // the index knows the sources in the libraries, so the open modules have to be there first
+    GetShell()->StoreAllModulWindows();
+
+    SymbolIndex& rIndex = GetExtraData()->GetSymbolIndex();
+    std::vector<SymbolLocation> const aLocations = bDefinition ? rIndex.FindDefinitions( aName ) : rIndex.FindReferences( aName );
+    if ( aLocations.empty() )
+        return;
+
+    // the one after the occurrence at the cursor, or the first one
+    size_t nNext = 0;
+    for ( size_t i = 0; i < aLocations.size(); ++i )
+    {
+        SymbolLocation const& rLocation = aLocations[i];
+        if ( rLocation.aDocument == m_aDocument && rLocation.aLibName == m_aLibName && rLocation.aModName == m_aName
+             && rLocation.nLine == aCursor.GetPara() && rLocation.nStart == itName->nBegin )
+        {
+            nNext = ( i + 1 ) % aLocations.size();
+            break;
+        }
+    }
+    GetShell()->ShowSymbol( aLocations[nNext] );
+}
+
 void ModulWindow::StoreData()
 {
     // StoreData is called when the BasicManager is destroyed or
@@ -1195,6 +1246,27 @@ void ModulWindow::Activating ()
 void ModulWindow::Deactivating()
 {
     Hide();
+    m_nDeactivatedTicks = tools::Time::GetSystemTicks();
+}
+
+bool ModulWindow::EvictEditor()
+{
+    if (!GetEditEngine())
+        return true;
+    if (StarBASIC::IsRunning())
+        return false;
+
+    // the source goes to the module, from where the next edit engine reads it
+    GetEditorWindow().SetSourceInBasic();
+    if (IsModified())
+        return false;
+
+    return GetEditorWindow().ReleaseEditEngine();
+}
+
+size_t ModulWindow::GetEditorMemoryUsage() const
+{
+    return m_aXEditorWindow->GetEdtWindow().GetMemoryUsage();
 }
 
 sal_uInt16 ModulWindow::StartSearchAndReplace( const SvxSearchItem& rSearchItem, bool bFromStart )
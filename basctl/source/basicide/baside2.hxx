@@ -60,6 +60,7 @@ namespace basctl
 
 class ObjectCatalog;
 class CodeCompleteListBox;
+class UndoPolicy;
 class CodeCompleteWindow;
 
 // #108672 Helper functions to get/set text in TextEngine
@@ -77,6 +78,7 @@ private:
 
     std::unique_ptr<TextView>        pEditView;
     std::unique_ptr<ExtTextEngine>   pEditEngine;
+    std::unique_ptr<UndoPolicy>      pUndoPolicy;
     ModulWindow&                     rModulWindow;
 
     rtl::Reference< ChangesListener > listener_;
@@ -104,6 +106,11 @@ private:
     bool            bDoSyntaxHighlight;
     bool            bDelayHighlight;
 
+    // the selection and scroll position of a released edit engine, for the next one
+    bool            bRestoreViewState;
+    TextSelection   aRestoreSelection;
+    Point           aRestoreDocPos;
+
     virtual css::uno::Reference< css::awt::XWindowPeer > GetComponentInterface(bool bCreate = true) override;
     CodeCompleteDataCache aCodeCompleteCache;
     VclPtr<CodeCompleteWindow> pCodeCompleteWnd;
@@ -146,6 +153,15 @@ public:
     void            DoDelayedSyntaxHighlight( sal_uLong nPara );
 
     void            CreateEditEngine();
+    /** frees the edit engine with all its caches, keeping the selection and scroll
+        position for the next one; the module source must be up to date
+
+        @return false if the engine is in use by an accessibility peer
+    */
+    bool            ReleaseEditEngine();
+    /// an estimate of the memory held by the edit engine, in bytes
+    size_t          GetMemoryUsage() const;
+    void            SetUndoMemoryBudget( size_t nMemoryBudget );
     void            SetScrollBarRanges();
     void            InitScrollBars();
 
@@ -308,6 +324,8 @@ private:
     SbModuleRef         m_xModule;
     OUString            m_sCurPath;
     OUString            m_aModule;
+    // when the window was last deactivated, for the eviction of its editor
+    sal_uInt64          m_nDeactivatedTicks;
 
     void                CheckCompileBasic();
     void                BasicExecute();
@@ -364,12 +382,26 @@ public:
     bool            BasicErrorHdl( StarBASIC const * pBasic );
     BasicDebugFlags BasicBreakHdl();
     void            AssertValidEditEngine();
+    /** releases the edit engine of an inactive window, keeping only its source and
+        view state; it is created again when the window is shown
+
+        @return false if the source cannot be stored now, e.g. while Basic is running
+    */
+    bool            EvictEditor();
+    size_t          GetEditorMemoryUsage() const;
+    sal_uInt64      GetDeactivatedTicks() const { return m_nDeactivatedTicks; }
 
     void            LoadBasic();
     void            SaveBasicSource();
     void            ImportDialog();
 
     void            EditMacro( const OUString& rMacroName );
+    /** moves to the next declaration of the procedure named at the cursor (bDefinition),
+        or to the next place the name is used, in all libraries of all documents
+    */
+    void            GoToSymbol( bool bDefinition );
+    /// selects rSel and scrolls, if needed, so that its line is at the top
+    void            ShowSelection( const TextSelection& rSel );
 
     void            ToggleBreakPoint( sal_uLong nLine );
 
@@ -28,6 +28,7 @@
 #include "baside2.hxx"
 #include "brkdlg.hxx"
 #include "iderdll.hxx"
+#include "undopolicy.hxx"
 
 #include <basic/sbmeth.hxx>
 #include <basic/sbuno.hxx>
@@ -226,6 +227,7 @@ EditorWindow::EditorWindow (vcl::Window* pParent, ModulWindow* pModulWindow) :
     bHighlighting(false),
     bDoSyntaxHighlight(true),
     bDelayHighlight(true),
+    bRestoreViewState(false),
     pCodeCompleteWnd(VclPtr<CodeCompleteWindow>::Create(this))
 {
     SetBackground(Wallpaper(rModulWindow.GetLayout().GetBackgroundColor()));
@@ -263,6 +265,7 @@ void EditorWindow::dispose()
 
     aSyntaxIdle.Stop();
 
+    pUndoPolicy.reset();
     if ( pEditEngine )
     {
         EndListening( *pEditEngine );
@@ -500,6 +503,16 @@ void EditorWindow::KeyInput( const KeyEvent& rKEvt )
     SfxViewShell *pVS( SfxViewShell::Current());
     bool bDone = pVS && pVS->KeyInput( rKEvt );
 
+    // F12 goes to where the procedure at the cursor is declared, Shift+F12 to where its name is used
+    if ( !bDone && rKEvt.GetKeyCode().GetCode() == KEY_F12
+         && !rKEvt.GetKeyCode().IsMod1() && !rKEvt.GetKeyCode().IsMod2() )
+    {
+        if( pCodeCompleteWnd->IsVisible() )
+            pCodeCompleteWnd->ClearAndHide();
+        rModulWindow.GoToSymbol( !rKEvt.GetKeyCode().IsShift() );
+        return;
+    }
+
     if( pCodeCompleteWnd->IsVisible() && CodeCompleteOptions::IsCodeCompleteOn() )
     {
         pCodeCompleteWnd->GetListBox()->KeyInput(rKEvt);
@@ -1006,6 +1019,12 @@ void EditorWindow::CreateEditEngine()
 
     pEditEngine->SetModified( false );
     pEditEngine->EnableUndo( true );
+    if (SfxUndoManager* pUndoManager = dynamic_cast<SfxUndoManager*>(&pEditEngine->GetUndoManager()))
+    {
+        pUndoPolicy.reset(new UndoPolicy(*pUndoManager, *pEditEngine,
+                                         officecfg::Office::Common::Undo::Steps::get(),
+                                         GetShell()->GetUndoMemoryBudget()));
+    }
 
     InitScrollBars();
 
@@ -1030,6 +1049,67 @@ void EditorWindow::CreateEditEngine()
 
     if (aDocument.isDocument() && aDocument.isReadOnly())
         rModulWindow.SetReadOnly(true);
+
+    if (bRestoreViewState)
+    {
+        bRestoreViewState = false;
+        pEditView->SetSelection(aRestoreSelection);
+
+        long nMaxVisAreaStart = pEditEngine->GetTextHeight() - GetOutputSizePixel().Height();
+        if (nMaxVisAreaStart < 0)
+            nMaxVisAreaStart = 0;
+        Point aStartDocPos(aRestoreDocPos);
+        if (aStartDocPos.Y() > nMaxVisAreaStart)
+            aStartDocPos.Y() = nMaxVisAreaStart;
+        pEditView->SetStartDocPos(aStartDocPos);
+        rModulWindow.GetBreakPointWindow().GetCurYOffset() = aStartDocPos.Y();
+        rModulWindow.GetLineNumberWindow().GetCurYOffset() = aStartDocPos.Y();
+        rModulWindow.GetBreakPointWindow().Invalidate();
+        rModulWindow.GetLineNumberWindow().Invalidate();
+        InitScrollBars();
+    }
+}
+
+bool EditorWindow::ReleaseEditEngine()
+{
+    if (!pEditEngine)
+        return true;
+    if (Window::GetComponentInterface(false).is())
+        return false;
+
+    aRestoreSelection = pEditView->GetSelection();
+    aRestoreDocPos = pEditView->GetStartDocPos();
+    bRestoreViewState = true;
+
+    aSyntaxIdle.Stop();
+    aSyntaxLineTable.clear();
+    pUndoPolicy.reset();
+    EndListening(*pEditEngine);
+    pEditEngine->RemoveView(pEditView.get());
+    pEditView.reset();
+    pEditEngine.reset();
+    return true;
+}
+
+size_t EditorWindow::GetMemoryUsage() const
+{
+    if (!pEditEngine)
+        return 0;
+
+    // the text, about as much again for its portions, lines and attributes, and the
+    // paragraphs themselves
+    size_t nUsage = static_cast<size_t>(pEditEngine->GetTextLen()) * sizeof(sal_Unicode) * 2
+                  + static_cast<size_t>(pEditEngine->GetParagraphCount()) * 256
+                  + aSyntaxLineTable.size() * sizeof(sal_uInt16) * 4;
+    if (pUndoPolicy)
+        nUsage += pUndoPolicy->GetMemoryUsage();
+    return nUsage;
+}
+
+void EditorWindow::SetUndoMemoryBudget( size_t nMemoryBudget )
+{
+    if (pUndoPolicy)
+        pUndoPolicy->SetMemoryBudget(nMemoryBudget);
 }
 
 void EditorWindow::Notify( SfxBroadcaster& /*rBC*/, const SfxHint& rHint )
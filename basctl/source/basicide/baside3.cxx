@@ -26,6 +26,7 @@
 #include "bastype2.hxx"
 #include "dlged.hxx"
 #include "dlgeddef.hxx"
+#include "dlgedexport.hxx"
 #include "dlgedmod.hxx"
 #include "dlgedview.hxx"
 #include "iderdll.hxx"
@@ -1179,29 +1180,78 @@ void DialogWindow::StoreData()
 {
     if ( IsModified() )
     {
+        Reference< XInputStreamProvider > xISP;
         try
         {
-            Reference< container::XNameContainer > xLib = GetDocument().getLibrary( E_DIALOGS, GetLibName(), true );
+            Reference< container::XNameContainer > xDialogModel = m_pEditor->GetDialog();
 
-            if( xLib.is() )
+            if( xDialogModel.is() )
             {
-                Reference< container::XNameContainer > xDialogModel = m_pEditor->GetDialog();
-
-                if( xDialogModel.is() )
-                {
-                    Reference< XComponentContext > xContext(
-                        comphelper::getProcessComponentContext() );
-                    Reference< XInputStreamProvider > xISP = ::xmlscript::exportDialogModel( xDialogModel, xContext, GetDocument().isDocument() ? GetDocument().getDocument() : Reference< frame::XModel >() );
-                    xLib->replaceByName( GetName(), Any( xISP ) );
-                }
+                Reference< XComponentContext > xContext(
+                    comphelper::getProcessComponentContext() );
+                xISP = ::xmlscript::exportDialogModel( xDialogModel, xContext, GetDocument().isDocument() ? GetDocument().getDocument() : Reference< frame::XModel >() );
             }
         }
         catch (const uno::Exception& )
         {
             DBG_UNHANDLED_EXCEPTION();
         }
-        MarkDocumentModified( GetDocument() );
-        m_pEditor->ClearModifyFlag();
+        StoreExport( xISP );
+    }
+}
+
+void DialogWindow::StoreExport( Reference< XInputStreamProvider > const& xISP )
+{
+    try
+    {
+        Reference< container::XNameContainer > xLib = GetDocument().getLibrary( E_DIALOGS, GetLibName(), true );
+
+        if( xLib.is() && xISP.is() )
+            xLib->replaceByName( GetName(), Any( xISP ) );
+    }
+    catch (const uno::Exception& )
+    {
+        DBG_UNHANDLED_EXCEPTION();
+    }
+    MarkDocumentModified( GetDocument() );
+    m_pEditor->ClearModifyFlag();
+}
+
+void DialogWindow::StoreDataInParallel( std::vector< VclPtr<DialogWindow> > const& rWindows )
+{
+    std::vector< VclPtr<DialogWindow> > aModified;
+    std::vector< std::unique_ptr<DialogSnapshot> > aSnapshots;
+    Reference< XComponentContext > xContext( comphelper::getProcessComponentContext() );
+    for ( VclPtr<DialogWindow> const& pWin : rWindows )
+    {
+        if ( !pWin->IsModified() )
+            continue;
+        std::unique_ptr<DialogSnapshot> pSnapshot;
+        try
+        {
+            Reference< container::XNameContainer > xDialogModel = pWin->m_pEditor->GetDialog();
+            ScriptDocument const& rDocument = pWin->GetDocument();
+            if ( xDialogModel.is() )
+                pSnapshot.reset( new DialogSnapshot( xDialogModel, xContext,
+                    rDocument.isDocument() ? rDocument.getDocument() : Reference< frame::XModel >() ) );
+        }
+        catch (const uno::Exception& )
+        {
+            DBG_UNHANDLED_EXCEPTION();
+        }
+        aModified.push_back( pWin );
+        aSnapshots.push_back( std::move( pSnapshot ) );
+    }
+
+    std::vector< Reference< XInputStreamProvider > > const aExports = DialogSnapshot::EncodeAll( aSnapshots );
+
+    // in the given order; what could not be encoded is exported like it always was
+    for ( size_t i = 0; i < aModified.size(); ++i )
+    {
+        if ( aExports[i].is() )
+            aModified[i]->StoreExport( aExports[i] );
+        else
+            aModified[i]->StoreData();
     }
 }
 
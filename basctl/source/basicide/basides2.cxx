@@ -26,6 +26,7 @@
 #include <strings.hrc>
 #include <baside2.hxx>
 #include <basdoc.hxx>
+#include <symbolindex.hxx>
 #include <vcl/xtextedt.hxx>
 #include <sfx2/dispatch.hxx>
 #include <sfx2/signaturestate.hxx>
@@ -213,6 +214,18 @@ VclPtr<ModulWindow> Shell::FindBasWin (
     return bCreateIfNotExist ? CreateBasWin(rDocument, rLibName, rName) : nullptr;
 }
 
+void Shell::ShowSymbol( SymbolLocation const& rLocation )
+{
+    SetCurLib(rLocation.aDocument, rLocation.aLibName);
+    VclPtr<ModulWindow> pWin = FindBasWin(rLocation.aDocument, rLocation.aLibName, rLocation.aModName, true);
+    if (!pWin)
+        return;
+    if (pWin != pCurWin)
+        SetCurWindow(pWin, true);
+    pWin->ShowSelection(TextSelection(TextPaM(rLocation.nLine, rLocation.nStart),
+                                      TextPaM(rLocation.nLine, rLocation.nEnd)));
+}
+
 void Shell::Move()
 {
 }
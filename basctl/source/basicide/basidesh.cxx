@@ -65,6 +65,10 @@
 #include <vcl/msgbox.hxx>
 #include <vcl/settings.hxx>
 #include <cppuhelper/implbase.hxx>
+#include <tools/time.hxx>
+
+#include <algorithm>
+#include <vector>
 
 namespace basctl
 {
@@ -72,6 +76,20 @@ namespace basctl
 using namespace ::com::sun::star::uno;
 using namespace ::com::sun::star;
 
+namespace
+{
+
+// the editor of a module window that has not been shown for this long is released,
+// until it is set otherwise
+const sal_uInt64 nDefaultEvictAfter = 5 * 60 * 1000;
+// as are those of the least recently shown windows, while all editors hold more than this
+const size_t nDefaultEditorMemoryBudget = 64 * 1024 * 1024;
+const sal_uInt64 nEvictTimeout = 60 * 1000;
+// the undo history of each module window is kept within this, until it is set otherwise
+const size_t nDefaultUndoMemoryBudget = 16 * 1024 * 1024;
+
+}
+
 class ContainerListenerImpl : public ::cppu::WeakImplHelper< container::XContainerListener >
 {
     Shell* mpShell;
@@ -159,7 +177,10 @@ Shell::Shell( SfxViewFrame* pFrame_, SfxViewShell* /* pOldShell */ ) :
     pLayout(nullptr),
     aObjectCatalog(VclPtr<ObjectCatalog>::Create(&GetViewFrame()->GetWindow())),
     m_bAppBasicModified( false ),
-    m_aNotifier( *this )
+    m_aNotifier( *this ),
+    m_nEvictAfter( nDefaultEvictAfter ),
+    m_nEditorMemoryBudget( nDefaultEditorMemoryBudget ),
+    m_nUndoMemoryBudget( nDefaultUndoMemoryBudget )
 {
     m_xLibListener = new ContainerListenerImpl( this );
     Init();
@@ -197,6 +218,10 @@ void Shell::Init()
     InitScrollBars();
     InitTabBar();
 
+    aEvictTimer.SetTimeout( nEvictTimeout );
+    aEvictTimer.SetInvokeHandler( LINK( this, Shell, EvictTimerHdl ) );
+    aEvictTimer.Start();
+
     SetCurLib( ScriptDocument::getApplicationScriptDocument(), "Standard", false, false );
 
     ShellCreated(this);
@@ -216,6 +241,7 @@ void Shell::Init()
 
 Shell::~Shell()
 {
+    aEvictTimer.Stop();
     m_aNotifier.dispose();
 
     ShellDestroyed(this);
@@ -355,13 +381,20 @@ void Shell::onDocumentModeChanged( const ScriptDocument& _rDocument )
 
 void Shell::StoreAllWindowData( bool bPersistent )
 {
+    std::vector< VclPtr<DialogWindow> > aDialogWindows;
     for (WindowTableIt it = aWindowTable.begin(); it != aWindowTable.end(); ++it)
     {
         BaseWindow* pWin = it->second;
         DBG_ASSERT( pWin, "PrepareClose: NULL-Pointer in Table?" );
-        if ( !pWin->IsSuspended() )
+        if ( pWin->IsSuspended() )
+            continue;
+        // the dialogs are exported together
+        if ( DialogWindow* pDlgWin = dynamic_cast< DialogWindow* >( pWin ) )
+            aDialogWindows.push_back( pDlgWin );
+        else
             pWin->StoreData();
     }
+    DialogWindow::StoreDataInParallel( aDialogWindows );
 
     if ( bPersistent  )
     {
@@ -376,6 +409,16 @@ void Shell::StoreAllWindowData( bool bPersistent )
     }
 }
 
+void Shell::StoreAllModulWindows()
+{
+    for (WindowTableIt it = aWindowTable.begin(); it != aWindowTable.end(); ++it)
+    {
+        ModulWindow* pModulWin = dynamic_cast<ModulWindow*>(it->second.get());
+        if (pModulWin && !pModulWin->IsSuspended())
+            pModulWin->StoreData();
+    }
+}
+
 
 bool Shell::PrepareClose( bool bUI )
 {
@@ -449,6 +492,66 @@ IMPL_LINK( Shell, TabBarHdl, ::TabBar *, pCurTabBar, void )
     SetCurWindow( pWin );
 }
 
+IMPL_LINK_NOARG( Shell, EvictTimerHdl, Timer *, void )
+{
+    EvictEditors();
+}
+
+void Shell::EvictEditors()
+{
+    sal_uInt64 const nNow = tools::Time::GetSystemTicks();
+    size_t nUsage = 0;
+    std::vector< std::pair< sal_uInt64, ModulWindow* > > aCandidates;
+    for (WindowTable::const_iterator it = aWindowTable.begin(); it != aWindowTable.end(); ++it)
+    {
+        ModulWindow* pModulWin = dynamic_cast<ModulWindow*>(it->second.get());
+        if (!pModulWin)
+            continue;
+        size_t const nWinUsage = pModulWin->GetEditorMemoryUsage();
+        if (!nWinUsage)
+            continue;
+        nUsage += nWinUsage;
+        if (pModulWin != pCurWin.get())
+            aCandidates.emplace_back( pModulWin->GetDeactivatedTicks(), pModulWin );
+    }
+
+    // the least recently shown first
+    std::sort( aCandidates.begin(), aCandidates.end(),
+        []( std::pair< sal_uInt64, ModulWindow* > const& rLeft, std::pair< sal_uInt64, ModulWindow* > const& rRight )
+        { return rLeft.first < rRight.first; } );
+    for (std::pair< sal_uInt64, ModulWindow* > const& rCandidate : aCandidates)
+    {
+        if (nNow - rCandidate.first < m_nEvictAfter && nUsage <= m_nEditorMemoryBudget)
+            break;
+        size_t const nWinUsage = rCandidate.second->GetEditorMemoryUsage();
+        if (rCandidate.second->EvictEditor())
+            nUsage -= nWinUsage;
+    }
+
+    SAL_INFO( "basctl.basicide", "editors of module windows hold about " << nUsage << " bytes" );
+}
+
+size_t Shell::GetEditorMemoryUsage() const
+{
+    size_t nUsage = 0;
+    for (WindowTable::const_iterator it = aWindowTable.begin(); it != aWindowTable.end(); ++it)
+    {
+        if (ModulWindow* pModulWin = dynamic_cast<ModulWindow*>(it->second.get()))
+            nUsage += pModulWin->GetEditorMemoryUsage();
+    }
+    return nUsage;
+}
+
+void Shell::SetUndoMemoryBudget( size_t nMemoryBudget )
+{
+    m_nUndoMemoryBudget = nMemoryBudget;
+    for (WindowTable::const_iterator it = aWindowTable.begin(); it != aWindowTable.end(); ++it)
+    {
+        if (ModulWindow* pModulWin = dynamic_cast<ModulWindow*>(it->second.get()))
+            pModulWin->GetEditorWindow().SetUndoMemoryBudget(nMemoryBudget);
+    }
+}
+
 
 bool Shell::NextPage( bool bPrev )
 {
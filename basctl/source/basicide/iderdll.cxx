@@ -28,6 +28,7 @@
 #include <strings.hrc>
 #include <basdoc.hxx>
 #include <basicmod.hxx>
+#include <symbolindex.hxx>
 
 #include <svl/srchitem.hxx>
 #include <svx/svxids.hrc>
@@ -170,6 +171,13 @@ void ExtraData::SetSearchItem (const SvxSearchItem& rItem)
     pSearchItem.reset(static_cast<SvxSearchItem*>(rItem.Clone()));
 }
 
+SymbolIndex& ExtraData::GetSymbolIndex()
+{
+    if (!pSymbolIndex)
+        pSymbolIndex.reset(new SymbolIndex);
+    return *pSymbolIndex;
+}
+
 IMPL_STATIC_LINK(ExtraData, GlobalBasicBreakHdl, StarBASIC *, pBasic, BasicDebugFlags)
 {
     BasicDebugFlags nRet = BasicDebugFlags::NONE;
@@ -32,10 +32,13 @@ class SvxSearchItem;
 namespace basctl
 {
 
+class SymbolIndex;
+
 class ExtraData
 {
 private:
     std::unique_ptr<SvxSearchItem> pSearchItem;
+    std::unique_ptr<SymbolIndex> pSymbolIndex;
 
     LibInfo        aLibInfo;
 
@@ -65,6 +68,8 @@ public:
     SvxSearchItem&    GetSearchItem() const { return *pSearchItem; }
     void              SetSearchItem( const SvxSearchItem& rItem );
 
+    SymbolIndex&      GetSymbolIndex();
+
     const OUString&   GetAddLibPath() const   { return aAddLibPath; }
     void              SetAddLibPath( const OUString& rPath ) { aAddLibPath = rPath; }
 
@@ -0,0 +1,489 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "symbolindex.hxx"
+
+#include <basic/basmgr.hxx>
+#include <basic/sbmeth.hxx>
+#include <basic/sbmod.hxx>
+#include <basic/sbstar.hxx>
+#include <com/sun/star/container/XContainer.hpp>
+#include <com/sun/star/container/XContainerListener.hpp>
+#include <com/sun/star/script/XLibraryContainer.hpp>
+#include <cppuhelper/implbase.hxx>
+#include <tools/diagnose_ex.h>
+#include <vcl/svapp.hxx>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace basctl
+{
+
+using namespace ::com::sun::star;
+using namespace ::com::sun::star::uno;
+
+namespace
+{
+
+bool LocationLess( const SymbolLocation& rLHS, const SymbolLocation& rRHS )
+{
+    if ( rLHS.aLibName != rRHS.aLibName )
+        return rLHS.aLibName < rRHS.aLibName;
+    if ( rLHS.aModName != rRHS.aModName )
+        return rLHS.aModName < rRHS.aModName;
+    if ( rLHS.nLine != rRHS.nLine )
+        return rLHS.nLine < rRHS.nLine;
+    return rLHS.nStart < rRHS.nStart;
+}
+
+}
+
+class SymbolIndex::LibraryListener : public ::cppu::WeakImplHelper< container::XContainerListener >
+{
+    SymbolIndex*                            m_pIndex;
+    ScriptDocument                          m_aDocument;
+    // empty for the library container, whose elements are the libraries
+    OUString                                m_aLibName;
+    Reference< container::XContainer >      m_xContainer;
+
+public:
+    LibraryListener( SymbolIndex& rIndex, const ScriptDocument& rDocument, const OUString& rLibName,
+                     const Reference< container::XContainer >& xContainer ) :
+        m_pIndex(&rIndex), m_aDocument(rDocument), m_aLibName(rLibName), m_xContainer(xContainer)
+    { }
+
+    void Start()
+    {
+        m_xContainer->addContainerListener(this);
+    }
+
+    void Stop()
+    {
+        m_pIndex = nullptr;
+        try
+        {
+            m_xContainer->removeContainerListener(this);
+        }
+        catch (const Exception&)
+        {
+            // the library or the document may be disposed already
+        }
+    }
+
+    // XEventListener
+    virtual void SAL_CALL disposing( const lang::EventObject& ) override {}
+
+    // XContainerListener
+    virtual void SAL_CALL elementInserted( const container::ContainerEvent& rEvent ) override
+    {
+        SolarMutexGuard aGuard;
+        OUString aName;
+        if (!m_pIndex || !(rEvent.Accessor >>= aName))
+            return;
+        if (m_aLibName.isEmpty())
+            m_pIndex->LibraryInserted(m_aDocument, aName);
+        else
+        {
+            OUString aSource;
+            if (rEvent.Element >>= aSource)
+                m_pIndex->ModuleChanged(m_aDocument, m_aLibName, aName, aSource);
+        }
+    }
+    virtual void SAL_CALL elementReplaced( const container::ContainerEvent& rEvent ) override
+    {
+        SolarMutexGuard aGuard;
+        OUString aName;
+        if (m_pIndex && m_aLibName.isEmpty() && (rEvent.Accessor >>= aName))
+            m_pIndex->LibraryRemoved(m_aDocument, aName);
+        elementInserted(rEvent);
+    }
+    virtual void SAL_CALL elementRemoved( const container::ContainerEvent& rEvent ) override
+    {
+        SolarMutexGuard aGuard;
+        OUString aName;
+        if (!m_pIndex || !(rEvent.Accessor >>= aName))
+            return;
+        if (m_aLibName.isEmpty())
+            m_pIndex->LibraryRemoved(m_aDocument, aName);
+        else
+            m_pIndex->ModuleRemoved(m_aDocument, m_aLibName, aName);
+    }
+};
+
+SymbolIndex::SymbolIndex() :
+    m_aNotifier(*this),
+    m_aHighlighter(HighlighterLanguage::Basic)
+{
+    // the documents that are open already; the others are reported by the notifier
+    ScriptDocuments const aDocuments(ScriptDocument::getAllScriptDocuments(ScriptDocument::AllWithApplication));
+    for (ScriptDocument const& rDocument : aDocuments)
+        AddDocument(rDocument);
+}
+
+SymbolIndex::~SymbolIndex()
+{
+    m_aNotifier.dispose();
+    while (!m_aDocuments.empty())
+        RemoveDocument(ScriptDocument(m_aDocuments.back().aDocument));
+}
+
+std::vector<SymbolLocation> SymbolIndex::FindDefinitions( const OUString& rName )
+{
+    return Find(rName, true);
+}
+
+std::vector<SymbolLocation> SymbolIndex::FindReferences( const OUString& rName )
+{
+    return Find(rName, false);
+}
+
+std::vector<SymbolLocation> SymbolIndex::Find( const OUString& rName, bool bDefinitions )
+{
+    std::vector<SymbolLocation> aLocations;
+    std::unordered_map<OUString, Postings, OUStringHash>::const_iterator const itName = m_aNames.find(MakeKey(rName));
+    if (itName == m_aNames.end())
+        return aLocations;
+
+    for (auto const& rPosting : itName->second)
+    {
+        Module const& rModule = m_aModules[rPosting.first];
+        std::vector<Position> const& rPositions = bDefinitions ? rPosting.second.aDefinitions : rPosting.second.aReferences;
+        for (Position const& rPos : rPositions)
+            aLocations.emplace_back(rModule.aDocument, rModule.aLibName, rModule.aModName,
+                                    rPos.nLine, rPos.nStart, rPos.nEnd);
+    }
+
+    // the postings are not ordered by module
+    std::stable_sort(aLocations.begin(), aLocations.end(), LocationLess);
+    return aLocations;
+}
+
+void SymbolIndex::onDocumentCreated( const ScriptDocument& rDocument )
+{
+    AddDocument(rDocument);
+}
+
+void SymbolIndex::onDocumentOpened( const ScriptDocument& rDocument )
+{
+    AddDocument(rDocument);
+}
+
+void SymbolIndex::onDocumentSave( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::onDocumentSaveDone( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::onDocumentSaveAs( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::onDocumentSaveAsDone( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::onDocumentClosed( const ScriptDocument& rDocument )
+{
+    RemoveDocument(rDocument);
+}
+
+void SymbolIndex::onDocumentTitleChanged( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::onDocumentModeChanged( const ScriptDocument& /*rDocument*/ )
+{
+}
+
+void SymbolIndex::LibraryInserted( const ScriptDocument& rDocument, const OUString& rLibName )
+{
+    Document* pDoc = FindDocument(rDocument);
+    if (!pDoc)
+        return;
+    Listen(*pDoc, rLibName);
+    try
+    {
+        // a new library is loaded, an inserted one may still have to be
+        Reference< script::XLibraryContainer > xModLibContainer(rDocument.getLibraryContainer(E_SCRIPTS));
+        if (xModLibContainer.is() && xModLibContainer->isLibraryLoaded(rLibName))
+            IndexLibrary(*pDoc, rLibName);
+    }
+    catch (const Exception&)
+    {
+        DBG_UNHANDLED_EXCEPTION();
+    }
+}
+
+void SymbolIndex::LibraryRemoved( const ScriptDocument& rDocument, const OUString& rLibName )
+{
+    Document* pDoc = FindDocument(rDocument);
+    if (!pDoc)
+        return;
+    StopListening(*pDoc, rLibName);
+    ModuleMap::iterator it = pDoc->aModules.lower_bound(std::make_pair(rLibName, OUString()));
+    while (it != pDoc->aModules.end() && it->first.first == rLibName)
+        it = RemoveModule(*pDoc, it);
+    pDoc->aLibraries.erase(rLibName);
+}
+
+void SymbolIndex::ModuleChanged( const ScriptDocument& rDocument, const OUString& rLibName,
+                                 const OUString& rModName, const OUString& rSource )
+{
+    Document* pDoc = FindDocument(rDocument);
+    if (!pDoc)
+        return;
+    // this is how a library that is being loaded gets its modules
+    pDoc->aLibraries.insert(rLibName);
+    IndexModule(NewModule(*pDoc, rLibName, rModName), rSource);
+}
+
+void SymbolIndex::ModuleRemoved( const ScriptDocument& rDocument, const OUString& rLibName, const OUString& rModName )
+{
+    Document* pDoc = FindDocument(rDocument);
+    if (!pDoc)
+        return;
+    ModuleMap::iterator const it = pDoc->aModules.find(std::make_pair(rLibName, rModName));
+    if (it != pDoc->aModules.end())
+        RemoveModule(*pDoc, it);
+}
+
+void SymbolIndex::AddDocument( const ScriptDocument& rDocument )
+{
+    if (!rDocument.isValid() || FindDocument(rDocument))
+        return;
+
+    try
+    {
+        Reference< script::XLibraryContainer > xModLibContainer(rDocument.getLibraryContainer(E_SCRIPTS));
+        if (!xModLibContainer.is())
+            return;
+
+        m_aDocuments.emplace_back(rDocument);
+        Document& rDoc = m_aDocuments.back();
+        Listen(rDoc, OUString());
+
+        Sequence< OUString > const aLibNames(rDocument.getLibraryNames());
+        for (OUString const& rLibName : aLibNames)
+        {
+            if (!xModLibContainer->hasByName(rLibName))
+                continue;
+            // libraries that are not loaded, e.g. protected ones, are indexed as they load
+            Listen(rDoc, rLibName);
+            if (xModLibContainer->isLibraryLoaded(rLibName))
+                IndexLibrary(rDoc, rLibName);
+        }
+    }
+    catch (const Exception&)
+    {
+        DBG_UNHANDLED_EXCEPTION();
+    }
+}
+
+void SymbolIndex::RemoveDocument( const ScriptDocument& rDocument )
+{
+    for (std::vector<Document>::iterator itDoc = m_aDocuments.begin(); itDoc != m_aDocuments.end(); ++itDoc)
+    {
+        if (itDoc->aDocument == rDocument)
+        {
+            for (auto const& rListener : itDoc->aListeners)
+                rListener.second->Stop();
+            ModuleMap::iterator it = itDoc->aModules.begin();
+            while (it != itDoc->aModules.end())
+                it = RemoveModule(*itDoc, it);
+            m_aDocuments.erase(itDoc);
+            return;
+        }
+    }
+}
+
+void SymbolIndex::Listen( Document& rDoc, const OUString& rLibName )
+{
+    if (rDoc.aListeners.count(rLibName))
+        return;
+    try
+    {
+        Reference< container::XContainer > xContainer;
+        if (rLibName.isEmpty())
+            xContainer.set(rDoc.aDocument.getLibraryContainer(E_SCRIPTS), UNO_QUERY);
+        else
+            xContainer.set(rDoc.aDocument.getLibrary(E_SCRIPTS, rLibName, false), UNO_QUERY);
+        if (!xContainer.is())
+            return;
+
+        rtl::Reference<LibraryListener> const xListener(new LibraryListener(*this, rDoc.aDocument, rLibName, xContainer));
+        xListener->Start();
+        rDoc.aListeners[rLibName] = xListener;
+    }
+    catch (const Exception&)
+    {
+        DBG_UNHANDLED_EXCEPTION();
+    }
+}
+
+void SymbolIndex::StopListening( Document& rDoc, const OUString& rLibName )
+{
+    std::map<OUString, rtl::Reference<LibraryListener>>::iterator const it = rDoc.aListeners.find(rLibName);
+    if (it == rDoc.aListeners.end())
+        return;
+    it->second->Stop();
+    rDoc.aListeners.erase(it);
+}
+
+void SymbolIndex::IndexLibrary( Document& rDoc, const OUString& rLibName )
+{
+    rDoc.aLibraries.insert(rLibName);
+
+    Sequence< OUString > const aModNames(rDoc.aDocument.getObjectNames(E_SCRIPTS, rLibName));
+    for (OUString const& rModName : aModNames)
+    {
+        OUString aSource;
+        if (rDoc.aDocument.getModule(rLibName, rModName, aSource))
+            IndexModule(NewModule(rDoc, rLibName, rModName), aSource);
+    }
+    SAL_INFO("basctl.basicide", "symbol index: library " << rLibName << ", " << aModNames.getLength()
+             << " modules, " << GetModuleCount() << " in all");
+}
+
+void SymbolIndex::IndexModule( sal_uInt32 nModule, const OUString& rSource )
+{
+    Module& rModule = m_aModules[nModule];
+
+    // the procedures, by the line of their declaration
+    std::unordered_map<sal_uInt32, OUString> aDeclarations;
+    BasicManager* pBasMgr = rModule.aDocument.getBasicManager();
+    StarBASIC* pSb = pBasMgr ? pBasMgr->GetLib(rModule.aLibName) : nullptr;
+    SbModule* pMod = pSb ? pSb->FindModule(rModule.aModName) : nullptr;
+    SbModuleRef xModule;
+    // only parse the source if the module of Basic is out of sync with it
+    if (!pMod || pMod->GetSource() != rSource)
+    {
+        xModule = new SbModule(rModule.aModName);
+        xModule->SetSource32(rSource);
+        pMod = xModule.get();
+    }
+    sal_uInt16 const nCount = pMod->GetMethods()->Count();
+    for (sal_uInt16 i = 0; i < nCount; ++i)
+    {
+        SbMethod* pMethod = dynamic_cast<SbMethod*>(pMod->GetMethods()->Get(i));
+        if (!pMethod || pMethod->IsHidden())
+            continue;
+        sal_uInt16 nStart, nEnd;
+        pMethod->GetLineRange(nStart, nEnd);
+        if (nStart)
+            aDeclarations[nStart - 1] = MakeKey(pMethod->GetName());
+    }
+
+    std::vector<HighlightPortion> aPortions;
+    sal_Int32 const nLen = rSource.getLength();
+    sal_Int32 nPos = 0;
+    for (sal_uInt32 nLine = 0; nPos <= nLen; ++nLine)
+    {
+        sal_Int32 nEOL = rSource.indexOf('\n', nPos);
+        if (nEOL < 0)
+            nEOL = nLen;
+        sal_Int32 nLineEnd = nEOL;
+        if (nLineEnd > nPos && rSource[nLineEnd - 1] == '\r')
+            --nLineEnd;
+        OUString const aLine(rSource.copy(nPos, nLineEnd - nPos));
+        nPos = nEOL + 1;
+
+        std::unordered_map<sal_uInt32, OUString>::iterator itDecl = aDeclarations.find(nLine);
+        aPortions.clear();
+        m_aHighlighter.getHighlightPortions(aLine, aPortions);
+        for (HighlightPortion const& rPortion : aPortions)
+        {
+            if (rPortion.tokenType != TokenType::Identifier)
+                continue;
+
+            OUString const aKey(MakeKey(aLine.copy(rPortion.nBegin, rPortion.nEnd - rPortion.nBegin)));
+            std::pair<Postings::iterator, bool> const aPosting = m_aNames[aKey].emplace(nModule, Occurrences());
+            if (aPosting.second)
+                rModule.aNames.push_back(aKey);
+
+            Position const aPos = { nLine, rPortion.nBegin, rPortion.nEnd };
+            // the first occurrence of its name on the line of a declaration is the declaration
+            if (itDecl != aDeclarations.end() && itDecl->second == aKey)
+            {
+                aPosting.first->second.aDefinitions.push_back(aPos);
+                aDeclarations.erase(itDecl);
+                itDecl = aDeclarations.end();
+            }
+            else
+                aPosting.first->second.aReferences.push_back(aPos);
+        }
+    }
+}
+
+void SymbolIndex::ClearModule( sal_uInt32 nModule )
+{
+    Module& rModule = m_aModules[nModule];
+    for (OUString const& rKey : rModule.aNames)
+    {
+        std::unordered_map<OUString, Postings, OUStringHash>::iterator const it = m_aNames.find(rKey);
+        if (it == m_aNames.end())
+            continue;
+        it->second.erase(nModule);
+        if (it->second.empty())
+            m_aNames.erase(it);
+    }
+    rModule.aNames.clear();
+}
+
+SymbolIndex::ModuleMap::iterator SymbolIndex::RemoveModule( Document& rDoc, ModuleMap::iterator it )
+{
+    sal_uInt32 const nModule = it->second;
+    ClearModule(nModule);
+    m_aModules[nModule] = Module();
+    m_aFreeModules.push_back(nModule);
+    return rDoc.aModules.erase(it);
+}
+
+sal_uInt32 SymbolIndex::NewModule( Document& rDoc, const OUString& rLibName, const OUString& rModName )
+{
+    std::pair<OUString, OUString> const aKey(rLibName, rModName);
+    ModuleMap::const_iterator const it = rDoc.aModules.find(aKey);
+    if (it != rDoc.aModules.end())
+    {
+        ClearModule(it->second);
+        return it->second;
+    }
+
+    sal_uInt32 nModule;
+    if (!m_aFreeModules.empty())
+    {
+        nModule = m_aFreeModules.back();
+        m_aFreeModules.pop_back();
+    }
+    else
+    {
+        nModule = m_aModules.size();
+        m_aModules.emplace_back();
+    }
+    Module& rModule = m_aModules[nModule];
+    rModule.aDocument = rDoc.aDocument;
+    rModule.aLibName = rLibName;
+    rModule.aModName = rModName;
+    rDoc.aModules[aKey] = nModule;
+    return nModule;
+}
+
+SymbolIndex::Document* SymbolIndex::FindDocument( const ScriptDocument& rDocument )
+{
+    for (Document& rDoc : m_aDocuments)
+        if (rDoc.aDocument == rDocument)
+            return &rDoc;
+    return nullptr;
+}
+
+} // namespace basctl
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
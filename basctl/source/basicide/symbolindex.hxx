@@ -0,0 +1,174 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_BASCTL_SOURCE_BASICIDE_SYMBOLINDEX_HXX
+#define INCLUDED_BASCTL_SOURCE_BASICIDE_SYMBOLINDEX_HXX
+
+#include "doceventnotifier.hxx"
+#include "scriptdocument.hxx"
+
+#include <comphelper/syntaxhighlight.hxx>
+#include <rtl/ref.hxx>
+#include <rtl/ustring.hxx>
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace basctl
+{
+
+/// a procedure declaration or an occurrence of an identifier in a Basic module
+struct SymbolLocation
+{
+    ScriptDocument  aDocument;
+    OUString        aLibName;
+    OUString        aModName;
+    sal_uInt32      nLine;      // 0-based, like the paragraphs of the editor
+    sal_Int32       nStart;
+    sal_Int32       nEnd;
+
+    SymbolLocation( const ScriptDocument& rDocument, const OUString& rLibName, const OUString& rModName,
+                    sal_uInt32 nLine_, sal_Int32 nStart_, sal_Int32 nEnd_ ) :
+        aDocument(rDocument), aLibName(rLibName), aModName(rModName),
+        nLine(nLine_), nStart(nStart_), nEnd(nEnd_)
+    { }
+};
+
+/** An index of the procedures and identifiers in the Basic modules of all documents.
+
+    The index maps the name of an identifier, which Basic compares ignoring the case,
+    to the modules it occurs in and to its positions there, so looking a name up costs
+    what its results cost, however many modules there are.  The declarations are taken
+    from the method ranges of the modules and the identifiers from the tokenizer of the
+    highlighter.
+
+    The index is kept up to date by events, so a lookup does not look at the documents
+    and libraries at all: the documents come and go with the global document events, and
+    the index listens at the Basic library container of each document and at each of its
+    libraries.  A module is indexed again when its library reports it inserted or
+    replaced, whether the IDE, a macro or the API changed it, and the index only touches
+    the names that module contributes.  A library that is not loaded yet is indexed as
+    its modules are inserted while it loads.  Changes in a module window only reach the
+    library, and so the index, when the window stores them.
+
+    The index lives in the ExtraData of the IDE, for the whole session, and is created by
+    the first lookup; it is only used with the SolarMutex locked.
+*/
+class SymbolIndex : public DocumentEventListener
+{
+public:
+    SymbolIndex();
+    virtual ~SymbolIndex() override;
+
+    SymbolIndex(const SymbolIndex&) = delete;
+    SymbolIndex& operator=(const SymbolIndex&) = delete;
+
+    /// the procedures named rName in all libraries, with the position of their name
+    std::vector<SymbolLocation> FindDefinitions( const OUString& rName );
+    /// the occurrences of the identifier rName in all libraries, outside of declarations
+    std::vector<SymbolLocation> FindReferences( const OUString& rName );
+
+    size_t GetModuleCount() const { return m_aModules.size() - m_aFreeModules.size(); }
+
+private:
+    /// listens at a library container, or at a library, of a document
+    class LibraryListener;
+
+    // DocumentEventListener
+    virtual void onDocumentCreated( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentOpened( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentSave( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentSaveDone( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentSaveAs( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentSaveAsDone( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentClosed( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentTitleChanged( const ScriptDocument& rDocument ) override;
+    virtual void onDocumentModeChanged( const ScriptDocument& rDocument ) override;
+
+    // maintenance, called by the listeners
+    void LibraryInserted( const ScriptDocument& rDocument, const OUString& rLibName );
+    void LibraryRemoved( const ScriptDocument& rDocument, const OUString& rLibName );
+    void ModuleChanged( const ScriptDocument& rDocument, const OUString& rLibName,
+                        const OUString& rModName, const OUString& rSource );
+    void ModuleRemoved( const ScriptDocument& rDocument, const OUString& rLibName, const OUString& rModName );
+
+    struct Position
+    {
+        sal_uInt32  nLine;
+        sal_Int32   nStart;
+        sal_Int32   nEnd;
+    };
+
+    struct Occurrences
+    {
+        std::vector<Position>   aDefinitions;
+        std::vector<Position>   aReferences;
+    };
+
+    /// the occurrences of a name by module
+    typedef std::unordered_map<sal_uInt32, Occurrences> Postings;
+    /// the modules of a document by library and module name
+    typedef std::map<std::pair<OUString, OUString>, sal_uInt32> ModuleMap;
+
+    struct Module
+    {
+        ScriptDocument          aDocument;
+        OUString                aLibName;
+        OUString                aModName;
+        /// the keys of m_aNames that have postings of this module
+        std::vector<OUString>   aNames;
+
+        Module() : aDocument(ScriptDocument::NoDocument) { }
+    };
+
+    /// the modules of a document and its libraries that are indexed
+    struct Document
+    {
+        ScriptDocument      aDocument;
+        ModuleMap           aModules;
+        std::set<OUString>  aLibraries;
+        /// by library name, the one at the library container under an empty name
+        std::map<OUString, rtl::Reference<LibraryListener>> aListeners;
+
+        explicit Document( const ScriptDocument& rDocument ) : aDocument(rDocument) { }
+    };
+
+    static OUString MakeKey( const OUString& rName ) { return rName.toAsciiLowerCase(); }
+
+    /// starts listening at the libraries of the document and indexes the loaded ones
+    void AddDocument( const ScriptDocument& rDocument );
+    void RemoveDocument( const ScriptDocument& rDocument );
+    void Listen( Document& rDoc, const OUString& rLibName );
+    void StopListening( Document& rDoc, const OUString& rLibName );
+    void IndexLibrary( Document& rDoc, const OUString& rLibName );
+    void IndexModule( sal_uInt32 nModule, const OUString& rSource );
+    void ClearModule( sal_uInt32 nModule );
+    ModuleMap::iterator RemoveModule( Document& rDoc, ModuleMap::iterator it );
+    sal_uInt32 NewModule( Document& rDoc, const OUString& rLibName, const OUString& rModName );
+
+    Document* FindDocument( const ScriptDocument& rDocument );
+
+    std::vector<SymbolLocation> Find( const OUString& rName, bool bDefinitions );
+
+    DocumentEventNotifier                   m_aNotifier;
+    SyntaxHighlighter                       m_aHighlighter;
+    std::vector<Document>                   m_aDocuments;
+    std::vector<Module>                     m_aModules;
+    std::vector<sal_uInt32>                 m_aFreeModules;
+    std::unordered_map<OUString, Postings, OUStringHash> m_aNames;
+};
+
+} // namespace basctl
+
+#endif // INCLUDED_BASCTL_SOURCE_BASICIDE_SYMBOLINDEX_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
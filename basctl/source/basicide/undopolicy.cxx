@@ -0,0 +1,240 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "undopolicy.hxx"
+
+#include <vcl/textdata.hxx>
+#include <vcl/texteng.hxx>
+
+namespace basctl
+{
+
+namespace
+{
+
+// the size of a text undo action and its bookkeeping, without the text it keeps
+const size_t nActionOverhead = 128;
+
+}
+
+UndoPolicy::UndoPolicy( SfxUndoManager& rManager, TextEngine& rEngine,
+                        size_t nMaxActionCount, size_t nMemoryBudget ) :
+    m_pManager(&rManager),
+    m_rEngine(rEngine),
+    m_nMemoryBudget(nMemoryBudget),
+    m_nUndoCost(0),
+    m_nRedoCost(0),
+    m_nLastTextLen(rEngine.GetTextLen()),
+    m_nListDepth(0),
+    m_nListCost(0)
+{
+    // actions that are already there are not accounted for
+    m_pManager->SetMaxUndoActionCount(nMaxActionCount);
+    m_pManager->AddUndoListener(*this);
+    StartListening(m_rEngine);
+}
+
+UndoPolicy::~UndoPolicy()
+{
+    EndListening(m_rEngine);
+    if (m_pManager)
+        m_pManager->RemoveUndoListener(*this);
+}
+
+void UndoPolicy::SetMemoryBudget( size_t nMemoryBudget )
+{
+    m_nMemoryBudget = nMemoryBudget;
+    Enforce();
+}
+
+void UndoPolicy::ChargeChange()
+{
+    sal_Int64 const nTextLen = m_rEngine.GetTextLen();
+    sal_Int64 const nDelta = nTextLen > m_nLastTextLen ? nTextLen - m_nLastTextLen : m_nLastTextLen - nTextLen;
+    m_nLastTextLen = nTextLen;
+    size_t const nCost = static_cast<size_t>(nDelta) * sizeof(sal_Unicode);
+    if (!nCost)
+        return;
+
+    // the newest action made the change, or had typing merged into it
+    if (m_nListDepth)
+        m_nListCost += nCost;
+    else if (!m_aUndoCosts.empty())
+    {
+        m_aUndoCosts.back() += nCost;
+        m_nUndoCost += nCost;
+    }
+}
+
+void UndoPolicy::PushUndo( size_t nCost )
+{
+    // a new action discards what could be redone
+    m_aRedoCosts.clear();
+    m_nRedoCost = 0;
+
+    m_aUndoCosts.push_back(nCost);
+    m_nUndoCost += nCost;
+    SyncWithManager();
+    Enforce();
+}
+
+void UndoPolicy::SyncWithManager()
+{
+    if (!m_pManager)
+        return;
+
+    size_t const nUndoCount = m_pManager->GetUndoActionCount(false);
+    while (m_aUndoCosts.size() > nUndoCount)
+    {
+        m_nUndoCost -= m_aUndoCosts.front();
+        m_aUndoCosts.pop_front();
+    }
+
+    size_t const nRedoCount = m_pManager->GetRedoActionCount(false);
+    while (m_aRedoCosts.size() > nRedoCount)
+    {
+        m_nRedoCost -= m_aRedoCosts.front();
+        m_aRedoCosts.pop_front();
+    }
+}
+
+void UndoPolicy::Enforce()
+{
+    // the oldest actions go first; the newest one is kept whatever its size
+    while (m_pManager && !m_nListDepth && GetMemoryUsage() > m_nMemoryBudget
+           && m_aUndoCosts.size() > 1 && m_pManager->GetUndoActionCount(false) > 1)
+    {
+        m_pManager->RemoveOldestUndoAction();
+        m_nUndoCost -= m_aUndoCosts.front();
+        m_aUndoCosts.pop_front();
+    }
+}
+
+void UndoPolicy::actionUndone( const OUString& )
+{
+    m_nLastTextLen = m_rEngine.GetTextLen();
+    if (!m_aUndoCosts.empty())
+    {
+        size_t const nCost = m_aUndoCosts.back();
+        m_aUndoCosts.pop_back();
+        m_nUndoCost -= nCost;
+        m_aRedoCosts.push_back(nCost);
+        m_nRedoCost += nCost;
+    }
+    SyncWithManager();
+}
+
+void UndoPolicy::actionRedone( const OUString& )
+{
+    m_nLastTextLen = m_rEngine.GetTextLen();
+    if (!m_aRedoCosts.empty())
+    {
+        size_t const nCost = m_aRedoCosts.back();
+        m_aRedoCosts.pop_back();
+        m_nRedoCost -= nCost;
+        m_aUndoCosts.push_back(nCost);
+        m_nUndoCost += nCost;
+    }
+    SyncWithManager();
+}
+
+void UndoPolicy::undoActionAdded( const OUString& )
+{
+    // what changed so far belongs to the previous action, this one has not changed the
+    // text yet
+    ChargeChange();
+    if (m_nListDepth)
+        m_nListCost += nActionOverhead;
+    else
+        PushUndo(nActionOverhead);
+}
+
+void UndoPolicy::cleared()
+{
+    m_aUndoCosts.clear();
+    m_aRedoCosts.clear();
+    m_nUndoCost = 0;
+    m_nRedoCost = 0;
+    m_nListCost = 0;
+    m_nLastTextLen = m_rEngine.GetTextLen();
+}
+
+void UndoPolicy::clearedRedo()
+{
+    m_aRedoCosts.clear();
+    m_nRedoCost = 0;
+}
+
+void UndoPolicy::resetAll()
+{
+    cleared();
+    m_nListDepth = 0;
+}
+
+void UndoPolicy::listActionEntered( const OUString& )
+{
+    ChargeChange();
+    if (m_nListDepth++)
+        return;
+    m_nListCost = 0;
+}
+
+void UndoPolicy::listActionLeft( const OUString& )
+{
+    if (!m_nListDepth)
+        return;
+    // the change of the last action in the list
+    ChargeChange();
+    if (!--m_nListDepth)
+        PushUndo(m_nListCost);
+}
+
+void UndoPolicy::listActionLeftAndMerged()
+{
+    if (!m_nListDepth)
+        return;
+    ChargeChange();
+    if (!--m_nListDepth)
+    {
+        // the list became part of the previous action
+        if (m_aUndoCosts.empty())
+            m_aUndoCosts.push_back(0);
+        m_aUndoCosts.back() += m_nListCost;
+        m_nUndoCost += m_nListCost;
+        SyncWithManager();
+        Enforce();
+    }
+}
+
+void UndoPolicy::listActionCancelled()
+{
+    if (m_nListDepth && !--m_nListDepth)
+        m_nListCost = 0;
+}
+
+void UndoPolicy::undoManagerDying()
+{
+    m_pManager = nullptr;
+}
+
+void UndoPolicy::Notify( SfxBroadcaster&, const SfxHint& rHint )
+{
+    // the text is formatted after each change, so a single action outside of a list is
+    // charged and the budget enforced without waiting for the next action
+    TextHint const* pTextHint = dynamic_cast<TextHint const*>(&rHint);
+    if (pTextHint && pTextHint->GetId() == SfxHintId::TextFormatted && !m_nListDepth)
+    {
+        ChargeChange();
+        Enforce();
+    }
+}
+
+} // namespace basctl
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
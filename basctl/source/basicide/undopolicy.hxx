@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_BASCTL_SOURCE_BASICIDE_UNDOPOLICY_HXX
+#define INCLUDED_BASCTL_SOURCE_BASICIDE_UNDOPOLICY_HXX
+
+#include <svl/lstner.hxx>
+#include <svl/undo.hxx>
+
+#include <deque>
+
+class TextEngine;
+
+namespace basctl
+{
+
+/** Keeps the undo history of a Basic module editor within a number of actions and
+    an estimated amount of memory.
+
+    The text engine merges consecutive typing into one action by itself; the policy
+    only has to drop the oldest actions when a limit is exceeded.  The size of an
+    action is estimated from the text it keeps: each elementary action of the engine
+    keeps the characters it inserts or removes, which is the change of the text length
+    it causes.  As the engine adds an action before it changes the text, that change is
+    measured later, when the next action is added or the text is formatted, and charged
+    to the newest action, together with typing merged into it.  So a paste over a
+    selection or a replace-all counts for both the removed and the inserted text, while
+    a typed word costs little more than the action itself.  The newest action is never
+    dropped, so even a change larger than the budget can be undone.
+*/
+class UndoPolicy : private SfxUndoListener, private SfxListener
+{
+public:
+    UndoPolicy( SfxUndoManager& rManager, TextEngine& rEngine,
+                size_t nMaxActionCount, size_t nMemoryBudget );
+    virtual ~UndoPolicy() override;
+
+    UndoPolicy(const UndoPolicy&) = delete;
+    UndoPolicy& operator=(const UndoPolicy&) = delete;
+
+    /// the estimated size of the undo and redo actions, in bytes
+    size_t GetMemoryUsage() const { return m_nUndoCost + m_nRedoCost; }
+    size_t GetMemoryBudget() const { return m_nMemoryBudget; }
+    /// drops the oldest actions at once if they exceed the new budget
+    void   SetMemoryBudget( size_t nMemoryBudget );
+
+private:
+    // SfxUndoListener
+    virtual void actionUndone( const OUString& rActionComment ) override;
+    virtual void actionRedone( const OUString& rActionComment ) override;
+    virtual void undoActionAdded( const OUString& rActionComment ) override;
+    virtual void cleared() override;
+    virtual void clearedRedo() override;
+    virtual void resetAll() override;
+    virtual void listActionEntered( const OUString& rComment ) override;
+    virtual void listActionLeft( const OUString& rComment ) override;
+    virtual void listActionLeftAndMerged() override;
+    virtual void listActionCancelled() override;
+    virtual void undoManagerDying() override;
+
+    // SfxListener
+    virtual void Notify( SfxBroadcaster& rBC, const SfxHint& rHint ) override;
+
+    /// charges the text change since the last call to the newest action
+    void   ChargeChange();
+    void   PushUndo( size_t nCost );
+    /// drops the costs of actions that the manager has dropped, e.g. for its action count
+    void   SyncWithManager();
+    void   Enforce();
+
+    SfxUndoManager*     m_pManager;
+    TextEngine&         m_rEngine;
+    size_t              m_nMemoryBudget;
+
+    /// the estimated sizes of the actions on the undo stack, the oldest first
+    std::deque<size_t>  m_aUndoCosts;
+    /// the same for the redo stack, the next action to redo last
+    std::deque<size_t>  m_aRedoCosts;
+    size_t              m_nUndoCost;
+    size_t              m_nRedoCost;
+
+    /// the text length when the change was last charged
+    sal_Int64           m_nLastTextLen;
+    /// depth of open list actions and the cost of the actions in the outermost one
+    sal_uInt16          m_nListDepth;
+    size_t              m_nListCost;
+};
+
+} // namespace basctl
+
+#endif // INCLUDED_BASCTL_SOURCE_BASICIDE_UNDOPOLICY_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
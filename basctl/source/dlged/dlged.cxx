@@ -516,10 +516,11 @@ void DlgEditor::Paint(vcl::RenderContext& rRenderContext, const tools::Rectangle
 
                 // set dialog position and size
                 pDlgEdForm->SetSnapRect( tools::Rectangle( aPos, aSize ) );
-                pDlgEdForm->EndListening(false);
-                pDlgEdForm->SetPropsFromRect();
+                {
+                    DlgEdObj::SuppressNotifications aSuppress( *pDlgEdForm );
+                    pDlgEdForm->SetPropsFromRect();
+                }
                 pDlgEdForm->GetDlgEditor().SetDialogModelChanged();
-                pDlgEdForm->StartListening();
 
                 // set position and size of controls
                 if (const size_t nObjCount = pDlgEdPage->GetObjCount())
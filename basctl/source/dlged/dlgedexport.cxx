@@ -0,0 +1,258 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "dlgedexport.hxx"
+
+#include <com/sun/star/xml/sax/Writer.hpp>
+#include <com/sun/star/xml/sax/XExtendedDocumentHandler.hpp>
+#include <comphelper/attributelist.hxx>
+#include <comphelper/threadpool.hxx>
+#include <cppuhelper/implbase.hxx>
+#include <rtl/ref.hxx>
+#include <tools/diagnose_ex.h>
+#include <xmlscript/xml_helper.hxx>
+#include <xmlscript/xmldlg_imexp.hxx>
+
+#include <algorithm>
+
+namespace basctl
+{
+
+using namespace ::com::sun::star;
+using namespace ::com::sun::star::uno;
+
+namespace
+{
+
+// like the one of xmlscript::exportDialogModel
+class InputStreamProvider : public ::cppu::WeakImplHelper< io::XInputStreamProvider >
+{
+    std::vector<sal_Int8> const m_aBytes;
+
+public:
+    explicit InputStreamProvider( std::vector<sal_Int8> const& rBytes ) :
+        m_aBytes(rBytes)
+    { }
+
+    // XInputStreamProvider
+    virtual Reference< io::XInputStream > SAL_CALL createInputStream() override
+    {
+        return ::xmlscript::createInputStream(m_aBytes.data(), m_aBytes.size());
+    }
+};
+
+class EncodeTask : public comphelper::ThreadTask
+{
+    DialogSnapshot const&                   m_rSnapshot;
+    Reference< io::XInputStreamProvider >&  m_rxISP;
+
+public:
+    EncodeTask( std::shared_ptr< comphelper::ThreadTaskTag > const& rTag,
+                DialogSnapshot const& rSnapshot, Reference< io::XInputStreamProvider >& rxISP ) :
+        comphelper::ThreadTask(rTag),
+        m_rSnapshot(rSnapshot),
+        m_rxISP(rxISP)
+    { }
+
+    virtual void doWork() override
+    {
+        try
+        {
+            m_rxISP = m_rSnapshot.Encode();
+        }
+        catch (const Exception&)
+        {
+            // the dialog is exported on the main thread then
+            DBG_UNHANDLED_EXCEPTION();
+        }
+    }
+};
+
+} // namespace
+
+class DialogSnapshot::Recorder : public ::cppu::WeakImplHelper< xml::sax::XExtendedDocumentHandler >
+{
+    std::vector<Event>& m_rEvents;
+
+    void Add( EventType eType, OUString const& rName = OUString(), OUString const& rData = OUString() )
+    {
+        m_rEvents.push_back(Event{ eType, rName, rData, std::vector<Attribute>() });
+    }
+
+public:
+    explicit Recorder( std::vector<Event>& rEvents ) :
+        m_rEvents(rEvents)
+    { }
+
+    // XDocumentHandler
+    virtual void SAL_CALL startDocument() override
+    {
+        Add(EventType::StartDocument);
+    }
+    virtual void SAL_CALL endDocument() override
+    {
+        Add(EventType::EndDocument);
+    }
+    virtual void SAL_CALL startElement( OUString const& rName, Reference< xml::sax::XAttributeList > const& xAttribs ) override
+    {
+        Add(EventType::StartElement, rName);
+        sal_Int16 const nCount = xAttribs.is() ? xAttribs->getLength() : 0;
+        std::vector<Attribute>& rAttributes = m_rEvents.back().aAttributes;
+        rAttributes.reserve(nCount);
+        for (sal_Int16 i = 0; i < nCount; ++i)
+            rAttributes.push_back(Attribute{ xAttribs->getNameByIndex(i), xAttribs->getTypeByIndex(i), xAttribs->getValueByIndex(i) });
+    }
+    virtual void SAL_CALL endElement( OUString const& rName ) override
+    {
+        Add(EventType::EndElement, rName);
+    }
+    virtual void SAL_CALL characters( OUString const& rChars ) override
+    {
+        Add(EventType::Characters, OUString(), rChars);
+    }
+    virtual void SAL_CALL ignorableWhitespace( OUString const& rWhitespaces ) override
+    {
+        Add(EventType::IgnorableWhitespace, OUString(), rWhitespaces);
+    }
+    virtual void SAL_CALL processingInstruction( OUString const& rTarget, OUString const& rData ) override
+    {
+        Add(EventType::ProcessingInstruction, rTarget, rData);
+    }
+    virtual void SAL_CALL setDocumentLocator( Reference< xml::sax::XLocator > const& ) override
+    {
+    }
+
+    // XExtendedDocumentHandler
+    virtual void SAL_CALL startCDATA() override
+    {
+        Add(EventType::StartCDATA);
+    }
+    virtual void SAL_CALL endCDATA() override
+    {
+        Add(EventType::EndCDATA);
+    }
+    virtual void SAL_CALL comment( OUString const& rComment ) override
+    {
+        Add(EventType::Comment, OUString(), rComment);
+    }
+    virtual void SAL_CALL allowLineBreak() override
+    {
+        Add(EventType::AllowLineBreak);
+    }
+    virtual void SAL_CALL unknown( OUString const& rString ) override
+    {
+        Add(EventType::Unknown, OUString(), rString);
+    }
+};
+
+DialogSnapshot::DialogSnapshot( Reference< container::XNameContainer > const& xDialogModel,
+                                Reference< XComponentContext > const& xContext,
+                                Reference< frame::XModel > const& xDocument ) :
+    m_xContext(xContext)
+{
+    Reference< xml::sax::XExtendedDocumentHandler > const xRecorder(new Recorder(m_aEvents));
+    ::xmlscript::exportDialogModel(xRecorder, xDialogModel, xDocument);
+}
+
+Reference< io::XInputStreamProvider > DialogSnapshot::Encode() const
+{
+    // as xmlscript::exportDialogModel writes the events
+    Reference< xml::sax::XWriter > const xWriter = xml::sax::Writer::create(m_xContext);
+    std::vector<sal_Int8> aBytes;
+    xWriter->setOutputStream(::xmlscript::createOutputStream(&aBytes));
+
+    for (Event const& rEvent : m_aEvents)
+    {
+        switch (rEvent.eType)
+        {
+            case EventType::StartDocument:
+                xWriter->startDocument();
+                break;
+            case EventType::EndDocument:
+                xWriter->endDocument();
+                break;
+            case EventType::StartElement:
+            {
+                rtl::Reference<comphelper::AttributeList> const xAttribs(new comphelper::AttributeList);
+                for (Attribute const& rAttribute : rEvent.aAttributes)
+                    xAttribs->AddAttribute(rAttribute.aName, rAttribute.aType, rAttribute.aValue);
+                xWriter->startElement(rEvent.aName, xAttribs.get());
+                break;
+            }
+            case EventType::EndElement:
+                xWriter->endElement(rEvent.aName);
+                break;
+            case EventType::Characters:
+                xWriter->characters(rEvent.aData);
+                break;
+            case EventType::IgnorableWhitespace:
+                xWriter->ignorableWhitespace(rEvent.aData);
+                break;
+            case EventType::ProcessingInstruction:
+                xWriter->processingInstruction(rEvent.aName, rEvent.aData);
+                break;
+            case EventType::StartCDATA:
+                xWriter->startCDATA();
+                break;
+            case EventType::EndCDATA:
+                xWriter->endCDATA();
+                break;
+            case EventType::Comment:
+                xWriter->comment(rEvent.aData);
+                break;
+            case EventType::AllowLineBreak:
+                xWriter->allowLineBreak();
+                break;
+            case EventType::Unknown:
+                xWriter->unknown(rEvent.aData);
+                break;
+        }
+    }
+    return new InputStreamProvider(aBytes);
+}
+
+std::vector< Reference< io::XInputStreamProvider > > DialogSnapshot::EncodeAll(
+    std::vector< std::unique_ptr<DialogSnapshot> > const& rSnapshots )
+{
+    std::vector< Reference< io::XInputStreamProvider > > aExports(rSnapshots.size());
+    size_t const nSnapshots = std::count_if(rSnapshots.begin(), rSnapshots.end(),
+        []( std::unique_ptr<DialogSnapshot> const& pSnapshot ) { return bool(pSnapshot); });
+    if (nSnapshots < 2)
+    {
+        for (size_t i = 0; i < rSnapshots.size(); ++i)
+        {
+            if (!rSnapshots[i])
+                continue;
+            try
+            {
+                aExports[i] = rSnapshots[i]->Encode();
+            }
+            catch (const Exception&)
+            {
+                DBG_UNHANDLED_EXCEPTION();
+            }
+        }
+        return aExports;
+    }
+
+    // the tasks only touch their snapshot and their result, so the SolarMutex stays locked
+    comphelper::ThreadPool& rPool = comphelper::ThreadPool::getSharedOptimalPool();
+    std::shared_ptr< comphelper::ThreadTaskTag > pTag = comphelper::ThreadPool::createThreadTaskTag();
+    for (size_t i = 0; i < rSnapshots.size(); ++i)
+    {
+        if (rSnapshots[i])
+            rPool.pushTask(new EncodeTask(pTag, *rSnapshots[i], aExports[i]));
+    }
+    rPool.waitUntilDone(pTag);
+    return aExports;
+}
+
+} // namespace basctl
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
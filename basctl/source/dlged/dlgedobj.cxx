@@ -68,6 +68,7 @@ DlgEditor& DlgEdObj::GetDialogEditor ()
 DlgEdObj::DlgEdObj()
           :SdrUnoObj(OUString())
           ,bIsListening(false)
+          ,m_nSuppressNotifications(0)
           ,pDlgEdForm( nullptr )
 {
 }
@@ -76,6 +77,7 @@ DlgEdObj::DlgEdObj(const OUString& rModelName,
                    const css::uno::Reference< css::lang::XMultiServiceFactory >& rxSFac)
           :SdrUnoObj(rModelName, rxSFac)
           ,bIsListening(false)
+          ,m_nSuppressNotifications(0)
           ,pDlgEdForm( nullptr )
 {
 }
@@ -86,6 +88,12 @@ DlgEdObj::~DlgEdObj()
         EndListening(true);
 }
 
+bool DlgEdObj::isNotifying() const
+{
+    return isListening() && !m_nSuppressNotifications
+        && !( pDlgEdForm && pDlgEdForm->m_nSuppressNotifications );
+}
+
 namespace
 {
     /* returns the DlgEdForm which the given DlgEdObj belongs to
@@ -430,9 +438,8 @@ void DlgEdObj::PositionAndSizeChange( const beans::PropertyChangeEvent& evt )
 
                 if ( nNewValue != nValue )
                 {
-                    EndListening( false );
+                    SuppressNotifications aSuppress( *this );
                     xPSet->setPropertyValue( evt.PropertyName, Any(nNewValue) );
-                    StartListening();
                 }
             }
         }
@@ -476,10 +483,9 @@ void SAL_CALL DlgEdObj::NameChange( const  css::beans::PropertyChangeEvent& evt
             else
             {
                 // set old name property
-                EndListening(false);
+                SuppressNotifications aSuppress( *this );
                 Reference< beans::XPropertySet >  xPSet(GetUnoControlModel(), UNO_QUERY);
                 xPSet->setPropertyValue( DLGED_PROP_NAME, Any(aOldName) );
-                StartListening();
             }
         }
     }
@@ -528,13 +534,8 @@ void DlgEdObj::TabIndexChange( const beans::PropertyChangeEvent& evt )
     DlgEdForm* pForm = GetDlgEdForm();
     if ( pForm )
     {
-        // stop listening with all children
-        std::vector<DlgEdObj*> aChildList = pForm->GetChildren();
-        std::vector<DlgEdObj*>::iterator aIter;
-        for ( aIter = aChildList.begin() ; aIter != aChildList.end() ; ++aIter )
-        {
-            (*aIter)->EndListening( false );
-        }
+        // ignore the notifications of all children
+        SuppressNotifications aSuppress( *pForm );
 
         Reference< container::XNameAccess > xNameAcc( pForm->GetUnoControlModel() , UNO_QUERY );
         if ( xNameAcc.is() )
@@ -611,12 +612,6 @@ void DlgEdObj::TabIndexChange( const beans::PropertyChangeEvent& evt )
 
             pForm->UpdateTabOrderAndGroups();
         }
-
-        // start listening with all children
-        for ( aIter = aChildList.begin() ; aIter != aChildList.end() ; ++aIter )
-        {
-            (*aIter)->StartListening();
-        }
     }
 }
 
@@ -911,14 +906,11 @@ void DlgEdObj::NbcMove( const Size& rSize )
 {
     SdrUnoObj::NbcMove( rSize );
 
-    // stop listening
-    EndListening(false);
-
     // set geometry properties
-    SetPropsFromRect();
-
-    // start listening
-    StartListening();
+    {
+        SuppressNotifications aSuppress( *this );
+        SetPropsFromRect();
+    }
 
     // dialog model changed
     GetDlgEdForm()->GetDlgEditor().SetDialogModelChanged();
@@ -928,14 +920,11 @@ void DlgEdObj::NbcResize(const Point& rRef, const Fraction& xFract, const Fracti
 {
     SdrUnoObj::NbcResize( rRef, xFract, yFract );
 
-    // stop listening
-    EndListening(false);
-
     // set geometry properties
-    SetPropsFromRect();
-
-    // start listening
-    StartListening();
+    {
+        SuppressNotifications aSuppress( *this );
+        SetPropsFromRect();
+    }
 
     // dialog model changed
     GetDlgEdForm()->GetDlgEditor().SetDialogModelChanged();
@@ -1102,7 +1091,7 @@ void DlgEdObj::EndListening(bool bRemoveListener)
 
 void SAL_CALL DlgEdObj::_propertyChange( const  css::beans::PropertyChangeEvent& evt )
 {
-    if (isListening())
+    if (isNotifying())
     {
         DlgEdForm* pRealDlgEdForm = dynamic_cast<DlgEdForm*>(this);
         if (!pRealDlgEdForm)
@@ -1158,7 +1147,7 @@ void SAL_CALL DlgEdObj::_propertyChange( const  css::beans::PropertyChangeEvent&
 
 void SAL_CALL DlgEdObj::_elementInserted()
 {
-    if (isListening())
+    if (isNotifying())
     {
         // dialog model changed
         GetDialogEditor().SetDialogModelChanged();
@@ -1167,7 +1156,7 @@ void SAL_CALL DlgEdObj::_elementInserted()
 
 void SAL_CALL DlgEdObj::_elementReplaced()
 {
-    if (isListening())
+    if (isNotifying())
     {
         // dialog model changed
         GetDialogEditor().SetDialogModelChanged();
@@ -1176,7 +1165,7 @@ void SAL_CALL DlgEdObj::_elementReplaced()
 
 void SAL_CALL DlgEdObj::_elementRemoved()
 {
-    if (isListening())
+    if (isNotifying())
     {
         // dialog model changed
         GetDialogEditor().SetDialogModelChanged();
@@ -1308,9 +1297,8 @@ void DlgEdForm::PositionAndSizeChange( const beans::PropertyChangeEvent& evt )
 
             if ( nNewValue != nValue )
             {
-                EndListening( false );
+                SuppressNotifications aSuppress( *this );
                 xPSetForm->setPropertyValue( evt.PropertyName, Any(nNewValue) );
-                StartListening();
             }
         }
     }
@@ -1348,9 +1336,8 @@ void DlgEdForm::PositionAndSizeChange( const beans::PropertyChangeEvent& evt )
                     }
                     if ( nNewX != nX )
                     {
-                        EndListening( false );
+                        SuppressNotifications aSuppress( *this );
                         xPSet->setPropertyValue( DLGED_PROP_POSITIONX, Any(nNewX) );
-                        StartListening();
                     }
 
                     sal_Int32 nNewY = nY;
@@ -1362,9 +1349,8 @@ void DlgEdForm::PositionAndSizeChange( const beans::PropertyChangeEvent& evt )
                     }
                     if ( nNewY != nY )
                     {
-                        EndListening( false );
+                        SuppressNotifications aSuppress( *this );
                         xPSet->setPropertyValue( DLGED_PROP_POSITIONY, Any(nNewY) );
-                        StartListening();
                     }
                 }
             }
@@ -1393,12 +1379,8 @@ void DlgEdForm::UpdateStep()
 
 void DlgEdForm::UpdateTabIndices()
 {
-    // stop listening with all children
-    std::vector<DlgEdObj*>::iterator aIter;
-    for ( aIter = pChildren.begin() ; aIter != pChildren.end() ; ++aIter )
-    {
-        (*aIter)->EndListening( false );
-    }
+    // ignore the notifications of all children
+    SuppressNotifications aSuppress( *this );
 
     Reference< css::container::XNameAccess > xNameAcc( GetUnoControlModel() , UNO_QUERY );
     if ( xNameAcc.is() )
@@ -1443,12 +1425,6 @@ void DlgEdForm::UpdateTabIndices()
 
         UpdateTabOrderAndGroups();
     }
-
-    // start listening with all children
-    for ( aIter = pChildren.begin() ; aIter != pChildren.end() ; ++aIter )
-    {
-        (*aIter)->StartListening();
-    }
 }
 
 void DlgEdForm::UpdateTabOrder()
@@ -1546,17 +1522,19 @@ void DlgEdForm::NbcMove( const Size& rSize )
     SdrUnoObj::NbcMove( rSize );
 
     // set geometry properties of form
-    EndListening(false);
-    SetPropsFromRect();
-    StartListening();
+    {
+        SuppressNotifications aSuppress( *this );
+        SetPropsFromRect();
+    }
 
-    // set geometry properties of all children
-    std::vector<DlgEdObj*>::iterator aIter;
-    for ( aIter = pChildren.begin() ; aIter != pChildren.end() ; ++aIter )
+    // the geometry properties of the children are relative to the form and stay as
+    // they are; the children just follow it, except for those that are moved along
+    // with it by the view
+    DlgEdView& rView = GetDlgEditor().GetView();
+    for ( DlgEdObj* pChild : pChildren )
     {
-        (*aIter)->EndListening(false);
-        (*aIter)->SetPropsFromRect();
-        (*aIter)->StartListening();
+        if ( !rView.IsObjMarked( pChild ) )
+            pChild->SetRectFromProps();
     }
 
     // dialog model changed
@@ -1567,19 +1545,11 @@ void DlgEdForm::NbcResize(const Point& rRef, const Fraction& xFract, const Fract
 {
     SdrUnoObj::NbcResize( rRef, xFract, yFract );
 
-    // set geometry properties of form
-    EndListening(false);
+    // set geometry properties of form and all children
+    SuppressNotifications aSuppress( *this );
     SetPropsFromRect();
-    StartListening();
-
-    // set geometry properties of all children
-    std::vector<DlgEdObj*>::iterator aIter;
-    for ( aIter = pChildren.begin() ; aIter != pChildren.end() ; ++aIter )
-    {
-        (*aIter)->EndListening(false);
-        (*aIter)->SetPropsFromRect();
-        (*aIter)->StartListening();
-    }
+    for ( DlgEdObj* pChild : pChildren )
+        pChild->SetPropsFromRect();
 
     // dialog model changed
     GetDlgEditor().SetDialogModelChanged();
@@ -1589,18 +1559,15 @@ bool DlgEdForm::EndCreate(SdrDragStat& rStat, SdrCreateCmd eCmd)
 {
     bool bResult = SdrUnoObj::EndCreate(rStat, eCmd);
 
-    // stop listening
-    EndListening(false);
-
     // set geometry properties
-    SetPropsFromRect();
+    {
+        SuppressNotifications aSuppress( *this );
+        SetPropsFromRect();
+    }
 
     // dialog model changed
     GetDlgEditor().SetDialogModelChanged();
 
-    // start listening
-    StartListening();
-
     return bResult;
 }
 
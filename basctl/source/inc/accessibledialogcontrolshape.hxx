@@ -56,6 +56,8 @@ private:
     DlgEdObj*               m_pDlgEdObj;
     bool                    m_bFocused;
     bool                    m_bSelected;
+    // maintained by the parent AccessibleDialogWindow, -1 if not in its child list
+    sal_Int32               m_nIndexInParent;
 
     css::awt::Rectangle                                            m_aBounds;
     css::uno::Reference< css::beans::XPropertySet >   m_xControlModel;
@@ -92,6 +92,7 @@ protected:
     void                    UpdateChild( const ChildDescriptor& rDesc );
     void                    UpdateChildren();
     void                    SortChildren();
+    void                    UpdateChildIndexes( size_t nFrom );
 
     DECL_LINK( WindowEventListener, VclWindowEvent&, void );
 
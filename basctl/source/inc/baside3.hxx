@@ -24,6 +24,7 @@
 #include "bastypes.hxx"
 #include "propbrw.hxx"
 
+#include <com/sun/star/io/XInputStreamProvider.hpp>
 #include <svl/undo.hxx>
 #include <vcl/dialog.hxx>
 #include <vcl/button.hxx>
@@ -31,6 +32,7 @@
 #include <vcl/fixed.hxx>
 
 #include <memory>
+#include <vector>
 
 class Printer;
 class StarBASIC;
@@ -77,6 +79,8 @@ protected:
     virtual void        DoScroll( ScrollBar* pCurScrollBar ) override;
     virtual void        DataChanged( const DataChangedEvent& rDCEvt ) override;
     void                InitSettings();
+    /// stores the export of the dialog in its library and clears the modified flag
+    void                StoreExport( css::uno::Reference< css::io::XInputStreamProvider > const& xISP );
 
 public:
     DialogWindow (DialogWindowLayout* pParent, ScriptDocument const& rDocument, const OUString& aLibName, const OUString& aName, css::uno::Reference<css::container::XNameContainer> const& xDialogModel);
@@ -100,6 +104,13 @@ public:
     virtual bool        IsReadOnly() override;
 
     virtual void        StoreData() override;
+    /** stores the modified dialogs among rWindows, writing their XML in parallel
+
+        The models are read into a DialogSnapshot each on the calling thread, the
+        snapshots are encoded on the thread pool, and the results are stored in the
+        order of rWindows, like StoreData would store them one by one.
+    */
+    static void         StoreDataInParallel( std::vector< VclPtr<DialogWindow> > const& rWindows );
     virtual bool        IsModified() override;
     virtual bool        IsPasteAllowed() override;
 
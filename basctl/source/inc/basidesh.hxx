@@ -27,6 +27,7 @@
 #include <sfx2/viewsh.hxx>
 #include <svx/ifaceids.hxx>
 #include <vcl/scrbar.hxx>
+#include <vcl/timer.hxx>
 #include <map>
 #include <memory>
 
@@ -47,6 +48,7 @@ class DialogWindowLayout;
 class TabBar;
 class BaseWindow;
 class LocalizationMgr;
+struct SymbolLocation;
 
 class Shell :
     public SfxViewShell,
@@ -83,6 +85,13 @@ private:
 
     bool                m_bAppBasicModified;
     DocumentEventNotifier m_aNotifier;
+    // releases the editors of module windows that are not used
+    AutoTimer           aEvictTimer;
+    // after how many milliseconds in the background, and above how many bytes of all editors
+    sal_uInt64          m_nEvictAfter;
+    size_t              m_nEditorMemoryBudget;
+    // the undo history of each module window is kept within this, in bytes
+    size_t              m_nUndoMemoryBudget;
     friend class ContainerListenerImpl;
     css::uno::Reference< css::container::XContainerListener > m_xLibListener;
 
@@ -100,6 +109,7 @@ private:
     void                SetCurLibForLocalization( const ScriptDocument& rDocument, const OUString& aLibName );
 
     DECL_LINK( TabBarHdl, ::TabBar*, void );
+    DECL_LINK( EvictTimerHdl, Timer*, void );
 
     static unsigned nShellCount;
 
@@ -155,6 +165,20 @@ public:
     TabBar&             GetTabBar()             { return *pTabBar; }
     WindowTable&        GetWindowTable()        { return aWindowTable; }
     sal_uInt16          GetWindowId (BaseWindow const* pWin) const;
+    /// an estimate of the memory held by the editors of all module windows, in bytes
+    size_t              GetEditorMemoryUsage() const;
+    /** releases the editors of the module windows, other than the current one, that have
+        not been shown for the evict time, and of the least recently shown ones while all
+        editors hold more than the memory budget; this is run by a timer every minute
+    */
+    void                EvictEditors();
+    sal_uInt64          GetEvictAfter() const { return m_nEvictAfter; }
+    void                SetEvictAfter( sal_uInt64 nMilliseconds ) { m_nEvictAfter = nMilliseconds; }
+    size_t              GetEditorMemoryBudget() const { return m_nEditorMemoryBudget; }
+    void                SetEditorMemoryBudget( size_t nBytes ) { m_nEditorMemoryBudget = nBytes; }
+    size_t              GetUndoMemoryBudget() const { return m_nUndoMemoryBudget; }
+    /// sets the memory budget of the undo history of each module window, also of the open ones
+    void                SetUndoMemoryBudget( size_t nMemoryBudget );
 
     SdrView*            GetCurDlgView() const;
 
@@ -184,6 +208,10 @@ public:
     VclPtr<ModulWindow>  FindBasWin( const ScriptDocument& rDocument, const OUString& rLibName, const OUString& rModName, bool bCreateIfNotExist = false, bool bFindSuspended = false );
     VclPtr<BaseWindow>   FindApplicationWindow();
     bool                 NextPage( bool bPrev );
+    /// shows the module of rLocation, which is created if it is not open, with the symbol selected
+    void                 ShowSymbol( const SymbolLocation& rLocation );
+    /// stores the changes of all module windows in their libraries, without saving them
+    void                 StoreAllModulWindows();
 
     bool                IsAppBasicModified () const { return m_bAppBasicModified; }
     void                SetAppBasicModified (bool bModified) { m_bAppBasicModified = bModified; }
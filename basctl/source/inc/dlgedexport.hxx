@@ -0,0 +1,88 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_BASCTL_SOURCE_INC_DLGEDEXPORT_HXX
+#define INCLUDED_BASCTL_SOURCE_INC_DLGEDEXPORT_HXX
+
+#include <com/sun/star/container/XNameContainer.hpp>
+#include <com/sun/star/frame/XModel.hpp>
+#include <com/sun/star/io/XInputStreamProvider.hpp>
+#include <com/sun/star/uno/XComponentContext.hpp>
+#include <rtl/ustring.hxx>
+
+#include <memory>
+#include <vector>
+
+namespace basctl
+{
+
+/** The XML of a dialog model, as the SAX events of xmlscript::exportDialogModel.
+
+    Reading the properties of the controls needs the SolarMutex, writing the XML does
+    not: the snapshot is taken on the main thread, where the exporter reads the model
+    into plain strings, and Encode writes these with a SAX writer of its own on any
+    thread, into the bytes that xmlscript::exportDialogModel gives for the model.
+*/
+class DialogSnapshot
+{
+public:
+    DialogSnapshot( css::uno::Reference< css::container::XNameContainer > const& xDialogModel,
+                    css::uno::Reference< css::uno::XComponentContext > const& xContext,
+                    css::uno::Reference< css::frame::XModel > const& xDocument );
+
+    DialogSnapshot(const DialogSnapshot&) = delete;
+    DialogSnapshot& operator=(const DialogSnapshot&) = delete;
+
+    /// the XML of the dialog; without the SolarMutex, on any thread
+    css::uno::Reference< css::io::XInputStreamProvider > Encode() const;
+
+    /** encodes the snapshots on the thread pool
+
+        @return the XML of each snapshot, in their order, null where there is no
+        snapshot or where encoding it failed
+    */
+    static std::vector< css::uno::Reference< css::io::XInputStreamProvider > >
+        EncodeAll( std::vector< std::unique_ptr<DialogSnapshot> > const& rSnapshots );
+
+private:
+    /// the document handler that the exporter writes to
+    class Recorder;
+
+    enum class EventType
+    {
+        StartDocument, EndDocument, StartElement, EndElement, Characters, IgnorableWhitespace,
+        ProcessingInstruction, StartCDATA, EndCDATA, Comment, AllowLineBreak, Unknown
+    };
+
+    struct Attribute
+    {
+        OUString    aName;
+        OUString    aType;
+        OUString    aValue;
+    };
+
+    struct Event
+    {
+        EventType               eType;
+        /// the element name, or the target of a processing instruction
+        OUString                aName;
+        /// the characters, comment, unknown string or processing instruction data
+        OUString                aData;
+        std::vector<Attribute>  aAttributes;
+    };
+
+    css::uno::Reference< css::uno::XComponentContext >  m_xContext;
+    std::vector<Event>                                  m_aEvents;
+};
+
+} // namespace basctl
+
+#endif // INCLUDED_BASCTL_SOURCE_INC_DLGEDEXPORT_HXX
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
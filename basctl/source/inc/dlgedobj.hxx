@@ -50,6 +50,8 @@ class DlgEdObj: public SdrUnoObj
 
 private:
     bool            bIsListening;
+    /// number of open SuppressNotifications scopes
+    sal_uInt16      m_nSuppressNotifications;
     DlgEdForm*      pDlgEdForm;
     css::uno::Reference< css::beans::XPropertyChangeListener> m_xPropertyChangeListener;
     css::uno::Reference< css::container::XContainerListener>  m_xContainerListener;
@@ -71,6 +73,22 @@ protected:
     using SfxListener::EndListening;
     void    EndListening(bool bRemoveListener);
     bool    isListening() const { return bIsListening; }
+    /// listening and not within a SuppressNotifications scope of this object or its form
+    bool    isNotifying() const;
+
+    /** Ignores the notifications of the control model while the object writes its own
+        properties, with the listeners left attached.  A scope on the form covers all of
+        its children as well.
+    */
+    class SuppressNotifications
+    {
+        DlgEdObj& m_rObj;
+    public:
+        explicit SuppressNotifications( DlgEdObj& rObj ) : m_rObj( rObj ) { ++m_rObj.m_nSuppressNotifications; }
+        ~SuppressNotifications() { --m_rObj.m_nSuppressNotifications; }
+        SuppressNotifications( const SuppressNotifications& ) = delete;
+        SuppressNotifications& operator=( const SuppressNotifications& ) = delete;
+    };
 
     bool TransformSdrToControlCoordinates(
         sal_Int32 nXIn, sal_Int32 nYIn, sal_Int32 nWidthIn, sal_Int32 nHeightIn,
@@ -0,0 +1,335 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for associative containers that are probed more than once with the same key in a row, like
+
+    if (m_aMap.find(nId) != m_aMap.end())
+        x = m_aMap[nId];
+
+    if (!aSet.count(aName))
+        aSet.insert(aName);
+
+which hashes or compares the key twice, and could use the iterator returned by find(), the
+result of insert()/emplace(), or a single operator[] bound to a reference.
+
+Also look for operator[] on maps where the result is only read, which silently inserts a
+default entry if the key is missing.  Use find() instead, or at() if the key must be present.
+
+The lookups are matched within a block and the conditions and branches of if statements in it,
+but not across loop boundaries, and are forgotten when the key variable is assigned to.
+*/
+
+namespace {
+
+struct Lookup
+{
+    const Expr* expr;
+    std::string kind; // "find", "count", "[]", "at", "insert"
+    std::string container;
+    std::string key;
+    std::set<const ValueDecl*> keyDecls;
+};
+
+class DoubleLookup:
+    public RecursiveASTVisitor<DoubleLookup>, public loplugin::Plugin
+{
+public:
+    explicit DoubleLookup(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+    }
+
+    bool VisitCompoundStmt(const CompoundStmt*);
+    bool VisitCXXOperatorCallExpr(const CXXOperatorCallExpr*);
+
+private:
+    void walk(const Stmt*, std::vector<Lookup>&);
+    bool getLookup(const Stmt*, Lookup&);
+    void checkLookup(const Lookup&, std::vector<Lookup>&);
+    void forgetModified(const Stmt*, std::vector<Lookup>&);
+    bool isReadOnlyUse(const Expr*);
+    void collectDecls(const Stmt*, std::set<const ValueDecl*>&);
+    std::string getExprAsString(SourceRange range);
+
+    std::set<const Expr*> reported_;
+};
+
+bool isMapLike(QualType qt)
+{
+    auto const tc = loplugin::TypeCheck(qt.getNonReferenceType());
+    return tc.Class("map").StdNamespace() || tc.Class("unordered_map").StdNamespace()
+        || tc.Class("set").StdNamespace() || tc.Class("unordered_set").StdNamespace();
+}
+
+bool hasSubscript(QualType qt)
+{
+    auto const tc = loplugin::TypeCheck(qt.getNonReferenceType());
+    return tc.Class("map").StdNamespace() || tc.Class("unordered_map").StdNamespace();
+}
+
+bool DoubleLookup::VisitCompoundStmt(const CompoundStmt* compoundStmt)
+{
+    if (ignoreLocation(compoundStmt))
+        return true;
+    std::vector<Lookup> lookups;
+    for (const Stmt* child : compoundStmt->body())
+        walk(child, lookups);
+    return true;
+}
+
+void DoubleLookup::walk(const Stmt* stmt, std::vector<Lookup>& lookups)
+{
+    if (!stmt)
+        return;
+    // these start a new region of their own
+    if (isa<ForStmt>(stmt) || isa<CXXForRangeStmt>(stmt) || isa<WhileStmt>(stmt)
+        || isa<DoStmt>(stmt) || isa<SwitchStmt>(stmt) || isa<LambdaExpr>(stmt))
+    {
+        lookups.clear();
+        return;
+    }
+    if (auto ifStmt = dyn_cast<IfStmt>(stmt))
+    {
+        walk(ifStmt->getCond(), lookups);
+        // the two branches are alternatives, only the condition is common to what follows
+        std::vector<Lookup> thenLookups(lookups);
+        walk(ifStmt->getThen(), thenLookups);
+        std::vector<Lookup> elseLookups(lookups);
+        walk(ifStmt->getElse(), elseLookups);
+        return;
+    }
+    // evaluate the operands before the lookup itself
+    for (const Stmt* child : stmt->children())
+        walk(child, lookups);
+    forgetModified(stmt, lookups);
+    Lookup lookup;
+    if (getLookup(stmt, lookup))
+        checkLookup(lookup, lookups);
+}
+
+bool DoubleLookup::getLookup(const Stmt* stmt, Lookup& lookup)
+{
+    const Expr* object = nullptr;
+    const Expr* key = nullptr;
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(stmt))
+    {
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        if (!methodDecl || !methodDecl->getIdentifier() || memberCall->getNumArgs() == 0)
+            return false;
+        auto name = methodDecl->getName();
+        if (name == "find" || name == "count" || name == "at")
+        {
+            if (memberCall->getNumArgs() != 1)
+                return false;
+            lookup.kind = name.str();
+            key = memberCall->getArg(0);
+        }
+        else if (name == "emplace" || name == "try_emplace")
+        {
+            lookup.kind = "insert";
+            key = memberCall->getArg(0);
+        }
+        else if (name == "insert")
+        {
+            // aMap.insert(std::make_pair(k, v)) or aSet.insert(k)
+            if (memberCall->getNumArgs() != 1)
+                return false;
+            lookup.kind = "insert";
+            key = memberCall->getArg(0)->IgnoreImplicit();
+            if (auto callExpr = dyn_cast<CallExpr>(key))
+            {
+                auto calleeDecl = callExpr->getDirectCallee();
+                if (calleeDecl && calleeDecl->getIdentifier() && calleeDecl->getName() == "make_pair"
+                    && callExpr->getNumArgs() == 2)
+                    key = callExpr->getArg(0);
+            }
+            else if (auto constructExpr = dyn_cast<CXXConstructExpr>(key))
+            {
+                if (constructExpr->getNumArgs() == 2)
+                    key = constructExpr->getArg(0);
+            }
+        }
+        else
+            return false;
+        object = memberCall->getImplicitObjectArgument();
+    }
+    else if (auto opCall = dyn_cast<CXXOperatorCallExpr>(stmt))
+    {
+        if (opCall->getOperator() != OO_Subscript || opCall->getNumArgs() != 2)
+            return false;
+        lookup.kind = "[]";
+        object = opCall->getArg(0);
+        key = opCall->getArg(1);
+    }
+    else
+        return false;
+    if (!object || !key || !isMapLike(object->getType()))
+        return false;
+    object = object->IgnoreParenImpCasts();
+    key = key->IgnoreParenImpCasts();
+    if (object->isValueDependent() || key->isValueDependent())
+        return false;
+    // we cannot tell whether calls yield the same container or key each time
+    if (object->HasSideEffects(compiler.getASTContext()) || key->HasSideEffects(compiler.getASTContext()))
+        return false;
+    lookup.expr = cast<Expr>(stmt);
+    lookup.container = getExprAsString(object->getSourceRange());
+    lookup.key = getExprAsString(key->getSourceRange());
+    if (lookup.container.empty() || lookup.key.empty())
+        return false;
+    collectDecls(key, lookup.keyDecls);
+    return true;
+}
+
+void DoubleLookup::checkLookup(const Lookup& lookup, std::vector<Lookup>& lookups)
+{
+    auto it = std::find_if(lookups.begin(), lookups.end(),
+        [&lookup](const Lookup& rOther) {
+            return rOther.container == lookup.container && rOther.key == lookup.key;
+        });
+    if (it == lookups.end())
+    {
+        lookups.push_back(lookup);
+        return;
+    }
+    if (ignoreLocation(lookup.expr) || !reported_.insert(lookup.expr).second)
+        return;
+    std::string hint;
+    if (it->kind == "find" && (lookup.kind == "[]" || lookup.kind == "at"))
+        hint = "reuse the iterator returned by find()";
+    else if (lookup.kind == "insert" || lookup.kind == "[]")
+        hint = "use the result of a single insert()/emplace()/try_emplace(), or bind operator[] to a reference once";
+    else
+        hint = "keep the iterator returned by a single find()";
+    report(
+        DiagnosticsEngine::Warning,
+        "'%0' is looked up again with key '%1' (%2 after %3), %4",
+        lookup.expr->getExprLoc())
+        << lookup.container << lookup.key << lookup.kind << it->kind << hint
+        << lookup.expr->getSourceRange();
+    report(
+        DiagnosticsEngine::Note, "previous lookup is here", it->expr->getExprLoc())
+        << it->expr->getSourceRange();
+}
+
+/**
+ * Forget about lookups whose key may have changed.
+ */
+void DoubleLookup::forgetModified(const Stmt* stmt, std::vector<Lookup>& lookups)
+{
+    const Expr* target = nullptr;
+    if (auto binOp = dyn_cast<BinaryOperator>(stmt))
+    {
+        if (binOp->isAssignmentOp())
+            target = binOp->getLHS();
+    }
+    else if (auto unaryOp = dyn_cast<UnaryOperator>(stmt))
+    {
+        if (unaryOp->isIncrementDecrementOp() || unaryOp->getOpcode() == UO_AddrOf)
+            target = unaryOp->getSubExpr();
+    }
+    else if (auto opCall = dyn_cast<CXXOperatorCallExpr>(stmt))
+    {
+        if (opCall->isAssignmentOp() && opCall->getNumArgs() >= 1)
+            target = opCall->getArg(0);
+    }
+    if (!target)
+        return;
+    std::set<const ValueDecl*> modified;
+    collectDecls(target, modified);
+    lookups.erase(
+        std::remove_if(lookups.begin(), lookups.end(),
+            [&modified](const Lookup& rLookup) {
+                for (auto decl : modified)
+                    if (rLookup.keyDecls.count(decl))
+                        return true;
+                return false;
+            }),
+        lookups.end());
+}
+
+void DoubleLookup::collectDecls(const Stmt* stmt, std::set<const ValueDecl*>& decls)
+{
+    if (auto declRefExpr = dyn_cast<DeclRefExpr>(stmt))
+        decls.insert(declRefExpr->getDecl());
+    else if (auto memberExpr = dyn_cast<MemberExpr>(stmt))
+        decls.insert(memberExpr->getMemberDecl());
+    for (const Stmt* child : stmt->children())
+        if (child)
+            collectDecls(child, decls);
+}
+
+bool DoubleLookup::VisitCXXOperatorCallExpr(const CXXOperatorCallExpr* opCall)
+{
+    if (ignoreLocation(opCall))
+        return true;
+    if (opCall->getOperator() != OO_Subscript || opCall->getNumArgs() != 2)
+        return true;
+    if (!hasSubscript(opCall->getArg(0)->getType()))
+        return true;
+    if (!isReadOnlyUse(opCall))
+        return true;
+    report(
+        DiagnosticsEngine::Warning,
+        "map operator[] is only read here, but inserts a default entry when the key is missing, use find() or at()",
+        opCall->getExprLoc())
+        << opCall->getSourceRange();
+    return true;
+}
+
+bool DoubleLookup::isReadOnlyUse(const Expr* expr)
+{
+    const Stmt* parent = parentStmt(expr);
+    while (parent && isa<ParenExpr>(parent))
+        parent = parentStmt(parent);
+    if (!parent)
+        return false;
+    if (auto castExpr = dyn_cast<ImplicitCastExpr>(parent))
+        return castExpr->getCastKind() == CK_LValueToRValue;
+    if (auto memberExpr = dyn_cast<MemberExpr>(parent))
+    {
+        auto methodDecl = dyn_cast<CXXMethodDecl>(memberExpr->getMemberDecl());
+        return methodDecl && methodDecl->isConst();
+    }
+    if (auto constructExpr = dyn_cast<CXXConstructExpr>(parent))
+        return constructExpr->getConstructor()->isCopyConstructor();
+    return false;
+}
+
+std::string DoubleLookup::getExprAsString(SourceRange range)
+{
+    SourceManager& SM = compiler.getSourceManager();
+    SourceLocation startLoc = SM.getExpansionLoc(range.getBegin());
+    SourceLocation endLoc = SM.getExpansionLoc(range.getEnd());
+    const char *p1 = SM.getCharacterData( startLoc );
+    const char *p2 = SM.getCharacterData( endLoc );
+    if (!p1 || !p2 || (p2 - p1) < 0) {
+        return "";
+    }
+    unsigned n = Lexer::MeasureTokenLength( endLoc, SM, compiler.getLangOpts());
+    return std::string( p1, p2 - p1 + n);
+}
+
+loplugin::Plugin::Registration< DoubleLookup > X("doublelookup", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,387 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for type dispatch written as an if/else-if chain that probes the same object again and
+again, like
+
+    if (dynamic_cast<DlgEdForm*>(pObj) != nullptr)
+        ...
+    else if (pDlgEdObj->supportsService("com.sun.star.awt.UnoControlGroupBoxModel"))
+        ...
+
+    if (supportsService("com.sun.star.awt.UnoControlDialogModel"))
+        ...
+    else if (supportsService("com.sun.star.awt.UnoControlButtonModel"))
+        ...
+
+Each failed dynamic_cast walks the RTTI, each failed UNO_QUERY is a queryInterface call, and
+each failed supportsService is a UNO call comparing strings, so classifying an object costs
+O(n) in the length of the chain.  A kind stored in the object, or a virtual method, would
+classify it in one step.
+
+Probes are dynamic_cast to a pointer, Reference(x, UNO_QUERY).is() (also through a local
+variable initialized that way), and supportsService.  Two probes count as being on the same
+object when they name the same variable, member or getter, looking through local variables
+that are themselves initialized by a dynamic_cast or UNO_QUERY of it.  The chains are
+reported with their length, and the depth of the loops they are in.
+*/
+
+namespace {
+
+char const * const probeNames[] = { "dynamic_cast", "UNO_QUERY", "supportsService" };
+
+class DynamicCastChain:
+    public RecursiveASTVisitor<DynamicCastChain>, public loplugin::Plugin
+{
+public:
+    explicit DynamicCastChain(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (compiler.getLangOpts().CPlusPlus) {
+            TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+        }
+    }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        unsigned saved = 0;
+        std::swap(saved, loopDepth_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        std::swap(saved, loopDepth_);
+        return ret;
+    }
+
+    bool VisitIfStmt(const IfStmt*);
+
+private:
+    enum class Probe { DynamicCast, UnoQuery, SupportsService };
+
+    const Expr* probeSubject(const IfStmt* ifStmt, Probe& probe);
+    const Expr* probeSubject(const Expr* expr, Probe& probe);
+    std::string subjectKey(const Expr* expr);
+
+    unsigned loopDepth_ = 0;
+    // the else-if links of the chains already looked at from their head
+    std::set<const IfStmt*> chained_;
+};
+
+/**
+ * The object x in Reference<X>(x, UNO_QUERY), or nullptr if expr is not that.
+ */
+const Expr* unoQuerySource(const Expr* expr)
+{
+    auto const constructExpr = dyn_cast<CXXConstructExpr>(expr->IgnoreImplicit());
+    if (!constructExpr || constructExpr->getNumArgs() < 2) {
+        return nullptr;
+    }
+    if (!loplugin::TypeCheck(constructExpr->getType()).Class("Reference").Namespace("uno").Namespace("star")
+        .Namespace("sun").Namespace("com").GlobalNamespace())
+    {
+        return nullptr;
+    }
+    auto const enumType = constructExpr->getArg(1)->getType()->getAs<EnumType>();
+    if (!enumType || !enumType->getDecl()->getIdentifier()
+        || enumType->getDecl()->getName() != "UnoReference_Query")
+    {
+        return nullptr;
+    }
+    return constructExpr->getArg(0);
+}
+
+/**
+ * The next link of an else-if chain, also for an else block that declares something and then
+ * tests it, like
+ *
+ *     else
+ *     {
+ *         Reference<XFoo> xFoo(x, UNO_QUERY);
+ *         if (xFoo.is())
+ *             ...
+ *     }
+ */
+const IfStmt* nextLink(const Stmt* elseStmt)
+{
+    if (!elseStmt) {
+        return nullptr;
+    }
+    if (auto const ifStmt = dyn_cast<IfStmt>(elseStmt)) {
+        return ifStmt;
+    }
+    auto const compoundStmt = dyn_cast<CompoundStmt>(elseStmt);
+    if (!compoundStmt || compoundStmt->size() == 0) {
+        return nullptr;
+    }
+    for (auto it = compoundStmt->body_begin(); it != compoundStmt->body_end(); ++it) {
+        if (std::next(it) == compoundStmt->body_end()) {
+            return dyn_cast<IfStmt>(*it);
+        }
+        if (!isa<DeclStmt>(*it)) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+bool DynamicCastChain::VisitIfStmt(const IfStmt* ifStmt)
+{
+    if (ignoreLocation(ifStmt) || chained_.find(ifStmt) != chained_.end()) {
+        return true;
+    }
+    std::vector<const IfStmt*> chain;
+    for (const IfStmt* link = ifStmt; link; link = nextLink(link->getElse())) {
+        chain.push_back(link);
+        chained_.insert(link);
+    }
+    if (chain.size() < 2) {
+        return true;
+    }
+
+    // the subject probed most often, with the probes done on it
+    std::map<std::string, std::vector<std::pair<const IfStmt*, Probe>>> probes;
+    for (const IfStmt* link : chain) {
+        Probe probe = Probe::DynamicCast;
+        const Expr* subject = probeSubject(link, probe);
+        if (!subject) {
+            continue;
+        }
+        std::string key = subjectKey(subject);
+        if (!key.empty()) {
+            probes[key].emplace_back(link, probe);
+        }
+    }
+    const std::vector<std::pair<const IfStmt*, Probe>>* longest = nullptr;
+    for (auto const & entry : probes) {
+        if (!longest || entry.second.size() > longest->size()) {
+            longest = &entry.second;
+        }
+    }
+    if (!longest || longest->size() < 2) {
+        return true;
+    }
+
+    std::set<Probe> kinds;
+    std::string kindNames;
+    for (auto const & link : *longest) {
+        if (kinds.insert(link.second).second) {
+            if (!kindNames.empty())
+                kindNames += ", ";
+            kindNames += probeNames[static_cast<int>(link.second)];
+        }
+    }
+    report(
+        DiagnosticsEngine::Warning,
+        "else-if chain of %0 type probes (%1) on the same object%select{| in a loop (depth %3)}2, store a kind or use a virtual method to classify it in one step",
+        longest->front().first->getLocStart())
+        << unsigned(longest->size()) << kindNames << (loopDepth_ != 0) << loopDepth_
+        << longest->front().first->getCond()->getSourceRange();
+    return true;
+}
+
+const Expr* DynamicCastChain::probeSubject(const IfStmt* ifStmt, Probe& probe)
+{
+    // if (auto p = dynamic_cast<T*>(x))
+    if (const VarDecl* varDecl = ifStmt->getConditionVariable()) {
+        if (varDecl->getInit()) {
+            if (auto const castExpr = dyn_cast<CXXDynamicCastExpr>(varDecl->getInit()->IgnoreParenImpCasts())) {
+                probe = Probe::DynamicCast;
+                return castExpr->getSubExpr();
+            }
+        }
+        return nullptr;
+    }
+    return probeSubject(ifStmt->getCond(), probe);
+}
+
+const Expr* DynamicCastChain::probeSubject(const Expr* expr, Probe& probe)
+{
+    if (!expr) {
+        return nullptr;
+    }
+    expr = expr->IgnoreParenImpCasts();
+    if (auto const binaryOperator = dyn_cast<BinaryOperator>(expr)) {
+        switch (binaryOperator->getOpcode()) {
+        case BO_LAnd:
+        case BO_LOr:
+            return probeSubject(binaryOperator->getLHS(), probe);
+        case BO_EQ:
+        case BO_NE:
+            // dynamic_cast<T*>(x) != nullptr
+            if (binaryOperator->getRHS()->isNullPointerConstant(compiler.getASTContext(), Expr::NPC_ValueDependentIsNotNull))
+                return probeSubject(binaryOperator->getLHS(), probe);
+            if (binaryOperator->getLHS()->isNullPointerConstant(compiler.getASTContext(), Expr::NPC_ValueDependentIsNotNull))
+                return probeSubject(binaryOperator->getRHS(), probe);
+            return nullptr;
+        default:
+            return nullptr;
+        }
+    }
+    if (auto const castExpr = dyn_cast<CXXDynamicCastExpr>(expr)) {
+        if (!castExpr->getType()->isPointerType())
+            return nullptr;
+        probe = Probe::DynamicCast;
+        return castExpr->getSubExpr();
+    }
+    // if (pFoo), with pFoo initialized by a dynamic_cast
+    if (auto const declRefExpr = dyn_cast<DeclRefExpr>(expr)) {
+        auto const varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+        if (varDecl && varDecl->hasLocalStorage() && varDecl->getInit()) {
+            if (auto const castExpr = dyn_cast<CXXDynamicCastExpr>(varDecl->getInit()->IgnoreParenImpCasts())) {
+                probe = Probe::DynamicCast;
+                return castExpr->getSubExpr();
+            }
+        }
+        return nullptr;
+    }
+    auto const callExpr = dyn_cast<CXXMemberCallExpr>(expr);
+    if (!callExpr || !callExpr->getMethodDecl() || !callExpr->getMethodDecl()->getIdentifier()) {
+        return nullptr;
+    }
+    StringRef name = callExpr->getMethodDecl()->getName();
+    const Expr* object = callExpr->getImplicitObjectArgument();
+    if (!object) {
+        return nullptr;
+    }
+    if (name == "is") {
+        // Reference<X>(x, UNO_QUERY).is(), or xFoo.is() with xFoo initialized like that
+        if (auto const source = unoQuerySource(object)) {
+            probe = Probe::UnoQuery;
+            return source;
+        }
+        if (auto const declRefExpr = dyn_cast<DeclRefExpr>(object->IgnoreParenImpCasts())) {
+            auto const varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+            if (varDecl && varDecl->hasLocalStorage() && varDecl->getInit()) {
+                if (auto const source = unoQuerySource(varDecl->getInit())) {
+                    probe = Probe::UnoQuery;
+                    return source;
+                }
+            }
+        }
+        return nullptr;
+    }
+    if (name == "supportsService") {
+        probe = Probe::SupportsService;
+        return object;
+    }
+    return nullptr;
+}
+
+/**
+ * A string that is equal for two expressions naming the same object, or empty if that
+ * cannot be told.
+ */
+std::string DynamicCastChain::subjectKey(const Expr* expr)
+{
+    expr = expr->IgnoreParenImpCasts();
+    if (isa<CXXThisExpr>(expr)) {
+        return "this";
+    }
+    if (auto const declRefExpr = dyn_cast<DeclRefExpr>(expr)) {
+        auto const varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+        if (!varDecl) {
+            return "";
+        }
+        // look through a local that is the same object, cast or queried
+        if (varDecl->hasLocalStorage() && varDecl->getInit()) {
+            const Expr* init = varDecl->getInit()->IgnoreParenImpCasts();
+            if (auto const castExpr = dyn_cast<CXXDynamicCastExpr>(init))
+                return subjectKey(castExpr->getSubExpr());
+            if (auto const source = unoQuerySource(init))
+                return subjectKey(source);
+        }
+        return "var:" + std::to_string(reinterpret_cast<uintptr_t>(varDecl->getCanonicalDecl()));
+    }
+    if (auto const memberExpr = dyn_cast<MemberExpr>(expr)) {
+        if (!isa<FieldDecl>(memberExpr->getMemberDecl())) {
+            return "";
+        }
+        std::string base = subjectKey(memberExpr->getBase());
+        if (base.empty()) {
+            return "";
+        }
+        return base + "." + memberExpr->getMemberDecl()->getNameAsString();
+    }
+    if (auto const operatorCallExpr = dyn_cast<CXXOperatorCallExpr>(expr)) {
+        // xFoo->supportsService(...), *pFoo
+        if (operatorCallExpr->getOperator() == OO_Arrow || operatorCallExpr->getOperator() == OO_Star) {
+            return subjectKey(operatorCallExpr->getArg(0));
+        }
+        return "";
+    }
+    if (auto const callExpr = dyn_cast<CXXMemberCallExpr>(expr)) {
+        // a getter, like GetUnoControlModel() or get()
+        auto const methodDecl = callExpr->getMethodDecl();
+        if (!methodDecl || !methodDecl->isConst() || callExpr->getNumArgs() != 0
+            || !methodDecl->getIdentifier() || !callExpr->getImplicitObjectArgument())
+        {
+            return "";
+        }
+        std::string base = subjectKey(callExpr->getImplicitObjectArgument());
+        if (base.empty()) {
+            return "";
+        }
+        if (methodDecl->getName() == "get") {
+            return base;
+        }
+        return base + "." + methodDecl->getNameAsString() + "()";
+    }
+    if (auto const source = unoQuerySource(expr)) {
+        return subjectKey(source);
+    }
+    return "";
+}
+
+loplugin::Plugin::Registration< DynamicCastChain > X("dynamiccastchain", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,494 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "compat.hxx"
+#include "plugin.hxx"
+
+/**
+Dump a call graph of the whole tree, with the effects each function has by itself:
+
+    uno         calls a method of a UNO interface, or queries for one
+    mutex       takes a mutex other than the SolarMutex
+    solarmutex  takes the SolarMutex
+    alloc       allocates from the heap
+    throw       throws an exception
+    io          reads or writes files or streams
+
+Functions that are defined in system headers or in the URE headers are not followed;
+instead, calls to the ones that are known to have an effect (operator new, the growing
+members of the std containers, the rtl string constructors, osl file functions, SvStream,
+...) count as that effect at the call site.  A virtual call leads to the method named in
+the call, and the "override" facts let the post-processor continue to the overriders.
+Implicit destructor calls and calls through function pointers are not followed.
+
+The post-processor computes the transitive effects of each function and answers queries
+like "which functions reachable from a Paint handler allocate":
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='effectsummary' check
+  $ ./compilerplugins/clang/effectsummary.py
+  $ ./compilerplugins/clang/effectsummary.py --from '::Paint\(' --effect alloc
+  $ ./compilerplugins/clang/effectsummary.py --match '::get[A-Z]' --effect alloc
+*/
+
+namespace {
+
+struct MyEffectInfo
+{
+    std::string function;
+    std::string effect;
+    std::string sourceLocation;
+};
+bool operator < (const MyEffectInfo &lhs, const MyEffectInfo &rhs)
+{
+    return std::tie(lhs.function, lhs.effect)
+         < std::tie(rhs.function, rhs.effect);
+}
+
+// try to limit the voluminous output a little
+static std::set<std::pair<std::string, std::string>> definitionSet; // function, sourceLocation
+static std::set<MyEffectInfo> effectSet;
+static std::set<std::pair<std::string, std::string>> callSet; // caller, callee
+static std::set<std::pair<std::string, std::string>> overrideSet; // overrider, overridden
+
+// Qualified names of functions, outside of the tree, that have an effect; a trailing "::"
+// matches all members of a class, and a trailing "*" is a prefix match.
+struct KnownEffect
+{
+    char const * name;
+    char const * effect;
+};
+KnownEffect const knownEffects[] = {
+    { "operator new", "alloc" },
+    { "operator new[]", "alloc" },
+    { "malloc", "alloc" },
+    { "calloc", "alloc" },
+    { "realloc", "alloc" },
+    { "strdup", "alloc" },
+    { "rtl_allocateMemory", "alloc" },
+    { "rtl_uString_new*", "alloc" },
+    { "rtl_uString_assign", "alloc" },
+    { "rtl_string_new*", "alloc" },
+    { "rtl_uStringbuffer_*", "alloc" },
+    { "rtl_stringbuffer_*", "alloc" },
+    { "uno_type_sequence_construct", "alloc" },
+    { "uno_type_sequence_realloc", "alloc" },
+    { "uno_type_any_construct", "alloc" },
+    { "std::make_shared", "alloc" },
+    { "std::make_unique", "alloc" },
+    { "std::allocate_shared", "alloc" },
+    { "std::to_string", "alloc" },
+    { "o3tl::make_unique", "alloc" },
+    { "osl_acquireMutex", "mutex" },
+    { "osl::Mutex::acquire", "mutex" },
+    { "std::mutex::lock", "mutex" },
+    { "std::recursive_mutex::lock", "mutex" },
+    { "comphelper::SolarMutex::acquire", "solarmutex" },
+    { "comphelper::SolarMutex::doAcquire", "solarmutex" },
+    { "osl_openFile", "io" },
+    { "osl_readFile", "io" },
+    { "osl_readLine", "io" },
+    { "osl_writeFile", "io" },
+    { "osl_getFileStatus", "io" },
+    { "osl_getDirectoryItem", "io" },
+    { "osl_getNextDirectoryItem", "io" },
+    { "osl::File::", "io" },
+    { "osl::Directory::", "io" },
+    { "osl::DirectoryItem::get", "io" },
+    { "fopen", "io" },
+    { "fread", "io" },
+    { "fwrite", "io" },
+    { "fgets", "io" },
+    { "fputs", "io" },
+    { "fprintf", "io" },
+    { "fflush", "io" },
+    { "SvStream::", "io" },
+    { "SvFileStream::", "io" },
+    { "ucbhelper::Content::", "io" },
+    { "utl::UcbStreamHelper::", "io" },
+};
+
+// Members of std containers that may allocate.
+char const * const growingMembers[] = {
+    "push_back", "emplace_back", "push_front", "emplace_front", "insert", "emplace",
+    "emplace_hint", "resize", "reserve", "append", "assign", "operator[]", "operator+=",
+};
+
+bool isGuardType(QualType qt, bool & solar)
+{
+    auto const tc = loplugin::TypeCheck(qt.getNonReferenceType());
+    solar = tc.Class("SolarMutexGuard").GlobalNamespace()
+        || tc.Class("SolarMutexClearableGuard").GlobalNamespace()
+        || tc.Class("SolarMutexResettableGuard").GlobalNamespace();
+    return solar
+        || tc.Class("Guard").Namespace("osl").GlobalNamespace()
+        || tc.Class("ClearableGuard").Namespace("osl").GlobalNamespace()
+        || tc.Class("ResettableGuard").Namespace("osl").GlobalNamespace()
+        || tc.Class("OExternalLockGuard").GlobalNamespace()
+        || tc.Class("lock_guard").StdNamespace()
+        || tc.Class("unique_lock").StdNamespace()
+        || tc.Class("scoped_lock").StdNamespace();
+}
+
+// the tag that makes a Reference constructor or Reference::set call queryInterface
+bool isQueryTag(const Expr* expr)
+{
+    auto const enumType = expr->getType()->getAs<EnumType>();
+    if (!enumType)
+        return false;
+    std::string const name = enumType->getDecl()->getQualifiedNameAsString();
+    return name == "com::sun::star::uno::UnoReference_Query"
+        || name == "com::sun::star::uno::UnoReference_QueryThrow";
+}
+
+bool isStdContainer(const CXXRecordDecl* recordDecl)
+{
+    auto const dc = loplugin::DeclCheck(recordDecl);
+    return dc.Class("vector").StdNamespace()
+        || dc.Class("deque").StdNamespace()
+        || dc.Class("list").StdNamespace()
+        || dc.Class("forward_list").StdNamespace()
+        || dc.Class("map").StdNamespace()
+        || dc.Class("multimap").StdNamespace()
+        || dc.Class("set").StdNamespace()
+        || dc.Class("multiset").StdNamespace()
+        || dc.Class("unordered_map").StdNamespace()
+        || dc.Class("unordered_multimap").StdNamespace()
+        || dc.Class("unordered_set").StdNamespace()
+        || dc.Class("unordered_multiset").StdNamespace()
+        || dc.Class("basic_string").StdNamespace();
+}
+
+class EffectSummary:
+    public RecursiveASTVisitor<EffectSummary>, public loplugin::Plugin
+{
+public:
+    explicit EffectSummary(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const std::pair<std::string, std::string> & s : definitionSet)
+            output += "definition:\t" + s.first + "\t" + s.second + "\n";
+        for (const MyEffectInfo & s : effectSet)
+            output += "effect:\t" + s.function + "\t" + s.effect + "\t" + s.sourceLocation + "\n";
+        for (const std::pair<std::string, std::string> & s : callSet)
+            output += "call:\t" + s.first + "\t" + s.second + "\n";
+        for (const std::pair<std::string, std::string> & s : overrideSet)
+            output += "override:\t" + s.first + "\t" + s.second + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.effectsummary.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool shouldVisitTemplateInstantiations () const { return true; }
+    bool shouldVisitImplicitCode() const { return true; }
+
+    bool VisitFunctionDecl( const FunctionDecl* );
+    bool VisitCallExpr( const CallExpr* );
+    bool VisitCXXConstructExpr( const CXXConstructExpr* );
+    bool VisitCXXNewExpr( const CXXNewExpr* );
+    bool VisitCXXThrowExpr( const CXXThrowExpr* );
+    // interception methods for FunctionDecl and all its subclasses
+    bool TraverseFunctionDecl( FunctionDecl* );
+    bool TraverseCXXMethodDecl( CXXMethodDecl* );
+    bool TraverseCXXConstructorDecl( CXXConstructorDecl* );
+    bool TraverseCXXConversionDecl( CXXConversionDecl* );
+    bool TraverseCXXDestructorDecl( CXXDestructorDecl* );
+
+private:
+    std::string niceName(const FunctionDecl* functionDecl);
+    std::string toString(SourceLocation loc);
+    /// the function whose body is being traversed, if its effects are recorded
+    const FunctionDecl* currentFunction();
+    bool isOutsideTree(const FunctionDecl*);
+    void addEffect(const char* effect, const Stmt* stmt);
+    void addCall(const FunctionDecl* callee, const Stmt* stmt);
+    const char* knownEffect(const FunctionDecl* callee);
+
+    // I use traverse and a member variable because I cannot find a reliable way of walking back up the AST tree using the parentStmt() stuff
+    std::vector<const FunctionDecl*> maTraversingFunctions;
+};
+
+std::string EffectSummary::niceName(const FunctionDecl* functionDecl)
+{
+    if (functionDecl->getInstantiatedFromMemberFunction())
+        functionDecl = functionDecl->getInstantiatedFromMemberFunction();
+    else if (functionDecl->getClassScopeSpecializationPattern())
+        functionDecl = functionDecl->getClassScopeSpecializationPattern();
+// workaround clang-3.5 issue
+#if CLANG_VERSION >= 30600
+    else if (functionDecl->getTemplateInstantiationPattern())
+        functionDecl = functionDecl->getTemplateInstantiationPattern();
+#endif
+
+    std::string s;
+    if (isa<CXXMethodDecl>(functionDecl)) {
+        const CXXRecordDecl* recordDecl = dyn_cast<CXXMethodDecl>(functionDecl)->getParent();
+        s += recordDecl->getQualifiedNameAsString();
+        s += "::";
+        s += functionDecl->getNameAsString();
+    } else {
+        s += functionDecl->getQualifiedNameAsString();
+    }
+    s += "(";
+    bool bFirst = true;
+    for (const ParmVarDecl *pParmVarDecl : compat::parameters(*functionDecl)) {
+        if (bFirst)
+            bFirst = false;
+        else
+            s += ",";
+        s += pParmVarDecl->getType().getCanonicalType().getAsString();
+    }
+    s += ")";
+    if (isa<CXXMethodDecl>(functionDecl) && dyn_cast<CXXMethodDecl>(functionDecl)->isConst()) {
+        s += " const";
+    }
+    return s;
+}
+
+std::string EffectSummary::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string sourceLocation = std::string(name.substr(strlen(SRCDIR)+1)) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+    normalizeDotDotInFilePath(sourceLocation);
+    return sourceLocation;
+}
+
+bool EffectSummary::isOutsideTree(const FunctionDecl* functionDecl)
+{
+    // system headers, and the stable URE interface, whose effects come from knownEffects
+    return ignoreLocation(functionDecl) || isInUnoIncludeFile(functionDecl);
+}
+
+const FunctionDecl* EffectSummary::currentFunction()
+{
+    if (maTraversingFunctions.empty())
+        return nullptr;
+    const FunctionDecl* functionDecl = maTraversingFunctions.back();
+    if (isOutsideTree(functionDecl))
+        return nullptr;
+    return functionDecl;
+}
+
+bool EffectSummary::VisitFunctionDecl( const FunctionDecl* functionDecl )
+{
+    if (!functionDecl->doesThisDeclarationHaveABody() || isOutsideTree(functionDecl))
+        return true;
+    if (functionDecl->isDeleted() || functionDecl->isDefaulted())
+        return true;
+    std::string const name = niceName(functionDecl);
+    definitionSet.emplace(name, toString(functionDecl->getLocation()));
+
+    if (const CXXMethodDecl* methodDecl = dyn_cast<CXXMethodDecl>(functionDecl)) {
+        for (auto it = methodDecl->begin_overridden_methods(); it != methodDecl->end_overridden_methods(); ++it)
+            overrideSet.emplace(name, niceName(*it));
+    }
+    return true;
+}
+
+void EffectSummary::addEffect(const char* effect, const Stmt* stmt)
+{
+    const FunctionDecl* functionDecl = currentFunction();
+    if (!functionDecl)
+        return;
+    MyEffectInfo aInfo;
+    aInfo.function = niceName(functionDecl);
+    aInfo.effect = effect;
+    aInfo.sourceLocation = toString(stmt->getLocStart());
+    // keep the first location only
+    effectSet.insert(aInfo);
+}
+
+void EffectSummary::addCall(const FunctionDecl* callee, const Stmt* stmt)
+{
+    const FunctionDecl* functionDecl = currentFunction();
+    if (!functionDecl)
+        return;
+
+    if (const char* effect = knownEffect(callee)) {
+        addEffect(effect, stmt);
+        return;
+    }
+
+    if (const CXXMethodDecl* methodDecl = dyn_cast<CXXMethodDecl>(callee)) {
+        // a method of a UNO interface; the implementation is behind a bridge or elsewhere
+        if (methodDecl->isVirtual() && methodDecl->getParent()->isPolymorphic()
+            && methodDecl->getParent()->getQualifiedNameAsString().compare(0, 16, "com::sun::star::") == 0)
+        {
+            addEffect("uno", stmt);
+            return;
+        }
+        if (isStdContainer(methodDecl->getParent())) {
+            std::string const member = methodDecl->getNameAsString();
+            for (char const * growing : growingMembers) {
+                if (member == growing) {
+                    // operator[] only inserts into the associative containers
+                    if (member != "operator[]" || !loplugin::DeclCheck(methodDecl->getParent()).Class("vector").StdNamespace())
+                        addEffect("alloc", stmt);
+                    return;
+                }
+            }
+        }
+    }
+
+    if (isOutsideTree(callee))
+        return;
+    callSet.emplace(niceName(functionDecl), niceName(callee));
+}
+
+const char* EffectSummary::knownEffect(const FunctionDecl* callee)
+{
+    std::string name = callee->getQualifiedNameAsString();
+    std::string className;
+    if (const CXXMethodDecl* methodDecl = dyn_cast<CXXMethodDecl>(callee))
+        className = methodDecl->getParent()->getQualifiedNameAsString() + "::";
+    for (KnownEffect const & known : knownEffects) {
+        std::string const pattern(known.name);
+        if (pattern.back() == '*') {
+            if (name.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0)
+                return known.effect;
+        } else if (pattern.size() > 2 && pattern.compare(pattern.size() - 2, 2, "::") == 0) {
+            if (className == pattern)
+                return known.effect;
+        } else if (name == pattern) {
+            return known.effect;
+        }
+    }
+    return nullptr;
+}
+
+bool EffectSummary::VisitCallExpr( const CallExpr* callExpr )
+{
+    if (!currentFunction())
+        return true;
+    const FunctionDecl* callee = callExpr->getDirectCallee();
+    if (!callee)
+        return true;
+
+    // a query for an interface
+    if (const CXXMethodDecl* methodDecl = dyn_cast<CXXMethodDecl>(callee)) {
+        if (loplugin::DeclCheck(methodDecl).Function("set").Class("Reference").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace()
+            && callExpr->getNumArgs() >= 2 && isQueryTag(callExpr->getArg(callExpr->getNumArgs() - 1)))
+        {
+            addEffect("uno", callExpr);
+            return true;
+        }
+    }
+
+    addCall(callee, callExpr);
+    return true;
+}
+
+bool EffectSummary::VisitCXXConstructExpr( const CXXConstructExpr* constructExpr )
+{
+    if (!currentFunction())
+        return true;
+    const CXXConstructorDecl* constructorDecl = constructExpr->getConstructor();
+
+    bool solar;
+    if (isGuardType(constructExpr->getType(), solar)) {
+        addEffect(solar ? "solarmutex" : "mutex", constructExpr);
+        return true;
+    }
+
+    auto const tc = loplugin::TypeCheck(constructExpr->getType());
+    if (tc.Class("Reference").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace()
+        && constructExpr->getNumArgs() >= 2 && isQueryTag(constructExpr->getArg(constructExpr->getNumArgs() - 1)))
+    {
+        addEffect("uno", constructExpr);
+        return true;
+    }
+
+    // strings and containers built from something allocate; copies share or allocate
+    // depending on the type, and are left out
+    if (constructExpr->getNumArgs() != 0 && !constructorDecl->isCopyOrMoveConstructor()
+        && (tc.Class("OUString").Namespace("rtl").GlobalNamespace()
+            || tc.Class("OString").Namespace("rtl").GlobalNamespace()
+            || tc.Class("OUStringBuffer").Namespace("rtl").GlobalNamespace()
+            || tc.Class("OStringBuffer").Namespace("rtl").GlobalNamespace()
+            || tc.Class("Sequence").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace()
+            || (constructExpr->getType()->getAsCXXRecordDecl()
+                && isStdContainer(constructExpr->getType()->getAsCXXRecordDecl()))))
+    {
+        addEffect("alloc", constructExpr);
+        return true;
+    }
+
+    addCall(constructorDecl, constructExpr);
+    return true;
+}
+
+bool EffectSummary::VisitCXXNewExpr( const CXXNewExpr* newExpr )
+{
+    // placement new does not allocate
+    if (newExpr->getNumPlacementArgs() == 0)
+        addEffect("alloc", newExpr);
+    return true;
+}
+
+bool EffectSummary::VisitCXXThrowExpr( const CXXThrowExpr* throwExpr )
+{
+    addEffect("throw", throwExpr);
+    return true;
+}
+
+bool EffectSummary::TraverseFunctionDecl( FunctionDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseFunctionDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool EffectSummary::TraverseCXXMethodDecl( CXXMethodDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXMethodDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool EffectSummary::TraverseCXXConstructorDecl( CXXConstructorDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXConstructorDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool EffectSummary::TraverseCXXConversionDecl( CXXConversionDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXConversionDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool EffectSummary::TraverseCXXDestructorDecl( CXXDestructorDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXDestructorDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+
+loplugin::Plugin::Registration< EffectSummary > X("effectsummary", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
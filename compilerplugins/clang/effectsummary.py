@@ -0,0 +1,131 @@
+#!/usr/bin/python
+
+import argparse
+import io
+import re
+from collections import defaultdict, deque
+
+definitionToSourceLocationMap = dict() # function -> sourceLocation
+localEffectMap = defaultdict(dict) # function -> effect -> sourceLocation
+calleesMap = defaultdict(set) # caller -> callees
+overridersMap = defaultdict(set) # method -> methods that override it
+
+with io.open("loplugin.effectsummary.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "definition:":
+            definitionToSourceLocationMap[tokens[1]] = tokens[2]
+        elif tokens[0] == "effect:":
+            localEffectMap[tokens[1]].setdefault(tokens[2], tokens[3])
+        elif tokens[0] == "call:":
+            calleesMap[tokens[1]].add(tokens[2])
+        elif tokens[0] == "override:":
+            overridersMap[tokens[2]].add(tokens[1])
+        else:
+            print( "unknown line: " + line)
+
+# a call to a virtual method may end up in any of its overriders
+for method, overriders in overridersMap.items():
+    calleesMap[method] |= overriders
+
+callersMap = defaultdict(set)
+for caller, callees in calleesMap.items():
+    for callee in callees:
+        callersMap[callee].add(caller)
+
+# For each effect, walk backwards from the functions that have it themselves; every caller
+# reached has it transitively, and remembers the callee through which it has it, so that a
+# path down to the place where it happens can be printed.
+effects = set()
+for effectMap in localEffectMap.values():
+    effects |= set(effectMap.keys())
+
+viaMap = defaultdict(dict) # function -> effect -> callee, or None if the effect is local
+for effect in effects:
+    queue = deque()
+    for function, effectMap in localEffectMap.items():
+        if effect in effectMap:
+            viaMap[function][effect] = None
+            queue.append(function)
+    while queue:
+        callee = queue.popleft()
+        for caller in callersMap[callee]:
+            if effect not in viaMap[caller]:
+                viaMap[caller][effect] = callee
+                queue.append(caller)
+
+def pathToEffect(function, effect):
+    path = [function]
+    while viaMap[function][effect] is not None:
+        function = viaMap[function][effect]
+        path.append(function)
+    return path, localEffectMap[function][effect]
+
+def describe(function):
+    return function + " (" + definitionToSourceLocationMap.get(function, "?") + ")"
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+parser = argparse.ArgumentParser(description="Query the call graph and the effects dumped by loplugin:effectsummary.")
+parser.add_argument("--from", dest="fromRegex",
+    help="list the functions reachable from those whose name matches FROMREGEX that have the effect themselves")
+parser.add_argument("--match",
+    help="list the functions whose name matches MATCH that have the effect, directly or through their callees")
+parser.add_argument("--effect", choices=sorted(effects) if effects else None,
+    help="the effect to look for")
+args = parser.parse_args()
+
+if args.fromRegex or args.match:
+    if not args.effect:
+        parser.error("--from and --match need --effect")
+
+if args.fromRegex:
+    fromRe = re.compile(args.fromRegex)
+    roots = [f for f in calleesMap.keys() + definitionToSourceLocationMap.keys() if fromRe.search(f)]
+    # breadth-first, so the path printed for each hit is a shortest one
+    parentMap = dict()
+    queue = deque()
+    for root in roots:
+        if root not in parentMap:
+            parentMap[root] = None
+            queue.append(root)
+    while queue:
+        function = queue.popleft()
+        for callee in calleesMap[function]:
+            if callee not in parentMap:
+                parentMap[callee] = function
+                queue.append(callee)
+    hits = [f for f in parentMap.keys() if args.effect in localEffectMap[f]]
+    for function in sorted(hits, key=natural_sort_key):
+        print(describe(function) + ": " + args.effect + " at " + localEffectMap[function][args.effect])
+        path = []
+        caller = parentMap[function]
+        while caller is not None:
+            path.append(caller)
+            caller = parentMap[caller]
+        for caller in path:
+            print("    called from " + caller)
+elif args.match:
+    matchRe = re.compile(args.match)
+    hits = [f for f in definitionToSourceLocationMap.keys() if matchRe.search(f) and args.effect in viaMap[f]]
+    for function in sorted(hits, key=natural_sort_key):
+        path, sourceLocation = pathToEffect(function, args.effect)
+        print(describe(function) + ": " + args.effect + " at " + sourceLocation)
+        for callee in path[1:]:
+            print("    via " + callee)
+else:
+    with open("loplugin.effectsummary.report", "wt") as f:
+        for function in sorted(definitionToSourceLocationMap.keys(), key=natural_sort_key):
+            if not viaMap[function]:
+                continue
+            summary = []
+            for effect in sorted(viaMap[function].keys()):
+                if viaMap[function][effect] is None:
+                    summary.append(effect)
+                else:
+                    summary.append(effect + " (via " + viaMap[function][effect] + ")")
+            f.write(describe(function) + "\n")
+            f.write("    " + ", ".join(summary) + "\n")
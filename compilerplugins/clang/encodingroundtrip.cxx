@@ -0,0 +1,463 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for OUString <-> OString conversions that are not needed, each of which allocates and
+transcodes the whole string:
+
+(1) a conversion whose result is converted back again, either directly, as in
+        OStringToOUString(OUStringToOString(s, RTL_TEXTENCODING_UTF8), RTL_TEXTENCODING_UTF8)
+    or via a local variable, or via getStr()/getLength() of one; only when both conversions
+    are UTF-8, as a round trip through any other encoding can lose characters;
+
+(2) a conversion whose result is only compared with a string literal, as in
+        OUStringToOString(s, RTL_TEXTENCODING_ASCII_US) == "foo"
+    where the original string can be compared with the literal directly;
+
+(3) a conversion whose result is only used as a key into a map or set, which could be keyed by
+    the original string type instead;
+
+(4) text that is encoded into, or decoded from, an SvMemoryStream just to get it from one
+    string width to the other, as in getTextEngineText/setTextEngineText.
+
+The conversion chain is reported, with the string size where it is evident (a string literal
+or a constant length argument).
+*/
+
+namespace {
+
+struct Conversion
+{
+    bool narrowing; // OUString -> OString
+    const Expr* source;
+    const Expr* length; // may be null
+    std::string encoding;
+};
+
+class EncodingRoundTrip:
+    public RecursiveASTVisitor<EncodingRoundTrip>, public loplugin::Plugin
+{
+public:
+    explicit EncodingRoundTrip(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (compiler.getLangOpts().CPlusPlus) {
+            TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+        }
+    }
+
+    bool VisitCallExpr(const CallExpr*);
+    bool VisitCXXConstructExpr(const CXXConstructExpr*);
+
+private:
+    void check(const Expr* expr, Conversion const & conversion);
+    bool getConversion(const Expr*, Conversion&);
+    const Expr* stripSource(const Expr*);
+    const Stmt* getUse(const Expr*);
+    std::string classifyUse(const Stmt* use, const Expr* value);
+    std::string classifyVarUses(const VarDecl*, const Stmt* body);
+    void findUses(const Stmt*, const VarDecl*, std::vector<const DeclRefExpr*>&);
+    bool isStringLiteral(const Expr*);
+    std::string describe(Conversion const &);
+    std::string sizeOf(Conversion const &);
+    std::string getExprAsString(const Expr*);
+};
+
+bool isOUString(QualType qt)
+{
+    return bool(loplugin::TypeCheck(qt.getNonReferenceType()).Class("OUString").Namespace("rtl").GlobalNamespace());
+}
+
+bool isOString(QualType qt)
+{
+    return bool(loplugin::TypeCheck(qt.getNonReferenceType()).Class("OString").Namespace("rtl").GlobalNamespace());
+}
+
+// the only lossless encoding in either direction
+bool isUtf8(std::string const & encoding)
+{
+    return encoding == "UTF-8" || encoding == "RTL_TEXTENCODING_UTF8";
+}
+
+bool EncodingRoundTrip::VisitCallExpr(const CallExpr* callExpr)
+{
+    if (ignoreLocation(callExpr))
+        return true;
+    Conversion conversion;
+    if (getConversion(callExpr, conversion))
+        check(callExpr, conversion);
+    return true;
+}
+
+bool EncodingRoundTrip::VisitCXXConstructExpr(const CXXConstructExpr* constructExpr)
+{
+    if (ignoreLocation(constructExpr))
+        return true;
+    Conversion conversion;
+    if (getConversion(constructExpr, conversion))
+        check(constructExpr, conversion);
+    return true;
+}
+
+/**
+ * Is the expression one of the conversion functions or constructors?
+ */
+bool EncodingRoundTrip::getConversion(const Expr* expr, Conversion& conversion)
+{
+    expr = expr->IgnoreImplicit();
+    conversion.length = nullptr;
+    if (auto constructExpr = dyn_cast<CXXConstructExpr>(expr))
+    {
+        // OUString(const sal_Char*, sal_Int32, rtl_TextEncoding, ...) and
+        // OString(const sal_Unicode*, sal_Int32, rtl_TextEncoding, ...)
+        if (constructExpr->getNumArgs() < 3)
+            return false;
+        QualType argType = constructExpr->getArg(0)->IgnoreImpCasts()->getType();
+        if (!argType->isPointerType())
+            return false;
+        QualType pointee = argType->getPointeeType();
+        if (isOUString(constructExpr->getType()) && pointee->isAnyCharacterType()
+            && compiler.getASTContext().getTypeSize(pointee) == 8)
+            conversion.narrowing = false;
+        else if (isOString(constructExpr->getType())
+                 && compiler.getASTContext().getTypeSize(pointee) == 16)
+            conversion.narrowing = true;
+        else
+            return false;
+        conversion.source = constructExpr->getArg(0);
+        conversion.length = constructExpr->getArg(1);
+        conversion.encoding = getExprAsString(constructExpr->getArg(2));
+        return true;
+    }
+    auto callExpr = dyn_cast<CallExpr>(expr);
+    if (!callExpr)
+        return false;
+    const FunctionDecl* calleeDecl = callExpr->getDirectCallee();
+    if (!calleeDecl || !calleeDecl->getIdentifier())
+        return false;
+    auto name = calleeDecl->getName();
+    if ((name == "OUStringToOString" || name == "OStringToOUString") && callExpr->getNumArgs() >= 2)
+    {
+        conversion.narrowing = name == "OUStringToOString";
+        conversion.source = callExpr->getArg(0);
+        conversion.encoding = getExprAsString(callExpr->getArg(1));
+        return true;
+    }
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(callExpr))
+    {
+        if (name == "toUtf8" && memberCall->getImplicitObjectArgument()
+            && isOUString(memberCall->getImplicitObjectArgument()->getType()))
+        {
+            conversion.narrowing = true;
+            conversion.source = memberCall->getImplicitObjectArgument();
+            conversion.encoding = "UTF-8";
+            return true;
+        }
+        return false;
+    }
+    if (name == "fromUtf8" && callExpr->getNumArgs() == 1 && isOUString(callExpr->getType()))
+    {
+        conversion.narrowing = false;
+        conversion.source = callExpr->getArg(0);
+        conversion.encoding = "UTF-8";
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Look through the wrapping that does not change the data, like copies and aStr.getStr().
+ */
+const Expr* EncodingRoundTrip::stripSource(const Expr* expr)
+{
+    for (;;)
+    {
+        expr = expr->IgnoreImplicit()->IgnoreParenCasts();
+        if (auto memberCall = dyn_cast<CXXMemberCallExpr>(expr))
+        {
+            const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+            if (methodDecl && methodDecl->getIdentifier() && methodDecl->getName() == "getStr"
+                && memberCall->getImplicitObjectArgument())
+            {
+                expr = memberCall->getImplicitObjectArgument();
+                continue;
+            }
+        }
+        if (auto constructExpr = dyn_cast<CXXConstructExpr>(expr))
+        {
+            if (constructExpr->getNumArgs() == 1 && constructExpr->getConstructor()->isCopyOrMoveConstructor())
+            {
+                expr = constructExpr->getArg(0);
+                continue;
+            }
+        }
+        return expr;
+    }
+}
+
+void EncodingRoundTrip::check(const Expr* expr, Conversion const & conversion)
+{
+    // (1) the source is the result of the opposite conversion
+    const Expr* source = stripSource(conversion.source);
+    Conversion previous;
+    bool bRoundTrip = getConversion(source, previous) && previous.narrowing != conversion.narrowing;
+    if (!bRoundTrip)
+    {
+        auto declRefExpr = dyn_cast<DeclRefExpr>(source);
+        auto varDecl = declRefExpr ? dyn_cast<VarDecl>(declRefExpr->getDecl()) : nullptr;
+        if (varDecl && varDecl->isLocalVarDecl() && varDecl->getInit())
+            bRoundTrip = getConversion(stripSource(varDecl->getInit()), previous)
+                && previous.narrowing != conversion.narrowing;
+    }
+    if (bRoundTrip)
+    {
+        // going through a lossy encoding and back, like ASCII_US or MS_1252, normalizes the
+        // string, and may well be meant to
+        if (!isUtf8(previous.encoding) || !isUtf8(conversion.encoding))
+            return;
+        report(
+            DiagnosticsEngine::Warning,
+            "string is converted back and forth, %0 -> %1%2, keep using the original",
+            expr->getLocStart())
+            << describe(previous) << (conversion.narrowing ? "OString" : "OUString")
+            << sizeOf(previous) << expr->getSourceRange();
+        return;
+    }
+
+    // (4) decoding what was just encoded into a memory stream
+    if (!conversion.narrowing)
+    {
+        if (auto memberCall = dyn_cast<CXXMemberCallExpr>(stripSource(conversion.source)))
+        {
+            const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+            if (methodDecl && methodDecl->getIdentifier() && methodDecl->getName() == "GetData"
+                && loplugin::DeclCheck(methodDecl->getParent()).Class("SvMemoryStream").GlobalNamespace())
+            {
+                report(
+                    DiagnosticsEngine::Warning,
+                    "text is encoded into an SvMemoryStream just to be decoded again as %0, pass the string directly",
+                    expr->getLocStart())
+                    << conversion.encoding << expr->getSourceRange();
+                return;
+            }
+        }
+    }
+
+    // (2), (3), (4) what the result is used for
+    std::string use;
+    const Stmt* user = getUse(expr);
+    if (auto declStmt = dyn_cast_or_null<DeclStmt>(user))
+    {
+        const FunctionDecl* functionDecl = parentFunctionDecl(expr);
+        if (declStmt->isSingleDecl() && functionDecl && functionDecl->getBody())
+            if (auto varDecl = dyn_cast<VarDecl>(declStmt->getSingleDecl()))
+                use = classifyVarUses(varDecl, functionDecl->getBody());
+    }
+    else if (user)
+        use = classifyUse(user, expr);
+    if (use.empty())
+        return;
+    report(
+        DiagnosticsEngine::Warning,
+        "%0%1 is only %2, use the original string",
+        expr->getLocStart())
+        << describe(conversion) << sizeOf(conversion) << use << expr->getSourceRange();
+}
+
+/**
+ * Return the expression consuming the value, or the DeclStmt if it initialises a variable.
+ */
+const Stmt* EncodingRoundTrip::getUse(const Expr* expr)
+{
+    const Stmt* parent = parentStmt(expr);
+    while (parent && (isa<ImplicitCastExpr>(parent) || isa<MaterializeTemporaryExpr>(parent)
+                      || isa<CXXBindTemporaryExpr>(parent) || isa<ExprWithCleanups>(parent)
+                      || isa<ParenExpr>(parent) || isa<CXXFunctionalCastExpr>(parent)
+                      || (isa<CXXConstructExpr>(parent)
+                          && cast<CXXConstructExpr>(parent)->getNumArgs() == 1
+                          && cast<CXXConstructExpr>(parent)->getConstructor()->isCopyOrMoveConstructor())))
+        parent = parentStmt(parent);
+    if (!parent)
+        return nullptr;
+    if (isa<DeclStmt>(parent))
+        return parent;
+    // the object of a member call is reached via a MemberExpr
+    if (isa<MemberExpr>(parent))
+    {
+        const Stmt* grandParent = parentStmt(parent);
+        if (grandParent && isa<CXXMemberCallExpr>(grandParent))
+            return grandParent;
+        return nullptr;
+    }
+    return parent;
+}
+
+/**
+ * Is the use a comparison with a string literal, or a map key?  Return a description if so.
+ */
+std::string EncodingRoundTrip::classifyUse(const Stmt* use, const Expr* value)
+{
+    if (auto opCall = dyn_cast<CXXOperatorCallExpr>(use))
+    {
+        auto op = opCall->getOperator();
+        if ((op == OO_EqualEqual || op == OO_ExclaimEqual || op == OO_Less || op == OO_Greater)
+            && opCall->getNumArgs() == 2
+            && (isStringLiteral(opCall->getArg(0)) || isStringLiteral(opCall->getArg(1))))
+            return "compared against a string literal";
+        if (op == OO_Subscript && opCall->getNumArgs() == 2
+            && stripSource(opCall->getArg(1)) == stripSource(value))
+        {
+            auto const tc = loplugin::TypeCheck(opCall->getArg(0)->getType().getNonReferenceType());
+            if (tc.Class("map").StdNamespace() || tc.Class("unordered_map").StdNamespace())
+                return "used as a map key";
+        }
+        return "";
+    }
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(use))
+    {
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        if (!methodDecl || !methodDecl->getIdentifier())
+            return "";
+        auto name = methodDecl->getName();
+        const Expr* object = memberCall->getImplicitObjectArgument();
+        bool bValueIsObject = object && stripSource(object) == stripSource(value);
+        if (name == "equals" || name == "equalsL" || name == "equalsAscii" || name == "equalsAsciiL"
+            || name == "equalsIgnoreAsciiCase" || name == "startsWith" || name == "endsWith"
+            || name == "compareTo" || name == "match")
+        {
+            if (memberCall->getNumArgs() >= 1
+                && (isStringLiteral(memberCall->getArg(0))
+                    || (!bValueIsObject && object && isStringLiteral(object))))
+                return "compared against a string literal";
+            return "";
+        }
+        if ((name == "find" || name == "count" || name == "insert" || name == "emplace" || name == "erase")
+            && !bValueIsObject && object && memberCall->getNumArgs() >= 1)
+        {
+            auto const tc = loplugin::TypeCheck(object->getType().getNonReferenceType());
+            if (tc.Class("map").StdNamespace() || tc.Class("unordered_map").StdNamespace()
+                || tc.Class("set").StdNamespace() || tc.Class("unordered_set").StdNamespace())
+                return "used as a map key";
+        }
+        if (name == "getStr" && bValueIsObject)
+        {
+            // OUStringToOString(...).getStr() passed to an SvMemoryStream
+            const Stmt* parent = parentStmt(memberCall);
+            while (parent && (isa<ImplicitCastExpr>(parent) || isa<CXXConstCastExpr>(parent)
+                              || isa<ParenExpr>(parent)))
+                parent = parentStmt(parent);
+            if (auto constructExpr = dyn_cast_or_null<CXXConstructExpr>(parent))
+                if (loplugin::TypeCheck(constructExpr->getType()).Class("SvMemoryStream").GlobalNamespace())
+                    return "wrapped into an SvMemoryStream to be decoded again";
+        }
+    }
+    return "";
+}
+
+/**
+ * Classify a local variable initialised by a conversion by all its uses; they must all be
+ * of the same kind.
+ */
+std::string EncodingRoundTrip::classifyVarUses(const VarDecl* varDecl, const Stmt* body)
+{
+    std::vector<const DeclRefExpr*> uses;
+    findUses(body, varDecl, uses);
+    std::string result;
+    for (const DeclRefExpr* declRefExpr : uses)
+    {
+        const Stmt* user = getUse(declRefExpr);
+        if (!user || isa<DeclStmt>(user))
+            return "";
+        std::string use = classifyUse(user, declRefExpr);
+        if (use.empty())
+        {
+            // aUTF8Str.getLength() next to aUTF8Str.getStr() for the stream is fine
+            auto memberCall = dyn_cast<CXXMemberCallExpr>(user);
+            if (memberCall && memberCall->getMethodDecl()
+                && memberCall->getMethodDecl()->getIdentifier()
+                && memberCall->getMethodDecl()->getName() == "getLength")
+                continue;
+            return "";
+        }
+        if (!result.empty() && result != use)
+            return "";
+        result = use;
+    }
+    return result;
+}
+
+void EncodingRoundTrip::findUses(const Stmt* stmt, const VarDecl* varDecl, std::vector<const DeclRefExpr*>& uses)
+{
+    if (auto declRefExpr = dyn_cast<DeclRefExpr>(stmt))
+        if (declRefExpr->getDecl() == varDecl)
+            uses.push_back(declRefExpr);
+    for (const Stmt* child : stmt->children())
+        if (child)
+            findUses(child, varDecl, uses);
+}
+
+bool EncodingRoundTrip::isStringLiteral(const Expr* expr)
+{
+    expr = expr->IgnoreImplicit()->IgnoreParenCasts();
+    if (isa<StringLiteral>(expr))
+        return true;
+    // OUString("foo"), OUStringLiteral("foo")
+    if (auto constructExpr = dyn_cast<CXXConstructExpr>(expr))
+        return constructExpr->getNumArgs() >= 1 && isStringLiteral(constructExpr->getArg(0));
+    return false;
+}
+
+std::string EncodingRoundTrip::describe(Conversion const & conversion)
+{
+    return conversion.narrowing
+        ? "OUString -> OString (" + conversion.encoding + ")"
+        : "OString -> OUString (" + conversion.encoding + ")";
+}
+
+std::string EncodingRoundTrip::sizeOf(Conversion const & conversion)
+{
+    const Expr* source = stripSource(conversion.source);
+    if (auto stringLiteral = dyn_cast<StringLiteral>(source))
+        return ", " + std::to_string(stringLiteral->getLength()) + " characters";
+    if (conversion.length && !conversion.length->isValueDependent())
+    {
+        APSInt x1;
+        if (conversion.length->EvaluateAsInt(x1, compiler.getASTContext()))
+            return ", " + x1.toString(10) + " characters";
+    }
+    return "";
+}
+
+std::string EncodingRoundTrip::getExprAsString(const Expr* expr)
+{
+    SourceManager& SM = compiler.getSourceManager();
+    SourceLocation startLoc = SM.getExpansionLoc(expr->getLocStart());
+    SourceLocation endLoc = SM.getExpansionLoc(expr->getLocEnd());
+    const char *p1 = SM.getCharacterData( startLoc );
+    const char *p2 = SM.getCharacterData( endLoc );
+    if (!p1 || !p2 || (p2 - p1) < 0) {
+        return "?";
+    }
+    unsigned n = Lexer::MeasureTokenLength( endLoc, SM, compiler.getLangOpts());
+    return std::string( p1, p2 - p1 + n);
+}
+
+loplugin::Plugin::Registration< EncodingRoundTrip > X("encodingroundtrip", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
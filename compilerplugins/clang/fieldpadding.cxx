@@ -0,0 +1,321 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "clang/AST/RecordLayout.h"
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for classes whose data members are laid out with holes, like a bool or a sal_Int16
+between two pointers, and that are allocated often, so that reordering the members would
+save memory per instance, and cache lines when walking over many of them.
+
+For each class the plugin takes the record layout the compiler computed, and dumps
+- the size, and the padding, i.e. the bytes not covered by the vtable pointer, the bases
+  and the members
+- the size the class would have with its members sorted by decreasing alignment, and that
+  member order
+
+Classes with bit-fields or virtual bases, unions, and templates are not considered.
+
+It also dumps the places where classes are allocated on the heap (new, std::make_shared,
+std::make_unique, VclPtr<>::Create, VclPtrInstance) outside of templates, and whether that
+happens in a loop, as an estimate of how many instances there are.  The post-processor
+ranks the classes by the bytes a reordering would reclaim times that estimate:
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='fieldpadding' check
+  $ ./compilerplugins/clang/fieldpadding.py
+*/
+
+namespace {
+
+struct MyRecordInfo
+{
+    std::string name;
+    std::string sourceLocation;
+    int64_t size;
+    int64_t alignment;
+    int64_t padding;
+    int64_t optimalSize;
+    std::string optimalOrder;
+};
+bool operator < (const MyRecordInfo &lhs, const MyRecordInfo &rhs)
+{
+    return lhs.name < rhs.name;
+}
+
+struct MyAllocInfo
+{
+    std::string name;
+    std::string sourceLocation;
+    bool inLoop;
+};
+bool operator < (const MyAllocInfo &lhs, const MyAllocInfo &rhs)
+{
+    return std::tie(lhs.sourceLocation, lhs.name)
+         < std::tie(rhs.sourceLocation, rhs.name);
+}
+
+// try to limit the voluminous output a little
+static std::set<MyRecordInfo> recordSet;
+static std::set<MyAllocInfo> allocSet;
+
+int64_t roundUp(int64_t offset, int64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+class FieldPadding:
+    public RecursiveASTVisitor<FieldPadding>, public loplugin::Plugin
+{
+public:
+    explicit FieldPadding(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (!compiler.getLangOpts().CPlusPlus) {
+            return;
+        }
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const MyRecordInfo & s : recordSet)
+            output += "record:\t" + s.name + "\t" + s.sourceLocation + "\t" + std::to_string(s.size)
+                + "\t" + std::to_string(s.alignment) + "\t" + std::to_string(s.padding)
+                + "\t" + std::to_string(s.optimalSize) + "\t" + s.optimalOrder + "\n";
+        for (const MyAllocInfo & s : allocSet)
+            output += "alloc:\t" + s.name + "\t" + s.sourceLocation + "\t" + (s.inLoop ? "loop" : "straight") + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.fieldpadding.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        unsigned saved = 0;
+        std::swap(saved, loopDepth_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        std::swap(saved, loopDepth_);
+        return ret;
+    }
+
+    bool VisitCXXRecordDecl(const CXXRecordDecl*);
+    bool VisitCXXNewExpr(const CXXNewExpr*);
+    bool VisitCallExpr(const CallExpr*);
+    bool VisitCXXConstructExpr(const CXXConstructExpr*);
+
+private:
+    void addAlloc(QualType type, const Stmt* stmt);
+    std::string toString(SourceLocation loc);
+
+    unsigned loopDepth_ = 0;
+};
+
+std::string FieldPadding::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string sourceLocation = std::string(name.substr(strlen(SRCDIR)+1)) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+    normalizeDotDotInFilePath(sourceLocation);
+    return sourceLocation;
+}
+
+bool FieldPadding::VisitCXXRecordDecl(const CXXRecordDecl* recordDecl)
+{
+    if (ignoreLocation(recordDecl) || !recordDecl->isThisDeclarationADefinition()) {
+        return true;
+    }
+    if (recordDecl->isUnion() || recordDecl->isLambda() || recordDecl->isInvalidDecl()
+        || !recordDecl->getIdentifier() || recordDecl->isDependentContext()
+        || isa<ClassTemplateSpecializationDecl>(recordDecl) || recordDecl->getNumVBases() != 0)
+    {
+        return true;
+    }
+    ASTContext& context = compiler.getASTContext();
+    const ASTRecordLayout& layout = context.getASTRecordLayout(recordDecl);
+
+    // what the vtable pointer and the bases take; their own padding is theirs
+    int64_t used = 0;
+    if (layout.hasOwnVFPtr())
+        used += context.toCharUnitsFromBits(context.getTargetInfo().getPointerWidth(0)).getQuantity();
+    for (auto const & base : recordDecl->bases()) {
+        const CXXRecordDecl* baseDecl = base.getType()->getAsCXXRecordDecl();
+        if (!baseDecl || baseDecl->isEmpty())
+            continue;
+        used += context.getASTRecordLayout(baseDecl).getNonVirtualSize().getQuantity();
+    }
+
+    struct Field
+    {
+        std::string name;
+        int64_t size;
+        int64_t alignment;
+    };
+    std::vector<Field> fields;
+    for (const FieldDecl* fieldDecl : recordDecl->fields()) {
+        if (fieldDecl->isBitField())
+            return true;
+        QualType type = fieldDecl->getType();
+        if (type->isIncompleteType())
+            return true;
+        int64_t size, alignment;
+        if (type->isReferenceType()) {
+            size = alignment = context.toCharUnitsFromBits(context.getTargetInfo().getPointerWidth(0)).getQuantity();
+        } else {
+            size = context.getTypeSizeInChars(type).getQuantity();
+            alignment = context.getDeclAlign(fieldDecl).getQuantity();
+        }
+        fields.push_back({fieldDecl->getNameAsString(), size, alignment});
+        used += size;
+    }
+    if (fields.size() < 2) {
+        return true;
+    }
+
+    // the members start where the vtable pointer and the bases end, sort them by decreasing
+    // alignment from there
+    int64_t offset = layout.getFieldOffset(0) / context.getCharWidth();
+    std::stable_sort(fields.begin(), fields.end(),
+        [](const Field& lhs, const Field& rhs) { return lhs.alignment > rhs.alignment; });
+    std::string optimalOrder;
+    for (const Field& field : fields) {
+        offset = roundUp(offset, field.alignment);
+        offset += field.size;
+        if (!optimalOrder.empty())
+            optimalOrder += ",";
+        optimalOrder += field.name;
+    }
+    int64_t alignment = layout.getAlignment().getQuantity();
+    int64_t optimalSize = roundUp(offset, alignment);
+
+    MyRecordInfo aInfo;
+    aInfo.name = recordDecl->getQualifiedNameAsString();
+    aInfo.sourceLocation = toString(recordDecl->getLocation());
+    aInfo.size = layout.getSize().getQuantity();
+    aInfo.alignment = alignment;
+    aInfo.padding = std::max<int64_t>(0, aInfo.size - used);
+    aInfo.optimalSize = std::min(optimalSize, aInfo.size);
+    aInfo.optimalOrder = optimalOrder;
+    recordSet.insert(aInfo);
+    return true;
+}
+
+void FieldPadding::addAlloc(QualType type, const Stmt* stmt)
+{
+    const CXXRecordDecl* recordDecl = type->getAsCXXRecordDecl();
+    if (!recordDecl || !recordDecl->getIdentifier() || isa<ClassTemplateSpecializationDecl>(recordDecl)) {
+        return;
+    }
+    MyAllocInfo aInfo;
+    aInfo.name = recordDecl->getQualifiedNameAsString();
+    aInfo.sourceLocation = toString(stmt->getLocStart());
+    aInfo.inLoop = loopDepth_ != 0;
+    allocSet.insert(aInfo);
+}
+
+bool FieldPadding::VisitCXXNewExpr(const CXXNewExpr* newExpr)
+{
+    if (ignoreLocation(newExpr) || newExpr->getNumPlacementArgs() != 0) {
+        return true;
+    }
+    addAlloc(newExpr->getAllocatedType(), newExpr);
+    return true;
+}
+
+bool FieldPadding::VisitCallExpr(const CallExpr* callExpr)
+{
+    if (ignoreLocation(callExpr)) {
+        return true;
+    }
+    const FunctionDecl* functionDecl = callExpr->getDirectCallee();
+    if (!functionDecl) {
+        return true;
+    }
+    auto const dc = loplugin::DeclCheck(functionDecl);
+    if (dc.Function("make_shared").StdNamespace() || dc.Function("make_unique").StdNamespace()
+        || dc.Function("make_unique").Namespace("o3tl").GlobalNamespace())
+    {
+        // these have the new inside std, where it is ignored
+        auto const templateArgs = functionDecl->getTemplateSpecializationArgs();
+        if (templateArgs && templateArgs->size() != 0 && templateArgs->get(0).getKind() == TemplateArgument::Type)
+            addAlloc(templateArgs->get(0).getAsType(), callExpr);
+    }
+    else if (dc.Function("Create").Class("VclPtr").GlobalNamespace())
+    {
+        // the new is in the header, count the callers instead
+        auto const spec = dyn_cast<ClassTemplateSpecializationDecl>(cast<CXXMethodDecl>(functionDecl)->getParent());
+        if (spec && spec->getTemplateArgs().size() != 0)
+            addAlloc(spec->getTemplateArgs().get(0).getAsType(), callExpr);
+    }
+    return true;
+}
+
+bool FieldPadding::VisitCXXConstructExpr(const CXXConstructExpr* constructExpr)
+{
+    if (ignoreLocation(constructExpr)) {
+        return true;
+    }
+    auto const spec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(constructExpr->getType()->getAsCXXRecordDecl());
+    if (spec && loplugin::DeclCheck(spec).Class("VclPtrInstance").GlobalNamespace()
+        && spec->getTemplateArgs().size() != 0)
+    {
+        addAlloc(spec->getTemplateArgs().get(0).getAsType(), constructExpr);
+    }
+    return true;
+}
+
+loplugin::Plugin::Registration< FieldPadding > X("fieldpadding", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,51 @@
+#!/usr/bin/python
+
+import io
+import re
+from collections import defaultdict
+
+recordDict = {} # className -> (sourceLocation, size, alignment, padding, optimalSize, optimalOrder)
+allocSiteSet = set() # tuple(className, sourceLocation, inLoop)
+
+with io.open("loplugin.fieldpadding.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "record:":
+            recordDict[tokens[1]] = (tokens[2], int(tokens[3]), int(tokens[4]), int(tokens[5]),
+                                     int(tokens[6]), tokens[7])
+        elif tokens[0] == "alloc:":
+            allocSiteSet.add((tokens[1], tokens[2], tokens[3] == "loop"))
+        else:
+            print( "unknown line: " + line)
+
+# We cannot know how many instances there are, so estimate it from the allocation sites,
+# counting a site inside a loop as if it made ten instances.
+allocDict = defaultdict(lambda: [0, 0]) # className -> [sites, sites in loops]
+for className, sourceLocation, inLoop in allocSiteSet:
+    allocDict[className][0] += 1
+    if inLoop:
+        allocDict[className][1] += 1
+
+def instanceEstimate(className):
+    sites, loopSites = allocDict[className]
+    return sites + 9 * loopSites
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+# only the records where reordering the members gains something
+reclaimableList = [c for c in recordDict.keys() if recordDict[c][1] > recordDict[c][4]]
+reclaimableList.sort(key=natural_sort_key)
+reclaimableList.sort(key=lambda c: (recordDict[c][1] - recordDict[c][4]) * instanceEstimate(c), reverse=True)
+
+with open("loplugin.fieldpadding.report", "wt") as f:
+    for c in reclaimableList:
+        sourceLocation, size, alignment, padding, optimalSize, optimalOrder = recordDict[c]
+        sites, loopSites = allocDict[c]
+        f.write(sourceLocation + "\n")
+        f.write("    " + c + ": " + str(size) + " bytes, " + str(padding) + " of them padding, "
+                + str(optimalSize) + " when reordered; "
+                + str(sites) + " allocation sites, " + str(loopSites) + " in loops\n")
+        f.write("    reorder as: " + optimalOrder.replace(",", ", ") + "\n")
@@ -0,0 +1,300 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "compat.hxx"
+#include "plugin.hxx"
+
+/**
+Look for polymorphic classes that could be marked final, and for virtual methods that could
+be marked final, so that the compiler can turn calls through them into direct calls and
+inline them:
+
+(1) classes with virtual methods that nothing in the build derives from;
+
+(2) virtual methods that no class below the one that declares them overrides, in classes
+    that do have subclasses.
+
+Like mergeclasses, this needs to see the whole tree, so the plugin only dumps facts:
+- the polymorphic classes that are not final yet, with their file
+- the class-subclass relationships
+- the virtual methods, and the methods that something overrides
+- the virtual call sites, with the static type of the object and the method called, and
+  whether they are inside a loop
+
+and the post-processor ranks the candidates by the calls in loops, where an indirect call
+that cannot be inlined costs the most:
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='finalcandidate' check
+  $ ./compilerplugins/clang/finalcandidate.py
+*/
+
+namespace {
+
+struct MyCallInfo
+{
+    std::string staticClass;
+    std::string method;
+    std::string sourceLocation;
+    bool inLoop;
+};
+bool operator < (const MyCallInfo &lhs, const MyCallInfo &rhs)
+{
+    return std::tie(lhs.sourceLocation, lhs.staticClass, lhs.method)
+         < std::tie(rhs.sourceLocation, rhs.staticClass, rhs.method);
+}
+
+// try to limit the voluminous output a little
+static std::map<std::string, std::string> polymorphicMap; // className -> filename
+static std::set<std::pair<std::string, std::string>> childToParentClassSet; // childClassName -> parentClassName
+static std::map<std::string, std::string> virtualMethodMap; // method -> sourceLocation
+static std::set<std::string> overriddenSet;
+// call sites, so that calls in headers count once however many files include them
+static std::set<MyCallInfo> callSet;
+
+bool startsWith(const std::string& rStr, const char* pSubStr) {
+    return rStr.compare(0, strlen(pSubStr), pSubStr) == 0;
+}
+
+bool ignoreClass(const std::string& s)
+{
+    // ignore stuff in the standard library, and UNO stuff we can't touch.
+    return startsWith(s, "rtl::") || startsWith(s, "sal::") || startsWith(s, "com::sun::")
+        || startsWith(s, "std::") || startsWith(s, "boost::");
+}
+
+class FinalCandidate:
+    public RecursiveASTVisitor<FinalCandidate>, public loplugin::Plugin
+{
+public:
+    explicit FinalCandidate(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const std::pair<std::string, std::string> & s : polymorphicMap)
+            output += "polymorphic:\t" + s.first + "\t" + s.second + "\n";
+        for (const std::pair<std::string, std::string> & s : childToParentClassSet)
+            output += "has-subclass:\t" + s.first + "\t" + s.second + "\n";
+        for (const std::pair<std::string, std::string> & s : virtualMethodMap)
+            output += "virtual:\t" + s.first + "\t" + s.second + "\n";
+        for (const std::string & s : overriddenSet)
+            output += "overridden:\t" + s + "\n";
+        for (const MyCallInfo & s : callSet)
+            output += "call:\t" + s.staticClass + "\t" + s.method + "\t" + s.sourceLocation
+                + "\t" + (s.inLoop ? "loop" : "straight") + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.finalcandidate.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool shouldVisitTemplateInstantiations () const { return true; }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        unsigned saved = 0;
+        std::swap(saved, loopDepth_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        std::swap(saved, loopDepth_);
+        return ret;
+    }
+
+    bool VisitCXXRecordDecl(const CXXRecordDecl*);
+    bool VisitCXXMethodDecl(const CXXMethodDecl*);
+    bool VisitCXXMemberCallExpr(const CXXMemberCallExpr*);
+
+private:
+    std::string className(const CXXRecordDecl*);
+    std::string methodName(const CXXMethodDecl*);
+    std::string toString(SourceLocation loc);
+
+    unsigned loopDepth_ = 0;
+};
+
+std::string FinalCandidate::className(const CXXRecordDecl* recordDecl)
+{
+    // all instantiations of a template stand for the template
+    if (auto const spec = dyn_cast<ClassTemplateSpecializationDecl>(recordDecl))
+        recordDecl = spec->getSpecializedTemplate()->getTemplatedDecl();
+    return recordDecl->getQualifiedNameAsString();
+}
+
+std::string FinalCandidate::methodName(const CXXMethodDecl* methodDecl)
+{
+    if (methodDecl->getInstantiatedFromMemberFunction())
+        methodDecl = cast<CXXMethodDecl>(methodDecl->getInstantiatedFromMemberFunction());
+
+    std::string s = className(methodDecl->getParent()) + "::" + methodDecl->getNameAsString() + "(";
+    bool bFirst = true;
+    for (const ParmVarDecl *pParmVarDecl : compat::parameters(*methodDecl)) {
+        if (bFirst)
+            bFirst = false;
+        else
+            s += ",";
+        s += pParmVarDecl->getType().getCanonicalType().getAsString();
+    }
+    s += ")";
+    if (methodDecl->isConst())
+        s += " const";
+    return s;
+}
+
+std::string FinalCandidate::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string sourceLocation = std::string(name.substr(strlen(SRCDIR)+1)) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+    normalizeDotDotInFilePath(sourceLocation);
+    return sourceLocation;
+}
+
+bool FinalCandidate::VisitCXXRecordDecl(const CXXRecordDecl* decl)
+{
+    if (ignoreLocation(decl) || !decl->isThisDeclarationADefinition()) {
+        return true;
+    }
+    std::string const s = className(decl);
+    if (ignoreClass(s)) {
+        return true;
+    }
+
+    // the subclasses count wherever they are, even if the class itself cannot be changed
+    for (auto it = decl->bases_begin(); it != decl->bases_end(); ++it)
+    {
+        const CXXRecordDecl* baseDecl = it->getType()->getAsCXXRecordDecl();
+        if (!baseDecl) {
+            // a dependent base; its instantiations are seen again
+            continue;
+        }
+        childToParentClassSet.emplace(s, className(baseDecl));
+    }
+
+    if (decl->isDynamicClass() && !decl->hasAttr<FinalAttr>() && !decl->isLambda())
+    {
+        SourceLocation spellingLocation = compiler.getSourceManager().getSpellingLoc(decl->getCanonicalDecl()->getLocStart());
+        std::string filename = compiler.getSourceManager().getFilename(spellingLocation);
+        filename = filename.substr(strlen(SRCDIR) + 1);
+        normalizeDotDotInFilePath(filename);
+        polymorphicMap.emplace(s, filename);
+    }
+    return true;
+}
+
+bool FinalCandidate::VisitCXXMethodDecl(const CXXMethodDecl* methodDecl)
+{
+    if (ignoreLocation(methodDecl) || !methodDecl->isVirtual()) {
+        return true;
+    }
+    std::string const s = methodName(methodDecl);
+
+    for (auto it = methodDecl->begin_overridden_methods(); it != methodDecl->end_overridden_methods(); ++it)
+        overriddenSet.insert(methodName(*it));
+
+    // only the methods that are candidates; pure ones are overridden wherever it matters
+    if (methodDecl->isPure() || isa<CXXDestructorDecl>(methodDecl) || methodDecl->hasAttr<FinalAttr>()
+        || methodDecl->getParent()->hasAttr<FinalAttr>())
+    {
+        return true;
+    }
+    if (ignoreClass(className(methodDecl->getParent()))) {
+        return true;
+    }
+    if (methodDecl->isThisDeclarationADefinition() || methodDecl == methodDecl->getCanonicalDecl())
+        virtualMethodMap.emplace(s, toString(methodDecl->getCanonicalDecl()->getLocation()));
+    return true;
+}
+
+bool FinalCandidate::VisitCXXMemberCallExpr(const CXXMemberCallExpr* callExpr)
+{
+    if (ignoreLocation(callExpr)) {
+        return true;
+    }
+    const CXXMethodDecl* methodDecl = callExpr->getMethodDecl();
+    if (!methodDecl || !methodDecl->isVirtual()) {
+        return true;
+    }
+    // a qualified call, like Base::foo(), is direct already
+    if (auto const memberExpr = dyn_cast<MemberExpr>(callExpr->getCallee()->IgnoreParens())) {
+        if (memberExpr->hasQualifier()) {
+            return true;
+        }
+    }
+    const Expr* object = callExpr->getImplicitObjectArgument();
+    if (!object) {
+        return true;
+    }
+    QualType type = object->getType();
+    if (type->isPointerType())
+        type = type->getPointeeType();
+    const CXXRecordDecl* recordDecl = type->getAsCXXRecordDecl();
+    if (!recordDecl) {
+        return true;
+    }
+    std::string const staticClass = className(recordDecl);
+    if (ignoreClass(staticClass)) {
+        return true;
+    }
+    MyCallInfo aInfo;
+    aInfo.staticClass = staticClass;
+    aInfo.method = methodName(methodDecl);
+    aInfo.sourceLocation = toString(callExpr->getLocStart());
+    aInfo.inLoop = loopDepth_ != 0;
+    callSet.insert(aInfo);
+    return true;
+}
+
+loplugin::Plugin::Registration< FinalCandidate > X("finalcandidate", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
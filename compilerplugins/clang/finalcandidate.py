@@ -0,0 +1,71 @@
+#!/usr/bin/python
+
+import io
+import re
+from collections import defaultdict
+
+polymorphicToFileDict = {} # className -> filename
+parentChildDict = defaultdict(set)
+virtualMethodDict = {} # method -> sourceLocation
+overriddenSet = set()
+callSiteSet = set() # tuple(staticClass, method, sourceLocation, inLoop)
+
+with io.open("loplugin.finalcandidate.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "polymorphic:":
+            polymorphicToFileDict[tokens[1]] = tokens[2]
+        elif tokens[0] == "has-subclass:":
+            parentChildDict[tokens[2]].add(tokens[1])
+        elif tokens[0] == "virtual:":
+            virtualMethodDict[tokens[1]] = tokens[2]
+        elif tokens[0] == "overridden:":
+            overriddenSet.add(tokens[1])
+        elif tokens[0] == "call:":
+            callSiteSet.add((tokens[1], tokens[2], tokens[3], tokens[4] == "loop"))
+        else:
+            print( "unknown line: " + line)
+
+# call sites counted by the static type of the object, and by the method called
+classCallsDict = defaultdict(lambda: [0, 0]) # className -> [inLoop, total]
+methodCallsDict = defaultdict(lambda: [0, 0]) # method -> [inLoop, total]
+for staticClass, method, sourceLocation, inLoop in callSiteSet:
+    for d, key in ((classCallsDict, staticClass), (methodCallsDict, method)):
+        d[key][1] += 1
+        if inLoop:
+            d[key][0] += 1
+
+def methodClass(method):
+    # the parameters may contain "::" too
+    name = method[:method.find("(")]
+    return name[:name.rfind("::")]
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+# (1) classes nothing derives from
+classList = [c for c in polymorphicToFileDict.keys() if c not in parentChildDict]
+classList.sort(key=natural_sort_key)
+# most calls in loops first, then most calls
+classList.sort(key=lambda c: classCallsDict[c], reverse=True)
+
+# (2) methods nothing overrides, in classes that are derived from; in classes that can be
+# final as a whole, marking the class is enough
+methodList = [m for m in virtualMethodDict.keys()
+              if m not in overriddenSet and methodClass(m) in parentChildDict]
+methodList.sort(key=natural_sort_key)
+methodList.sort(key=lambda m: methodCallsDict[m], reverse=True)
+
+with open("loplugin.finalcandidate.report", "wt") as f:
+    f.write("classes that could be final:\n")
+    for c in classList:
+        calls = classCallsDict[c]
+        f.write(polymorphicToFileDict[c] + "\n")
+        f.write("    " + c + ": " + str(calls[0]) + " virtual calls in loops, " + str(calls[1]) + " in all\n")
+    f.write("\nmethods that could be final:\n")
+    for m in methodList:
+        calls = methodCallsDict[m]
+        f.write(virtualMethodDict[m] + "\n")
+        f.write("    " + m + ": " + str(calls[0]) + " calls in loops, " + str(calls[1]) + " in all\n")
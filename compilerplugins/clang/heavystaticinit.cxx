@@ -0,0 +1,243 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <set>
+#include <string>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for namespace-scope and class-static variables that are initialized by running code
+when their library is loaded, like
+
+    static const OUString aNames[] = { "First", "Second" };
+    static std::map<OUString, sal_Int32> aMap = { { "a", 1 }, { "b", 2 } };
+    static Foo& rFoo = theFoo::get();
+
+Every process that loads the library pays for these, whether it uses the feature or not.
+Function-local statics are initialized on first use, and are not considered.
+
+For each such variable the plugin estimates the cost of the initialization from what its
+initializer does: the constructors that are not trivial, the function calls, the heap
+allocations (operator new, strings and containers built from something, std::make_shared,
+...), and the number of elements of initializer lists, which are one allocation each
+for node based containers.  Initializers that call the get() of an rtl::Static, which is
+meant to be initialized lazily, are marked as such.
+
+The facts are dumped together with the file that is being compiled, so that the
+post-processor can attribute them to the library the file belongs to, and rank both the
+libraries and the variables:
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='heavystaticinit' check
+  $ ./compilerplugins/clang/heavystaticinit.py
+*/
+
+namespace {
+
+struct MyStaticInfo
+{
+    std::string compiledFile;
+    std::string sourceLocation;
+    std::string name;
+    std::string type;
+    unsigned constructors = 0;
+    unsigned calls = 0;
+    unsigned allocations = 0;
+    unsigned elements = 0;
+    bool forcesLazyStatic = false;
+};
+bool operator < (const MyStaticInfo &lhs, const MyStaticInfo &rhs)
+{
+    return std::tie(lhs.compiledFile, lhs.sourceLocation, lhs.name)
+         < std::tie(rhs.compiledFile, rhs.sourceLocation, rhs.name);
+}
+
+// try to limit the voluminous output a little
+static std::set<MyStaticInfo> staticSet;
+
+bool isRtlStatic(const CXXRecordDecl* recordDecl)
+{
+    if (!recordDecl || !recordDecl->hasDefinition())
+        return false;
+    auto const isStatic = [](const CXXRecordDecl* decl) {
+        auto const dc = loplugin::DeclCheck(decl);
+        return bool(dc.Class("Static").Namespace("rtl").GlobalNamespace()
+            || dc.Class("StaticWithInit").Namespace("rtl").GlobalNamespace()
+            || dc.Class("StaticAggregate").Namespace("rtl").GlobalNamespace()
+            || dc.Class("StaticWithArg").Namespace("rtl").GlobalNamespace());
+    };
+    if (isStatic(recordDecl))
+        return true;
+    for (auto const & base : recordDecl->bases()) {
+        if (isRtlStatic(base.getType()->getAsCXXRecordDecl()))
+            return true;
+    }
+    return false;
+}
+
+bool isAllocatingType(QualType type)
+{
+    auto const tc = loplugin::TypeCheck(type);
+    if (tc.Class("OUString").Namespace("rtl").GlobalNamespace()
+        || tc.Class("OString").Namespace("rtl").GlobalNamespace()
+        || tc.Class("OUStringBuffer").Namespace("rtl").GlobalNamespace()
+        || tc.Class("Sequence").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace()
+        || tc.Class("Any").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace())
+    {
+        return true;
+    }
+    const CXXRecordDecl* recordDecl = type->getAsCXXRecordDecl();
+    if (!recordDecl)
+        return false;
+    auto const dc = loplugin::DeclCheck(recordDecl);
+    return dc.Class("vector").StdNamespace() || dc.Class("deque").StdNamespace()
+        || dc.Class("list").StdNamespace() || dc.Class("map").StdNamespace()
+        || dc.Class("multimap").StdNamespace() || dc.Class("set").StdNamespace()
+        || dc.Class("unordered_map").StdNamespace() || dc.Class("unordered_set").StdNamespace()
+        || dc.Class("basic_string").StdNamespace();
+}
+
+class HeavyStaticInit:
+    public RecursiveASTVisitor<HeavyStaticInit>, public loplugin::Plugin
+{
+public:
+    explicit HeavyStaticInit(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (!compiler.getLangOpts().CPlusPlus) {
+            return;
+        }
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const MyStaticInfo & s : staticSet)
+            output += "static:\t" + s.compiledFile + "\t" + s.sourceLocation + "\t" + s.name
+                + "\t" + s.type + "\t" + std::to_string(s.constructors) + "\t" + std::to_string(s.calls)
+                + "\t" + std::to_string(s.allocations) + "\t" + std::to_string(s.elements)
+                + "\t" + (s.forcesLazyStatic ? "forces-rtl-static" : "-") + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.heavystaticinit.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool VisitVarDecl(const VarDecl*);
+
+private:
+    void estimate(const Stmt* stmt, MyStaticInfo& rInfo);
+    std::string toString(SourceLocation loc);
+    std::string fileName(SourceLocation loc);
+};
+
+std::string HeavyStaticInit::fileName(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    if (!name.startswith(SRCDIR "/"))
+        return name.str();
+    std::string s = name.substr(strlen(SRCDIR)+1);
+    normalizeDotDotInFilePath(s);
+    return s;
+}
+
+std::string HeavyStaticInit::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    return fileName(loc) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+}
+
+void HeavyStaticInit::estimate(const Stmt* stmt, MyStaticInfo& rInfo)
+{
+    if (!stmt)
+        return;
+
+    if (auto const constructExpr = dyn_cast<CXXConstructExpr>(stmt)) {
+        if (!constructExpr->getConstructor()->isTrivial()) {
+            ++rInfo.constructors;
+            // built from something, a default constructed string or container is free
+            if (constructExpr->getNumArgs() != 0 && isAllocatingType(constructExpr->getType()))
+                ++rInfo.allocations;
+        }
+    } else if (auto const newExpr = dyn_cast<CXXNewExpr>(stmt)) {
+        if (newExpr->getNumPlacementArgs() == 0)
+            ++rInfo.allocations;
+    } else if (auto const initList = dyn_cast<CXXStdInitializerListExpr>(stmt)) {
+        if (auto const inits = dyn_cast<InitListExpr>(initList->getSubExpr()->IgnoreImplicit()))
+            rInfo.elements += inits->getNumInits();
+    } else if (auto const callExpr = dyn_cast<CallExpr>(stmt)) {
+        ++rInfo.calls;
+        if (const FunctionDecl* callee = callExpr->getDirectCallee()) {
+            auto const dc = loplugin::DeclCheck(callee);
+            if (dc.Function("make_shared").StdNamespace() || dc.Function("make_unique").StdNamespace()
+                || dc.Function("make_unique").Namespace("o3tl").GlobalNamespace())
+            {
+                ++rInfo.allocations;
+            }
+            if (auto const methodDecl = dyn_cast<CXXMethodDecl>(callee)) {
+                if (methodDecl->getName() == "get" && isRtlStatic(methodDecl->getParent()))
+                    rInfo.forcesLazyStatic = true;
+            }
+        }
+    }
+
+    for (const Stmt* child : stmt->children())
+        estimate(child, rInfo);
+}
+
+bool HeavyStaticInit::VisitVarDecl(const VarDecl* varDecl)
+{
+    if (ignoreLocation(varDecl)) {
+        return true;
+    }
+    // function-local statics are lazy already
+    if (!varDecl->hasGlobalStorage() || varDecl->isStaticLocal()) {
+        return true;
+    }
+    if (varDecl->isThisDeclarationADefinition() != VarDecl::Definition || varDecl->isConstexpr()) {
+        return true;
+    }
+    if (varDecl->getDeclContext()->isDependentContext() || varDecl->getType()->isDependentType()) {
+        return true;
+    }
+    if (varDecl->getTemplateSpecializationKind() != TSK_Undeclared) {
+        return true;
+    }
+    const Expr* init = varDecl->getInit();
+    if (!init) {
+        return true;
+    }
+    // constant initialization happens at compile time
+    if (init->isConstantInitializer(compiler.getASTContext(), varDecl->getType()->isReferenceType())) {
+        return true;
+    }
+
+    MyStaticInfo aInfo;
+    aInfo.compiledFile = fileName(compiler.getSourceManager().getLocForStartOfFile(compiler.getSourceManager().getMainFileID()));
+    aInfo.sourceLocation = toString(varDecl->getLocation());
+    aInfo.name = varDecl->getQualifiedNameAsString();
+    aInfo.type = varDecl->getType().getAsString();
+    // strip tab characters so they don't interfere with the parsing of the log file
+    std::replace(aInfo.type.begin(), aInfo.type.end(), '\t', ' ');
+    estimate(init, aInfo);
+    staticSet.insert(aInfo);
+    return true;
+}
+
+loplugin::Plugin::Registration< HeavyStaticInit > X("heavystaticinit", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
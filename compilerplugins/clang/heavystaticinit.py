@@ -0,0 +1,73 @@
+#!/usr/bin/python
+
+import glob
+import io
+import re
+from collections import defaultdict
+
+staticSet = set() # tuple(compiledFile, sourceLocation, name, type, constructors, calls, allocations, elements, forcesLazyStatic)
+
+with io.open("loplugin.heavystaticinit.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "static:":
+            staticSet.add((tokens[1], tokens[2], tokens[3], tokens[4],
+                           int(tokens[5]), int(tokens[6]), int(tokens[7]), int(tokens[8]),
+                           tokens[9] == "forces-rtl-static"))
+        else:
+            print( "unknown line: " + line)
+
+# map the object files listed in the Library_*.mk makefiles to their library
+objectToLibraryMap = dict() # "module/source/foo" -> library
+libraryRe = re.compile(r"gb_Library_add_(?:exception|noexception|generated_exception)_objects,\s*([^,\s]+)\s*,(.*?)\)\)", re.DOTALL)
+for makefile in glob.glob("*/Library_*.mk"):
+    with io.open(makefile, "rb") as f:
+        contents = f.read().decode("utf-8", "replace")
+    for library, objects in libraryRe.findall(contents):
+        for obj in objects.replace("\\", " ").split():
+            objectToLibraryMap[obj] = library
+
+def library(compiledFile):
+    obj = re.sub(r"\.(cxx|cpp|cc|c|mm)$", "", compiledFile)
+    if obj in objectToLibraryMap:
+        return objectToLibraryMap[obj]
+    # not in any library makefile, an executable or a test; charge it to the module
+    return compiledFile.split("/")[0] + " (module)"
+
+# a variable defined in a header is initialized once for every file that includes it, and
+# each of them pays, so count it once per library and file, but not for the same file twice
+libraryStaticsDict = defaultdict(list) # library -> [(score, static)]
+seen = set()
+for s in staticSet:
+    compiledFile, sourceLocation = s[0], s[1]
+    if (compiledFile, sourceLocation) in seen:
+        continue
+    seen.add((compiledFile, sourceLocation))
+    constructors, calls, allocations, elements = s[4], s[5], s[6], s[7]
+    # allocations are what hurts most at startup, so weigh them double
+    score = constructors + calls + 2 * allocations + elements
+    libraryStaticsDict[library(compiledFile)].append((score, s))
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+libraryList = list(libraryStaticsDict.keys())
+libraryList.sort(key=natural_sort_key)
+# most expensive library first
+libraryList.sort(key=lambda l: sum(score for score, s in libraryStaticsDict[l]), reverse=True)
+
+with open("loplugin.heavystaticinit.report", "wt") as f:
+    for lib in libraryList:
+        statics = libraryStaticsDict[lib]
+        statics.sort(key=lambda x: natural_sort_key(x[1][1]))
+        statics.sort(key=lambda x: x[0], reverse=True)
+        f.write(lib + ": " + str(sum(score for score, s in statics)) + " in " + str(len(statics)) + " variables\n")
+        for score, s in statics:
+            f.write("    " + s[1] + "\n")
+            f.write("        " + s[2] + " (" + s[3] + "): " + str(score)
+                    + ", " + str(s[4]) + " constructors, " + str(s[5]) + " calls, "
+                    + str(s[6]) + " allocations, " + str(s[7]) + " elements\n")
+            if s[8]:
+                f.write("        initializes an rtl::Static eagerly, make it a function-local static or use it lazily\n")
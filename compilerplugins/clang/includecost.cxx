@@ -0,0 +1,403 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "compat.hxx"
+#include "plugin.hxx"
+
+#include <clang/Lex/Lexer.h>
+#include <clang/Lex/Preprocessor.h>
+
+/**
+Find out what the headers cost to compile, and how much of them is actually used, to find
+the includes that could be replaced by forward declarations, and the headers that should be
+split.
+
+For each translation unit the plugin records
+- for each header, the number of tokens in it, and the number of declarations in it
+- for each header, the time between entering and leaving it, i.e. the time spent
+  preprocessing, parsing and analysing it, with and without the headers it includes
+  (template instantiations done at the end of the translation unit are not attributed)
+- which file includes which header
+- for each file, the declarations from other headers that it refers to, and whether it
+  only needs them to be declared (a class only used through pointers and references) or
+  defined
+- the same for macros, which count as declarations of the header that defines them (but not
+  empty ones like include guards), and are used when expanded or checked with #ifdef,
+  #ifndef or defined()
+
+Headers outside of SRCDIR and WORKDIR, i.e. system headers, are not considered.
+
+The post-processor adds this up over the whole build, ranks the headers by their cost
+weighted by how little of them is used, and lists the includes in headers that could be
+forward declarations:
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='includecost' check
+  $ ./compilerplugins/clang/includecost.py
+*/
+
+namespace {
+
+struct MyUseInfo
+{
+    std::string file;
+    std::string header;
+    std::string decl;
+    bool complete;
+};
+bool operator < (const MyUseInfo &lhs, const MyUseInfo &rhs)
+{
+    return std::tie(lhs.file, lhs.header, lhs.decl, lhs.complete)
+         < std::tie(rhs.file, rhs.header, rhs.decl, rhs.complete);
+}
+
+struct MyParseInfo
+{
+    std::chrono::steady_clock::duration inclusive = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::duration self = std::chrono::steady_clock::duration::zero();
+};
+
+// try to limit the voluminous output a little
+static std::map<std::string, unsigned> tokenMap; // header -> tokens
+static std::map<std::string, std::set<std::string>> declMap; // header -> declarations
+static std::map<std::string, MyParseInfo> parseMap; // header -> time spent in it
+static std::set<std::pair<std::string, std::string>> includeSet; // includer -> header
+static std::set<MyUseInfo> useSet;
+
+class IncludeCost:
+    public RecursiveASTVisitor<IncludeCost>, public PPCallbacks, public loplugin::Plugin
+{
+public:
+    explicit IncludeCost(InstantiationData const & data): Plugin(data)
+    {
+        compat::addPPCallbacks(compiler.getPreprocessor(), this);
+    }
+
+    virtual void run() override;
+
+    virtual void FileChanged(SourceLocation loc, FileChangeReason reason,
+                             SrcMgr::CharacteristicKind, FileID) override;
+
+    virtual void MacroDefined(const Token& macroToken, const MacroDirective* info) override;
+
+    virtual void MacroExpands(const Token& macroToken, compat::MacroDefinitionParam,
+                              SourceRange, const MacroArgs*) override
+    {
+        addMacroUse(macroToken);
+    }
+
+    virtual void Ifdef(SourceLocation, const Token& macroToken, compat::MacroDefinitionParam) override
+    {
+        addMacroUse(macroToken);
+    }
+
+    virtual void Ifndef(SourceLocation, const Token& macroToken, compat::MacroDefinitionParam) override
+    {
+        addMacroUse(macroToken);
+    }
+
+    virtual void Defined(const Token& macroToken, compat::MacroDefinitionParam, SourceRange) override
+    {
+        addMacroUse(macroToken);
+    }
+
+    enum { isPPCallback = true };
+
+    bool TraversePointerTypeLoc(PointerTypeLoc typeLoc)
+    {
+        ++indirection_;
+        auto const ret = RecursiveASTVisitor::TraversePointerTypeLoc(typeLoc);
+        --indirection_;
+        return ret;
+    }
+
+    bool TraverseLValueReferenceTypeLoc(LValueReferenceTypeLoc typeLoc)
+    {
+        ++indirection_;
+        auto const ret = RecursiveASTVisitor::TraverseLValueReferenceTypeLoc(typeLoc);
+        --indirection_;
+        return ret;
+    }
+
+    bool TraverseRValueReferenceTypeLoc(RValueReferenceTypeLoc typeLoc)
+    {
+        ++indirection_;
+        auto const ret = RecursiveASTVisitor::TraverseRValueReferenceTypeLoc(typeLoc);
+        --indirection_;
+        return ret;
+    }
+
+    bool TraverseTemplateSpecializationTypeLoc(TemplateSpecializationTypeLoc typeLoc)
+    {
+        if (auto const templateDecl = typeLoc.getTypePtr()->getTemplateName().getAsTemplateDecl())
+            addUse(typeLoc.getTemplateNameLoc(), templateDecl, indirection_ == 0);
+        // the template arguments are used by the template, whatever it is used for
+        unsigned saved = 0;
+        std::swap(saved, indirection_);
+        auto const ret = RecursiveASTVisitor::TraverseTemplateSpecializationTypeLoc(typeLoc);
+        std::swap(saved, indirection_);
+        return ret;
+    }
+
+    bool VisitNamedDecl(const NamedDecl*);
+    bool VisitTagTypeLoc(TagTypeLoc);
+    bool VisitTypedefTypeLoc(TypedefTypeLoc);
+    bool VisitDeclRefExpr(const DeclRefExpr*);
+    bool VisitMemberExpr(const MemberExpr*);
+    bool VisitCXXConstructExpr(const CXXConstructExpr*);
+
+private:
+    struct Frame
+    {
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::duration children;
+    };
+
+    std::string fileName(SourceLocation loc);
+    unsigned countTokens(FileID fileID);
+    void addUse(SourceLocation useLoc, const Decl* decl, bool complete);
+    void addMacroUse(const Token& macroToken);
+
+    std::vector<Frame> files_;
+    unsigned indirection_ = 0;
+};
+
+/**
+ * The name of the file loc is in, relative to SRCDIR, or workdir/... for generated headers,
+ * or empty for anything else.
+ */
+std::string IncludeCost::fileName(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string s;
+    // WORKDIR is often in SRCDIR
+    if (name.startswith(WORKDIR "/"))
+        s = "workdir/" + name.substr(strlen(WORKDIR)+1).str();
+    else if (name.startswith(SRCDIR "/"))
+        s = name.substr(strlen(SRCDIR)+1).str();
+    else
+        return "";
+    normalizeDotDotInFilePath(s);
+    return s;
+}
+
+unsigned IncludeCost::countTokens(FileID fileID)
+{
+    SourceManager& sourceManager = compiler.getSourceManager();
+    bool invalid = false;
+    StringRef buffer = sourceManager.getBufferData(fileID, &invalid);
+    if (invalid)
+        return 0;
+    Lexer lexer(sourceManager.getLocForStartOfFile(fileID), compiler.getLangOpts(),
+                buffer.begin(), buffer.begin(), buffer.end());
+    unsigned n = 0;
+    Token token;
+    while (!lexer.LexFromRawLexer(token))
+        ++n;
+    return n;
+}
+
+void IncludeCost::FileChanged(SourceLocation loc, FileChangeReason reason,
+                              SrcMgr::CharacteristicKind, FileID)
+{
+    auto const now = std::chrono::steady_clock::now();
+    if (reason == EnterFile) {
+        std::string name = fileName(loc);
+        if (!name.empty()) {
+            if (!files_.empty() && !files_.back().name.empty())
+                includeSet.emplace(files_.back().name, name);
+            if (tokenMap.find(name) == tokenMap.end())
+                tokenMap[name] = countTokens(compiler.getSourceManager().getFileID(loc));
+        }
+        files_.push_back({name, now, std::chrono::steady_clock::duration::zero()});
+    } else if (reason == ExitFile) {
+        // the main file is never left
+        if (files_.size() < 2)
+            return;
+        Frame frame = files_.back();
+        files_.pop_back();
+        auto const inclusive = now - frame.start;
+        files_.back().children += inclusive;
+        if (!frame.name.empty()) {
+            MyParseInfo& info = parseMap[frame.name];
+            info.inclusive += inclusive;
+            info.self += inclusive - frame.children;
+        }
+    }
+}
+
+void IncludeCost::run()
+{
+    SourceManager& sourceManager = compiler.getSourceManager();
+    std::string mainFile = fileName(sourceManager.getLocForStartOfFile(sourceManager.getMainFileID()));
+    if (mainFile.empty() || !compiler.getLangOpts().CPlusPlus) {
+        return;
+    }
+    TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+    // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+    // writing to the same logfile
+    std::string output;
+    for (const std::pair<std::string, unsigned> & s : tokenMap) {
+        if (s.first == mainFile)
+            continue;
+        auto it = declMap.find(s.first);
+        output += "header:\t" + s.first + "\t" + std::to_string(s.second) + "\t"
+            + std::to_string(it == declMap.end() ? 0 : it->second.size()) + "\n";
+    }
+    for (const std::pair<std::string, MyParseInfo> & s : parseMap)
+        output += "parse:\t" + mainFile + "\t" + s.first + "\t"
+            + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(s.second.inclusive).count()) + "\t"
+            + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(s.second.self).count()) + "\n";
+    for (const std::pair<std::string, std::string> & s : includeSet)
+        output += "include:\t" + s.first + "\t" + s.second + "\n";
+    for (const MyUseInfo & s : useSet)
+        output += "use:\t" + s.file + "\t" + s.header + "\t" + s.decl + "\t"
+            + (s.complete ? "complete" : "incomplete") + "\n";
+    std::ofstream myfile;
+    myfile.open( SRCDIR "/loplugin.includecost.log", std::ios::app | std::ios::out);
+    myfile << output;
+    myfile.close();
+}
+
+/**
+ * Record that the file useLoc is in refers to decl, from some other header.  A class is
+ * attributed to the header that defines it, as that is the one that has to be included
+ * unless a forward declaration does.
+ */
+void IncludeCost::addUse(SourceLocation useLoc, const Decl* decl, bool complete)
+{
+    if (!decl || useLoc.isInvalid()) {
+        return;
+    }
+    auto const namedDecl = dyn_cast<NamedDecl>(decl);
+    if (!namedDecl || !namedDecl->getIdentifier()) {
+        return;
+    }
+    if (auto const tagDecl = dyn_cast<TagDecl>(decl)) {
+        if (auto const definition = tagDecl->getDefinition())
+            decl = definition;
+    } else {
+        decl = decl->getCanonicalDecl();
+    }
+    std::string file = fileName(useLoc);
+    std::string header = fileName(decl->getLocation());
+    if (file.empty() || header.empty() || file == header) {
+        return;
+    }
+    MyUseInfo aInfo;
+    aInfo.file = file;
+    aInfo.header = header;
+    aInfo.decl = namedDecl->getQualifiedNameAsString();
+    aInfo.complete = complete;
+    useSet.insert(aInfo);
+}
+
+void IncludeCost::MacroDefined(const Token& macroToken, const MacroDirective* info)
+{
+    const MacroInfo* macroInfo = info->getMacroInfo();
+    if (!macroInfo || (macroInfo->isObjectLike() && macroInfo->getNumTokens() == 0)) {
+        return;
+    }
+    std::string header = fileName(info->getLocation());
+    if (!header.empty()) {
+        declMap[header].insert(macroToken.getIdentifierInfo()->getName().str());
+    }
+}
+
+/**
+ * Record that the file the macro name is spelled in uses the macro, from the header that
+ * defines it.  Nothing is recorded for a macro that is not defined, as it is not known
+ * which header it is expected from.
+ */
+void IncludeCost::addMacroUse(const Token& macroToken)
+{
+    const MacroInfo* macroInfo = compiler.getPreprocessor().getMacroInfo(macroToken.getIdentifierInfo());
+    if (!macroInfo) {
+        return;
+    }
+    // for a macro expanded in the body of another macro, the file is where that one is defined
+    SourceManager& sourceManager = compiler.getSourceManager();
+    std::string file = fileName(sourceManager.getSpellingLoc(macroToken.getLocation()));
+    std::string header = fileName(macroInfo->getDefinitionLoc());
+    if (file.empty() || header.empty() || file == header) {
+        return;
+    }
+    MyUseInfo aInfo;
+    aInfo.file = file;
+    aInfo.header = header;
+    aInfo.decl = macroToken.getIdentifierInfo()->getName().str();
+    aInfo.complete = true;
+    useSet.insert(aInfo);
+}
+
+bool IncludeCost::VisitNamedDecl(const NamedDecl* namedDecl)
+{
+    // what a header offers, not its parameters and local variables
+    if (namedDecl->isImplicit() || !namedDecl->getIdentifier() || namedDecl->getParentFunctionOrMethod()
+        || isa<ParmVarDecl>(namedDecl) || isa<NamespaceDecl>(namedDecl) || isa<TemplateTypeParmDecl>(namedDecl)
+        || isa<NonTypeTemplateParmDecl>(namedDecl) || isa<TemplateTemplateParmDecl>(namedDecl))
+    {
+        return true;
+    }
+    std::string header = fileName(namedDecl->getLocation());
+    if (!header.empty()) {
+        declMap[header].insert(namedDecl->getQualifiedNameAsString());
+    }
+    return true;
+}
+
+bool IncludeCost::VisitTagTypeLoc(TagTypeLoc typeLoc)
+{
+    // a class only used through pointers and references can be forward declared
+    addUse(typeLoc.getNameLoc(), typeLoc.getDecl(), indirection_ == 0);
+    return true;
+}
+
+bool IncludeCost::VisitTypedefTypeLoc(TypedefTypeLoc typeLoc)
+{
+    addUse(typeLoc.getNameLoc(), typeLoc.getTypedefNameDecl(), true);
+    return true;
+}
+
+bool IncludeCost::VisitDeclRefExpr(const DeclRefExpr* declRefExpr)
+{
+    addUse(declRefExpr->getLocation(), declRefExpr->getDecl(), true);
+    return true;
+}
+
+bool IncludeCost::VisitMemberExpr(const MemberExpr* memberExpr)
+{
+    const ValueDecl* memberDecl = memberExpr->getMemberDecl();
+    addUse(memberExpr->getMemberLoc(), memberDecl, true);
+    // using a member needs the class to be defined
+    addUse(memberExpr->getMemberLoc(), dyn_cast<RecordDecl>(memberDecl->getDeclContext()), true);
+    return true;
+}
+
+bool IncludeCost::VisitCXXConstructExpr(const CXXConstructExpr* constructExpr)
+{
+    addUse(constructExpr->getLocStart(), constructExpr->getConstructor()->getParent(), true);
+    return true;
+}
+
+loplugin::Plugin::Registration< IncludeCost > X("includecost", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,102 @@
+#!/usr/bin/python
+
+import io
+import re
+from collections import defaultdict
+
+headerTokensDict = {} # header -> tokens
+headerDeclsDict = defaultdict(int) # header -> declarations
+translationUnitsDict = defaultdict(set) # header -> translation units that include it
+inclusiveTimeDict = defaultdict(int) # header -> microseconds, with what it includes
+selfTimeDict = defaultdict(int) # header -> microseconds, without what it includes
+includeSet = set() # tuple(includer, header)
+usedDeclsDict = defaultdict(set) # header -> declarations used from other files
+fileUsesDict = defaultdict(dict) # tuple(file, header) -> declaration -> complete
+
+with io.open("loplugin.includecost.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "header:":
+            headerTokensDict[tokens[1]] = int(tokens[2])
+            # a header can declare less in a translation unit that #defines things differently
+            headerDeclsDict[tokens[1]] = max(headerDeclsDict[tokens[1]], int(tokens[3]))
+        elif tokens[0] == "parse:":
+            translationUnitsDict[tokens[2]].add(tokens[1])
+            inclusiveTimeDict[tokens[2]] += int(tokens[3])
+            selfTimeDict[tokens[2]] += int(tokens[4])
+        elif tokens[0] == "include:":
+            includeSet.add((tokens[1], tokens[2]))
+        elif tokens[0] == "use:":
+            usedDeclsDict[tokens[2]].add(tokens[3])
+            uses = fileUsesDict[(tokens[1], tokens[2])]
+            uses[tokens[3]] = uses.get(tokens[3], False) or tokens[4] == "complete"
+        else:
+            print( "unknown line: " + line)
+
+def usedFraction(header):
+    decls = headerDeclsDict[header]
+    if decls == 0:
+        return 1.0
+    return min(1.0, float(len(usedDeclsDict[header])) / decls)
+
+# what including the header costs over the whole build, counting what it includes itself,
+# as that goes away too when the include does
+def cost(header):
+    return inclusiveTimeDict[header]
+
+def isHeader(f):
+    return f.endswith((".hxx", ".h", ".hpp", ".hdl", ".hrc"))
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+# (1) the headers, the most expensive and least used first
+headerList = list(headerTokensDict.keys())
+headerList.sort(key=natural_sort_key)
+headerList.sort(key=lambda h: cost(h) * (1.0 - usedFraction(h)), reverse=True)
+
+# (2) includes in headers where what the header uses from the included one could be forward
+# declared, or where nothing declared in the included header is used directly; what they
+# save is paid again by every translation unit that includes the including header
+forwardList = []
+for includer, header in includeSet:
+    if not isHeader(includer):
+        continue
+    uses = fileUsesDict.get((includer, header), {})
+    if any(uses.values()):
+        continue
+    units = len(translationUnitsDict[includer])
+    if units == 0 or not translationUnitsDict[header]:
+        continue
+    perUnit = float(cost(header)) / len(translationUnitsDict[header])
+    forwardList.append((perUnit * units, includer, header, sorted(uses.keys(), key=natural_sort_key)))
+forwardList.sort(key=lambda x: natural_sort_key(x[1] + " " + x[2]))
+forwardList.sort(key=lambda x: x[0], reverse=True)
+
+# (3) big headers where most of what they declare is used nowhere
+splitList = [h for h in headerList if headerDeclsDict[h] >= 20 and usedFraction(h) < 0.25]
+
+with open("loplugin.includecost.report", "wt") as f:
+    f.write("headers by parse cost weighted by how little of them is used:\n")
+    for h in headerList:
+        f.write(h + "\n")
+        f.write("    " + str(len(translationUnitsDict[h])) + " translation units, "
+                + str(headerTokensDict[h]) + " tokens, "
+                + str(inclusiveTimeDict[h] // 1000) + " ms (" + str(selfTimeDict[h] // 1000) + " ms in itself), "
+                + str(len(usedDeclsDict[h])) + " of " + str(headerDeclsDict[h]) + " declarations used\n")
+    f.write("\nincludes in headers that could be forward declarations:\n")
+    for saved, includer, header, decls in forwardList:
+        f.write(includer + "\n")
+        if decls:
+            f.write("    forward declare " + ", ".join(decls) + " instead of including " + header)
+        else:
+            f.write("    nothing declared in " + header + " itself is used here, the include may not be needed")
+        f.write(" (about " + str(int(saved) // 1000) + " ms over " + str(len(translationUnitsDict[includer]))
+                + " translation units)\n")
+    f.write("\nheaders that could be split:\n")
+    for h in splitList:
+        f.write(h + "\n")
+        f.write("    only " + str(len(usedDeclsDict[h])) + " of " + str(headerDeclsDict[h])
+                + " declarations are used anywhere: " + ", ".join(sorted(usedDeclsDict[h], key=natural_sort_key)) + "\n")
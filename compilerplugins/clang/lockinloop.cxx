@@ -0,0 +1,327 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for mutexes that are acquired and released once per loop iteration:
+
+(1) a guard object (SolarMutexGuard, osl::MutexGuard, osl::Guard<>, osl::ClearableMutexGuard,
+    std::lock_guard, std::unique_lock, ...) constructed in a loop body, on a mutex expression
+    that does not depend on anything declared or modified in the loop, so the guard could be
+    hoisted out of the loop;
+
+(2) calls inside a loop to functions that take a lock themselves, either because their
+    definition is visible and starts with a guard, or because they are listed in
+    lockingFunctions below, where a batch API, or locking once around the loop, would avoid
+    the per-element lock traffic.
+
+Uncontended, each acquire/release pair costs dozens of nanoseconds; under contention it
+causes lock convoys.
+*/
+
+namespace {
+
+// Functions known to lock internally, whose implementation is typically not visible at the
+// call site (UNO interface methods implemented under the SolarMutex or an own mutex).
+char const * const lockingFunctions[] = {
+    "com::sun::star::accessibility::XAccessibleContext::getAccessibleChild",
+    "com::sun::star::accessibility::XAccessibleContext::getAccessibleChildCount",
+    "com::sun::star::accessibility::XAccessibleContext::getAccessibleIndexInParent",
+    "com::sun::star::accessibility::XAccessibleContext::getAccessibleStateSet",
+    "com::sun::star::accessibility::XAccessibleComponent::getBounds",
+    "com::sun::star::animations::XAnimationNode::getBegin",
+    "com::sun::star::animations::XAnimationNode::getDuration",
+    "com::sun::star::animations::XAnimationNode::getUserData",
+    "com::sun::star::animations::XAnimate::getTarget",
+    "com::sun::star::animations::XAnimate::getValues",
+    "com::sun::star::animations::XAnimate::getKeyTimes",
+    "comphelper::OAccessibleContextHelper::NotifyAccessibleEvent",
+    "comphelper::AccessibleEventNotifier::addEvent",
+};
+
+class LockInLoop:
+    public RecursiveASTVisitor<LockInLoop>, public loplugin::Plugin
+{
+public:
+    explicit LockInLoop(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (compiler.getLangOpts().CPlusPlus) {
+            TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+        }
+    }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        std::vector<const Stmt*> saved;
+        saved.swap(loops_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        loops_.swap(saved);
+        return ret;
+    }
+
+    bool VisitVarDecl(const VarDecl*);
+    bool VisitCallExpr(const CallExpr*);
+
+private:
+    bool isDeclaredInLoop(const Decl*);
+    bool dependsOnLoop(const Stmt*);
+    bool isModifiedIn(const Stmt*, const VarDecl*);
+    bool locksInternally(const FunctionDecl*);
+    bool isListedAsLocking(const CXXMethodDecl*);
+
+    std::vector<const Stmt*> loops_;
+    std::map<const FunctionDecl*, bool> lockingCache_;
+    std::set<std::pair<const Stmt*, const FunctionDecl*>> reported_;
+};
+
+bool isGuardType(QualType qt)
+{
+    auto const tc = loplugin::TypeCheck(qt.getNonReferenceType());
+    return tc.Class("SolarMutexGuard").GlobalNamespace()
+        || tc.Class("SolarMutexClearableGuard").GlobalNamespace()
+        || tc.Class("SolarMutexResettableGuard").GlobalNamespace()
+        || tc.Class("Guard").Namespace("osl").GlobalNamespace()
+        || tc.Class("ClearableGuard").Namespace("osl").GlobalNamespace()
+        || tc.Class("ResettableGuard").Namespace("osl").GlobalNamespace()
+        || tc.Class("OExternalLockGuard").GlobalNamespace()
+        || tc.Class("lock_guard").StdNamespace()
+        || tc.Class("unique_lock").StdNamespace();
+}
+
+bool LockInLoop::VisitVarDecl(const VarDecl* varDecl)
+{
+    if (loops_.empty() || ignoreLocation(varDecl) || !varDecl->hasLocalStorage())
+        return true;
+    if (!isGuardType(varDecl->getType()))
+        return true;
+    // the guard must be constructed in the loop body, not e.g. in a ranged-for range
+    if (!isDeclaredInLoop(varDecl))
+        return true;
+    // a guard on the mutex of the current element cannot be hoisted
+    if (varDecl->getInit() && dependsOnLoop(varDecl->getInit()))
+        return true;
+    report(
+        DiagnosticsEngine::Warning,
+        "guard %0 of type %1 is constructed in every iteration of a loop (depth %2) on the same mutex, hoist it out of the loop",
+        varDecl->getLocation())
+        << varDecl->getName() << varDecl->getType().getUnqualifiedType() << unsigned(loops_.size())
+        << varDecl->getSourceRange();
+    report(
+        DiagnosticsEngine::Note, "loop is here", loops_.back()->getLocStart())
+        << loops_.back()->getSourceRange();
+    return true;
+}
+
+bool LockInLoop::VisitCallExpr(const CallExpr* callExpr)
+{
+    if (loops_.empty() || ignoreLocation(callExpr))
+        return true;
+    const FunctionDecl* calleeDecl = callExpr->getDirectCallee();
+    if (!calleeDecl)
+        return true;
+    calleeDecl = calleeDecl->getCanonicalDecl();
+    // the guard itself is reported above
+    if (isa<CXXConstructorDecl>(calleeDecl) || isa<CXXDestructorDecl>(calleeDecl))
+        return true;
+    if (!locksInternally(calleeDecl))
+        return true;
+    if (!reported_.insert({loops_.back(), calleeDecl}).second)
+        return true;
+    report(
+        DiagnosticsEngine::Warning,
+        "%0 takes a lock internally and is called in every iteration of a loop (depth %1), use a batch API or lock once around the loop",
+        callExpr->getLocStart())
+        << calleeDecl << unsigned(loops_.size()) << callExpr->getSourceRange();
+    return true;
+}
+
+bool LockInLoop::isDeclaredInLoop(const Decl* decl)
+{
+    return compiler.getSourceManager().isBeforeInTranslationUnit(
+        loops_.back()->getLocStart(), decl->getLocation());
+}
+
+bool LockInLoop::dependsOnLoop(const Stmt* stmt)
+{
+    if (auto declRefExpr = dyn_cast<DeclRefExpr>(stmt))
+    {
+        auto varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+        if (varDecl && varDecl->hasLocalStorage() && isDeclaredInLoop(varDecl))
+            return true;
+        // e.g. an iterator declared before the loop and advanced in it
+        if (varDecl && isModifiedIn(loops_.back(), varDecl))
+            return true;
+    }
+    for (const Stmt* child : stmt->children())
+        if (child && dependsOnLoop(child))
+            return true;
+    return false;
+}
+
+bool refersTo(const Expr* expr, const VarDecl* varDecl)
+{
+    auto declRefExpr = dyn_cast<DeclRefExpr>(expr->IgnoreParenImpCasts());
+    return declRefExpr && declRefExpr->getDecl() == varDecl;
+}
+
+/**
+ * Is the variable assigned, incremented or decremented, passed by non-const reference, or
+ * the object of a non-const member function call, anywhere in stmt?
+ */
+bool LockInLoop::isModifiedIn(const Stmt* stmt, const VarDecl* varDecl)
+{
+    if (auto unaryOperator = dyn_cast<UnaryOperator>(stmt))
+    {
+        if (unaryOperator->isIncrementDecrementOp() && refersTo(unaryOperator->getSubExpr(), varDecl))
+            return true;
+    }
+    else if (auto binaryOperator = dyn_cast<BinaryOperator>(stmt))
+    {
+        if (binaryOperator->isAssignmentOp() && refersTo(binaryOperator->getLHS(), varDecl))
+            return true;
+    }
+    else if (auto memberCall = dyn_cast<CXXMemberCallExpr>(stmt))
+    {
+        auto methodDecl = memberCall->getMethodDecl();
+        if (methodDecl && !methodDecl->isConst() && memberCall->getImplicitObjectArgument()
+            && refersTo(memberCall->getImplicitObjectArgument(), varDecl))
+            return true;
+    }
+    if (auto callExpr = dyn_cast<CallExpr>(stmt))
+    {
+        // covers ++it, it = ..., it += n for class type iterators, and std::advance(it, n)
+        if (const FunctionDecl* calleeDecl = callExpr->getDirectCallee())
+        {
+            unsigned firstParam = 0;
+            if (isa<CXXOperatorCallExpr>(callExpr) && isa<CXXMethodDecl>(calleeDecl))
+            {
+                if (callExpr->getNumArgs() != 0 && refersTo(callExpr->getArg(0), varDecl)
+                    && !cast<CXXMethodDecl>(calleeDecl)->isConst())
+                    return true;
+                firstParam = 1;
+            }
+            for (unsigned i = firstParam; i < callExpr->getNumArgs(); ++i)
+            {
+                if (i - firstParam >= calleeDecl->getNumParams())
+                    break;
+                QualType paramType = calleeDecl->getParamDecl(i - firstParam)->getType();
+                if (paramType->isReferenceType() && !paramType->getPointeeType().isConstQualified()
+                    && refersTo(callExpr->getArg(i), varDecl))
+                    return true;
+            }
+        }
+    }
+    for (const Stmt* child : stmt->children())
+        if (child && isModifiedIn(child, varDecl))
+            return true;
+    return false;
+}
+
+/**
+ * Does the function lock a mutex itself?  Either it is listed, or its definition is visible
+ * and has a guard at the top level of its body.
+ */
+bool LockInLoop::locksInternally(const FunctionDecl* functionDecl)
+{
+    auto it = lockingCache_.find(functionDecl);
+    if (it != lockingCache_.end())
+        return it->second;
+    bool bLocks = false;
+    if (auto methodDecl = dyn_cast<CXXMethodDecl>(functionDecl))
+        bLocks = isListedAsLocking(methodDecl);
+    else
+    {
+        std::string name = functionDecl->getQualifiedNameAsString();
+        for (char const * p : lockingFunctions)
+            if (name == p)
+                bLocks = true;
+    }
+    const FunctionDecl* definition = nullptr;
+    if (!bLocks && functionDecl->hasBody(definition) && definition)
+    {
+        if (auto compoundStmt = dyn_cast_or_null<CompoundStmt>(definition->getBody()))
+        {
+            for (const Stmt* child : compoundStmt->body())
+            {
+                auto declStmt = dyn_cast<DeclStmt>(child);
+                if (!declStmt)
+                    continue;
+                for (const Decl* decl : declStmt->decls())
+                {
+                    auto varDecl = dyn_cast<VarDecl>(decl);
+                    if (varDecl && isGuardType(varDecl->getType()))
+                        bLocks = true;
+                }
+            }
+        }
+    }
+    lockingCache_[functionDecl] = bLocks;
+    return bLocks;
+}
+
+bool LockInLoop::isListedAsLocking(const CXXMethodDecl* methodDecl)
+{
+    std::string name = methodDecl->getQualifiedNameAsString();
+    for (char const * p : lockingFunctions)
+        if (name == p)
+            return true;
+    for (auto it = methodDecl->begin_overridden_methods(); it != methodDecl->end_overridden_methods(); ++it)
+        if (isListedAsLocking(*it))
+            return true;
+    return false;
+}
+
+loplugin::Plugin::Registration< LockInLoop > X("lockinloop", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
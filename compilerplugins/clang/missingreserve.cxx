@@ -0,0 +1,398 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for loops with a trip count that is known up front, like
+
+    for (sal_Int32 i = 0; i < aNames.getLength(); ++i)
+        aVector.push_back(aNames[i]);
+
+where a local std::vector is grown via push_back/emplace_back, or a local
+css::uno::Sequence is grown via realloc(n + 1), without a preceding reserve()
+or sized construction.  Each iteration may then reallocate and copy the whole
+container.
+
+Only unconditional growth in the innermost loop is considered, and only for
+loops without break/return/goto, so that the bound really is the number of
+elements added.
+
+The plugin warns per translation unit, and also dumps its hits so that they
+can be ranked across the whole tree by loop nesting depth:
+
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='missingreserve' check
+  $ ./compilerplugins/clang/missingreserve.py
+*/
+
+namespace {
+
+struct MyHitInfo
+{
+    unsigned depth;
+    std::string sourceLocation;
+    std::string container;
+    std::string bound;
+};
+bool operator < (const MyHitInfo &lhs, const MyHitInfo &rhs)
+{
+    return std::tie(lhs.sourceLocation, lhs.container)
+         < std::tie(rhs.sourceLocation, rhs.container);
+}
+
+// try to limit the voluminous output a little
+static std::set<MyHitInfo> hitSet;
+
+class MissingReserve:
+    public RecursiveASTVisitor<MissingReserve>, public loplugin::Plugin
+{
+public:
+    explicit MissingReserve(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const MyHitInfo & s : hitSet)
+            output += "hit:\t" + std::to_string(s.depth) + "\t" + s.sourceLocation
+                + "\t" + s.container + "\t" + s.bound + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.missingreserve.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool VisitCXXMemberCallExpr(const CXXMemberCallExpr *);
+
+private:
+    const VarDecl* getGrownContainer(const CXXMemberCallExpr *);
+    std::string getBound(const Stmt* loop, const VarDecl* container);
+    bool isConditional(const Stmt* call, const Stmt* loop);
+    bool hasEarlyExit(const Stmt* stmt);
+    bool hasPriorReserve(const Stmt* stmt, const VarDecl* container, SourceLocation before);
+    bool refersTo(const Stmt* stmt, const VarDecl* var);
+    std::string getExprAsString(SourceRange range);
+    std::string toString(SourceLocation loc);
+
+    std::vector<const Stmt*> loops_;
+    std::set<std::pair<const Stmt*, const VarDecl*>> reported_;
+};
+
+bool isVector(QualType qt)
+{
+    return bool(loplugin::TypeCheck(qt.getNonReferenceType()).Class("vector").StdNamespace());
+}
+
+bool isSequence(QualType qt)
+{
+    return bool(loplugin::TypeCheck(qt.getNonReferenceType()).Class("Sequence").Namespace("uno")
+        .Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace());
+}
+
+bool MissingReserve::VisitCXXMemberCallExpr(const CXXMemberCallExpr* callExpr)
+{
+    if (loops_.empty() || ignoreLocation(callExpr))
+        return true;
+    const VarDecl* varDecl = getGrownContainer(callExpr);
+    if (!varDecl)
+        return true;
+
+    // only interested in growth that belongs to the innermost loop, and a container that survives it
+    const Stmt* loop = loops_.back();
+    if (!compiler.getSourceManager().isBeforeInTranslationUnit(varDecl->getLocation(), loop->getLocStart()))
+        return true;
+    if (reported_.count({loop, varDecl}))
+        return true;
+
+    std::string bound = getBound(loop, varDecl);
+    if (bound.empty())
+        return true;
+    if (isConditional(callExpr, loop) || hasEarlyExit(loop))
+        return true;
+
+    const FunctionDecl* functionDecl = parentFunctionDecl(callExpr);
+    if (!functionDecl || !functionDecl->getBody())
+        return true;
+    if (hasPriorReserve(functionDecl->getBody(), varDecl, loop->getLocStart()))
+        return true;
+
+    reported_.insert({loop, varDecl});
+    report(
+        DiagnosticsEngine::Warning,
+        "%0 grows inside a loop bounded by '%1' without a prior reserve, consider reserving or constructing it with that size",
+        callExpr->getLocStart())
+        << varDecl->getName() << bound << callExpr->getSourceRange();
+    report(
+        DiagnosticsEngine::Note, "loop is here", loop->getLocStart())
+        << loop->getSourceRange();
+
+    MyHitInfo aInfo;
+    aInfo.depth = loops_.size();
+    aInfo.sourceLocation = toString(callExpr->getLocStart());
+    aInfo.container = varDecl->getName();
+    aInfo.bound = bound;
+    hitSet.insert(aInfo);
+    return true;
+}
+
+/**
+ * Return the local container variable that the call appends to, if any.
+ */
+const VarDecl* MissingReserve::getGrownContainer(const CXXMemberCallExpr* callExpr)
+{
+    const CXXMethodDecl* methodDecl = callExpr->getMethodDecl();
+    if (!methodDecl || !methodDecl->getIdentifier())
+        return nullptr;
+    const Expr* object = callExpr->getImplicitObjectArgument();
+    if (!object)
+        return nullptr;
+    auto declRefExpr = dyn_cast<DeclRefExpr>(object->IgnoreParenImpCasts());
+    if (!declRefExpr)
+        return nullptr;
+    auto varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+    if (!varDecl || !varDecl->hasLocalStorage() || isa<ParmVarDecl>(varDecl)
+        || varDecl->getType()->isReferenceType())
+        return nullptr;
+
+    auto name = methodDecl->getName();
+    if (name == "push_back" || name == "emplace_back")
+    {
+        if (!isVector(object->getType()))
+            return nullptr;
+    }
+    else if (name == "realloc")
+    {
+        if (!isSequence(object->getType()) || callExpr->getNumArgs() != 1)
+            return nullptr;
+        // only the aSeq.realloc(n + 1) growth idiom, not a final trim
+        auto binOp = dyn_cast<BinaryOperator>(callExpr->getArg(0)->IgnoreParenImpCasts());
+        if (!binOp || binOp->getOpcode() != BO_Add)
+            return nullptr;
+    }
+    else
+        return nullptr;
+
+    // a container that starts out non-empty or sized is not what we are looking for
+    if (const Expr* init = varDecl->getInit())
+    {
+        auto constructExpr = dyn_cast<CXXConstructExpr>(init->IgnoreImplicit());
+        if (!constructExpr)
+            return nullptr;
+        for (unsigned i = 0; i != constructExpr->getNumArgs(); ++i)
+            if (!isa<CXXDefaultArgExpr>(constructExpr->getArg(i)))
+                return nullptr;
+    }
+    return varDecl;
+}
+
+/**
+ * Return the trip count of the loop, as written, or an empty string if it is not known up front.
+ */
+std::string MissingReserve::getBound(const Stmt* loop, const VarDecl* container)
+{
+    if (auto forRangeStmt = dyn_cast<CXXForRangeStmt>(loop))
+    {
+        const Expr* rangeInit = forRangeStmt->getRangeInit();
+        if (!rangeInit || refersTo(rangeInit, container))
+            return "";
+        return getExprAsString(rangeInit->getSourceRange()) + ".size()";
+    }
+    auto forStmt = dyn_cast<ForStmt>(loop);
+    if (!forStmt || !forStmt->getCond() || !forStmt->getInc())
+        return "";
+    const Expr* cond = forStmt->getCond()->IgnoreParenImpCasts();
+    const Expr* rhs = nullptr;
+    if (auto binOp = dyn_cast<BinaryOperator>(cond))
+    {
+        if (binOp->getOpcode() != BO_LT && binOp->getOpcode() != BO_LE && binOp->getOpcode() != BO_NE)
+            return "";
+        if (!isa<DeclRefExpr>(binOp->getLHS()->IgnoreParenImpCasts()))
+            return "";
+        rhs = binOp->getRHS()->IgnoreParenImpCasts();
+    }
+    else if (auto opCall = dyn_cast<CXXOperatorCallExpr>(cond))
+    {
+        // iterator loops, it != aContainer.end()
+        if ((opCall->getOperator() != OO_ExclaimEqual && opCall->getOperator() != OO_Less)
+            || opCall->getNumArgs() != 2)
+            return "";
+        rhs = opCall->getArg(1)->IgnoreParenImpCasts();
+    }
+    if (!rhs || rhs->isValueDependent() || refersTo(rhs, container))
+        return "";
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(rhs->IgnoreImplicit()))
+    {
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        if (methodDecl && methodDecl->getIdentifier()
+            && (methodDecl->getName() == "end" || methodDecl->getName() == "cend"))
+        {
+            const Expr* object = memberCall->getImplicitObjectArgument();
+            if (!object)
+                return "";
+            return getExprAsString(object->getSourceRange()) + ".size()";
+        }
+    }
+    else if (!rhs->getType()->isIntegralOrEnumerationType())
+        return "";
+    return getExprAsString(rhs->getSourceRange());
+}
+
+bool MissingReserve::isConditional(const Stmt* call, const Stmt* loop)
+{
+    for (const Stmt* parent = parentStmt(call); parent && parent != loop; parent = parentStmt(parent))
+    {
+        if (isa<IfStmt>(parent) || isa<SwitchStmt>(parent) || isa<ConditionalOperator>(parent)
+            || isa<CXXTryStmt>(parent) || isa<LambdaExpr>(parent))
+            return true;
+        if (auto binOp = dyn_cast<BinaryOperator>(parent))
+            if (binOp->getOpcode() == BO_LAnd || binOp->getOpcode() == BO_LOr)
+                return true;
+    }
+    return false;
+}
+
+bool MissingReserve::hasEarlyExit(const Stmt* stmt)
+{
+    for (const Stmt* child : stmt->children())
+    {
+        if (!child)
+            continue;
+        if (isa<BreakStmt>(child) || isa<ContinueStmt>(child) || isa<ReturnStmt>(child)
+            || isa<GotoStmt>(child) || isa<CXXThrowExpr>(child))
+            return true;
+        // break/continue inside these belong to them
+        if (isa<ForStmt>(child) || isa<CXXForRangeStmt>(child) || isa<WhileStmt>(child)
+            || isa<DoStmt>(child) || isa<SwitchStmt>(child) || isa<LambdaExpr>(child))
+            continue;
+        if (hasEarlyExit(child))
+            return true;
+    }
+    return false;
+}
+
+bool MissingReserve::hasPriorReserve(const Stmt* stmt, const VarDecl* container, SourceLocation before)
+{
+    if (!compiler.getSourceManager().isBeforeInTranslationUnit(stmt->getLocStart(), before))
+        return false;
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(stmt))
+    {
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        const Expr* object = memberCall->getImplicitObjectArgument();
+        if (methodDecl && methodDecl->getIdentifier() && object
+            && (methodDecl->getName() == "reserve" || methodDecl->getName() == "resize"
+                || methodDecl->getName() == "realloc" || methodDecl->getName() == "assign"))
+        {
+            auto declRefExpr = dyn_cast<DeclRefExpr>(object->IgnoreParenImpCasts());
+            if (declRefExpr && declRefExpr->getDecl() == container)
+                return true;
+        }
+    }
+    // re-assigned from something else, e.g. aSeq = Sequence<OUString>(n)
+    if (auto opCall = dyn_cast<CXXOperatorCallExpr>(stmt))
+    {
+        if (opCall->getOperator() == OO_Equal && opCall->getNumArgs() == 2)
+        {
+            auto declRefExpr = dyn_cast<DeclRefExpr>(opCall->getArg(0)->IgnoreParenImpCasts());
+            if (declRefExpr && declRefExpr->getDecl() == container)
+                return true;
+        }
+    }
+    for (const Stmt* child : stmt->children())
+        if (child && hasPriorReserve(child, container, before))
+            return true;
+    return false;
+}
+
+bool MissingReserve::refersTo(const Stmt* stmt, const VarDecl* var)
+{
+    if (auto declRefExpr = dyn_cast<DeclRefExpr>(stmt))
+        if (declRefExpr->getDecl() == var)
+            return true;
+    for (const Stmt* child : stmt->children())
+        if (child && refersTo(child, var))
+            return true;
+    return false;
+}
+
+std::string MissingReserve::getExprAsString(SourceRange range)
+{
+    SourceManager& SM = compiler.getSourceManager();
+    SourceLocation startLoc = SM.getExpansionLoc(range.getBegin());
+    SourceLocation endLoc = SM.getExpansionLoc(range.getEnd());
+    const char *p1 = SM.getCharacterData( startLoc );
+    const char *p2 = SM.getCharacterData( endLoc );
+    if (!p1 || !p2 || (p2 - p1) < 0 || (p2 - p1) > 80) {
+        return "?";
+    }
+    unsigned n = Lexer::MeasureTokenLength( endLoc, SM, compiler.getLangOpts());
+    std::string s( p1, p2 - p1 + n);
+    // strip linefeed and tab characters so they don't interfere with the parsing of the log file
+    std::replace( s.begin(), s.end(), '\r', ' ');
+    std::replace( s.begin(), s.end(), '\n', ' ');
+    std::replace( s.begin(), s.end(), '\t', ' ');
+    return s;
+}
+
+std::string MissingReserve::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string sourceLocation = std::string(name.substr(strlen(SRCDIR)+1)) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+    normalizeDotDotInFilePath(sourceLocation);
+    return sourceLocation;
+}
+
+loplugin::Plugin::Registration< MissingReserve > X("missingreserve", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
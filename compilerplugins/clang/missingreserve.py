@@ -0,0 +1,32 @@
+#!/usr/bin/python
+
+import re
+import io
+
+hitSet = set() # set of tuple(depth, sourceLocation, container, bound)
+
+with io.open("loplugin.missingreserve.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "hit:":
+            depth = int(tokens[1])
+            sourceLocation = tokens[2]
+            container = tokens[3]
+            bound = tokens[4]
+            hitSet.add((depth, sourceLocation, container, bound))
+        else:
+            print( "unknown line: " + line)
+
+# sort the results using a "natural order" so sequences like [item1,item2,item10] sort nicely
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+
+# deepest loops first, they multiply the cost of the reallocations
+tmp1list = sorted(hitSet, key=lambda v: natural_sort_key(v[1]))
+tmp1list.sort(key=lambda v: v[0], reverse=True)
+
+with open("loplugin.missingreserve.report", "wt") as f:
+    for v in tmp1list:
+        f.write(v[1] + "\n")
+        f.write("    depth " + str(v[0]) + ": " + v[2] + " grows up to " + v[3] + " times\n")
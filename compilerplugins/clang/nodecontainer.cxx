@@ -0,0 +1,552 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Find std::list, std::map and std::set fields and locals which do not need node-based storage,
+and could use std::vector, a sorted vector (o3tl::sorted_vector) or a bitset instead.
+
+For each container we dump its definition (kind, type, key type and key width), and every use,
+classified as
+    append     - push_back/emplace_back, or insert at end()
+    midinsert  - insert at some other position
+    splice     - splice/merge, which only node-based containers can do cheaply
+    lookup     - find/count/lower_bound/upper_bound/at/[]
+    erase      - erase/remove/remove_if/pop_front
+    iterate    - begin/end/ranged-for
+    stableref  - address of an element taken (&aMap[nKey], &*it, &aList.back(), or of the
+                 reference variable of a ranged-for), which relies on elements never moving
+    escape     - passed, bound or returned by non-const reference or pointer, so we cannot see
+                 the other uses
+and the constant keys it is probed or filled with, so that the density of integer keys can be
+judged.
+Iterator types of a container type that are stored in fields are dumped too, since keeping an
+iterator around across modifications relies on iterator stability.
+
+Then the post-processor classifies each container and recommends a replacement.
+
+The process goes something like this:
+  $ make check
+  $ make FORCE_COMPILE_ALL=1 COMPILER_PLUGIN_TOOL='nodecontainer' check
+  $ ./compilerplugins/clang/nodecontainer.py
+*/
+
+namespace {
+
+struct MyContainerInfo
+{
+    std::string name;
+    std::string kind;
+    std::string type;
+    std::string keyType;
+    std::string keyWidth;
+    std::string sourceLocation;
+};
+bool operator < (const MyContainerInfo &lhs, const MyContainerInfo &rhs)
+{
+    return lhs.name < rhs.name;
+}
+
+struct MyUseInfo
+{
+    std::string name;
+    std::string use;
+    std::string sourceLocation;
+};
+bool operator < (const MyUseInfo &lhs, const MyUseInfo &rhs)
+{
+    return std::tie(lhs.name, lhs.use, lhs.sourceLocation)
+         < std::tie(rhs.name, rhs.use, rhs.sourceLocation);
+}
+
+// try to limit the voluminous output a little
+static std::set<MyContainerInfo> definitionSet;
+static std::set<MyUseInfo> useSet;
+static std::set<std::pair<std::string, std::string>> keySet; // name -> constant key
+static std::set<std::string> storedIteratorSet; // canonical container type
+
+class NodeContainer:
+    public RecursiveASTVisitor<NodeContainer>, public loplugin::Plugin
+{
+public:
+    explicit NodeContainer(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+
+        // dump all our output in one write call - this is to try and limit IO "crosstalk" between multiple processes
+        // writing to the same logfile
+        std::string output;
+        for (const MyContainerInfo & s : definitionSet)
+            output += "defn:\t" + s.name + "\t" + s.kind + "\t" + s.type + "\t" + s.keyType + "\t" + s.keyWidth
+                + "\t" + s.sourceLocation + "\n";
+        for (const MyUseInfo & s : useSet)
+            output += "use:\t" + s.name + "\t" + s.use + "\t" + s.sourceLocation + "\n";
+        for (const std::pair<std::string,std::string> & s : keySet)
+            output += "key:\t" + s.first + "\t" + s.second + "\n";
+        for (const std::string & s : storedIteratorSet)
+            output += "iterfield:\t" + s + "\n";
+        std::ofstream myfile;
+        myfile.open( SRCDIR "/loplugin.nodecontainer.log", std::ios::app | std::ios::out);
+        myfile << output;
+        myfile.close();
+    }
+
+    bool VisitFieldDecl( const FieldDecl* );
+    bool VisitVarDecl( const VarDecl* );
+    bool VisitCXXMemberCallExpr( const CXXMemberCallExpr* );
+    bool VisitCXXOperatorCallExpr( const CXXOperatorCallExpr* );
+    bool VisitCXXForRangeStmt( const CXXForRangeStmt* );
+    bool VisitMemberExpr( const MemberExpr* );
+    bool VisitDeclRefExpr( const DeclRefExpr* );
+    bool VisitUnaryOperator( const UnaryOperator* );
+
+private:
+    std::string containerKind(QualType);
+    void addDefinition(const DeclaratorDecl*, std::string const & name);
+    std::string containerName(const Expr*);
+    std::string elementContainer(const Expr*);
+    std::string niceName(const ValueDecl*);
+    void checkEscape(const Expr*);
+    void addKey(std::string const & name, const Expr*);
+    void addUse(std::string const & name, std::string const & use, const Stmt*);
+    std::string toString(SourceLocation loc);
+
+    // local iterators into, and ranged-for references to elements of, the containers we track
+    std::map<const VarDecl*, std::string> iteratorVars_;
+    std::map<const VarDecl*, std::string> elementVars_;
+};
+
+// std::list::insert(aList.end(), x) converts the iterator to a const_iterator
+const Expr* lookThroughConversion(const Expr* expr)
+{
+    for (;;)
+    {
+        expr = expr->IgnoreImplicit()->IgnoreParens();
+        auto constructExpr = dyn_cast<CXXConstructExpr>(expr);
+        if (!constructExpr || constructExpr->getNumArgs() != 1 || isa<CXXTemporaryObjectExpr>(constructExpr))
+            return expr;
+        expr = constructExpr->getArg(0);
+    }
+}
+
+std::string NodeContainer::containerKind(QualType qt)
+{
+    auto const tc = loplugin::TypeCheck(qt.getNonReferenceType());
+    if (tc.Class("list").StdNamespace())
+        return "list";
+    if (tc.Class("map").StdNamespace())
+        return "map";
+    if (tc.Class("set").StdNamespace())
+        return "set";
+    if (tc.Class("multimap").StdNamespace())
+        return "multimap";
+    if (tc.Class("multiset").StdNamespace())
+        return "multiset";
+    return "";
+}
+
+std::string NodeContainer::niceName(const ValueDecl* decl)
+{
+    if (auto fieldDecl = dyn_cast<FieldDecl>(decl))
+        return fieldDecl->getParent()->getQualifiedNameAsString() + "::" + fieldDecl->getNameAsString();
+    auto varDecl = dyn_cast<VarDecl>(decl);
+    if (varDecl && varDecl->isLocalVarDecl())
+        if (auto functionDecl = dyn_cast_or_null<FunctionDecl>(varDecl->getParentFunctionOrMethod()))
+            return functionDecl->getQualifiedNameAsString() + "::" + varDecl->getNameAsString();
+    return decl->getQualifiedNameAsString();
+}
+
+void NodeContainer::addDefinition(const DeclaratorDecl* decl, std::string const & name)
+{
+    QualType qt = decl->getType();
+    std::string kind = containerKind(qt);
+    if (kind.empty())
+        return;
+    MyContainerInfo aInfo;
+    aInfo.name = name;
+    aInfo.kind = kind;
+    aInfo.type = qt.getNonReferenceType().getUnqualifiedType().getCanonicalType().getAsString();
+    aInfo.keyType = "?";
+    aInfo.keyWidth = "0";
+    auto recordType = qt->getAs<RecordType>();
+    if (auto ctsd = dyn_cast_or_null<ClassTemplateSpecializationDecl>(recordType ? recordType->getDecl() : nullptr))
+    {
+        auto const & args = ctsd->getTemplateArgs();
+        if (args.size() >= 1 && args.get(0).getKind() == TemplateArgument::Type)
+        {
+            QualType keyType = args.get(0).getAsType();
+            aInfo.keyType = keyType.getCanonicalType().getAsString();
+            if (keyType->isIntegralOrEnumerationType() && !keyType->isDependentType())
+                aInfo.keyWidth = std::to_string(compiler.getASTContext().getIntWidth(keyType));
+        }
+    }
+    aInfo.sourceLocation = toString(decl->getLocation());
+    definitionSet.insert(aInfo);
+}
+
+bool NodeContainer::VisitFieldDecl( const FieldDecl* fieldDecl )
+{
+    if (ignoreLocation(fieldDecl))
+        return true;
+    addDefinition(fieldDecl, niceName(fieldDecl));
+
+    // something like std::list<Foo>::iterator maCurrent, which must stay valid across modifications
+    QualType qt = fieldDecl->getType();
+    if (auto elaboratedType = qt->getAs<ElaboratedType>())
+    {
+        NestedNameSpecifier const * qualifier = elaboratedType->getQualifier();
+        if (qualifier && qualifier->getAsType())
+        {
+            QualType containerType(qualifier->getAsType(), 0);
+            if (!containerKind(containerType).empty())
+                storedIteratorSet.insert(containerType.getCanonicalType().getAsString());
+        }
+    }
+    return true;
+}
+
+bool NodeContainer::VisitVarDecl( const VarDecl* varDecl )
+{
+    if (ignoreLocation(varDecl) || isa<ParmVarDecl>(varDecl) || !varDecl->isLocalVarDecl())
+        return true;
+    addDefinition(varDecl, niceName(varDecl));
+
+    // remember the iterators, to follow &*it and &it->maMember
+    if (!varDecl->getInit() || varDecl->getType()->isReferenceType())
+        return true;
+    auto callExpr = dyn_cast<CXXMemberCallExpr>(lookThroughConversion(varDecl->getInit()));
+    if (!callExpr || !callExpr->getMethodDecl() || !callExpr->getMethodDecl()->getIdentifier())
+        return true;
+    std::string name = containerName(callExpr->getImplicitObjectArgument());
+    if (name.empty())
+        return true;
+    auto methodName = callExpr->getMethodDecl()->getName();
+    if (methodName == "begin" || methodName == "end" || methodName == "cbegin" || methodName == "cend"
+        || methodName == "rbegin" || methodName == "rend" || methodName == "find"
+        || methodName == "lower_bound" || methodName == "upper_bound"
+        || (containerKind(callExpr->getImplicitObjectArgument()->getType()) == "list"
+            && (methodName == "insert" || methodName == "emplace" || methodName == "erase")))
+        iteratorVars_[varDecl] = name;
+    return true;
+}
+
+/**
+ * If the expression denotes one of the containers we track, return its name.
+ */
+std::string NodeContainer::containerName(const Expr* expr)
+{
+    if (!expr)
+        return "";
+    expr = expr->IgnoreParenImpCasts();
+    const ValueDecl* decl = nullptr;
+    if (auto memberExpr = dyn_cast<MemberExpr>(expr))
+        decl = dyn_cast<FieldDecl>(memberExpr->getMemberDecl());
+    else if (auto declRefExpr = dyn_cast<DeclRefExpr>(expr))
+    {
+        auto varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl());
+        if (varDecl && varDecl->isLocalVarDecl() && !varDecl->getType()->isReferenceType())
+            decl = varDecl;
+    }
+    if (!decl || containerKind(decl->getType()).empty())
+        return "";
+    return niceName(decl);
+}
+
+/**
+ * If the expression denotes an element of one of the containers we track, or a member of one,
+ * return the name of the container.
+ */
+std::string NodeContainer::elementContainer(const Expr* expr)
+{
+    expr = expr->IgnoreParenImpCasts();
+    if (auto memberExpr = dyn_cast<MemberExpr>(expr))
+    {
+        if (!memberExpr->isArrow())
+            return elementContainer(memberExpr->getBase());
+        // it->maMember
+        expr = memberExpr->getBase()->IgnoreParenImpCasts();
+        auto operatorCall = dyn_cast<CXXOperatorCallExpr>(expr);
+        if (!operatorCall || operatorCall->getOperator() != OO_Arrow)
+            return "";
+        expr = operatorCall->getArg(0)->IgnoreParenImpCasts();
+        auto declRefExpr = dyn_cast<DeclRefExpr>(expr);
+        auto it = declRefExpr ? iteratorVars_.find(dyn_cast<VarDecl>(declRefExpr->getDecl())) : iteratorVars_.end();
+        return it == iteratorVars_.end() ? "" : it->second;
+    }
+    if (auto declRefExpr = dyn_cast<DeclRefExpr>(expr))
+    {
+        auto it = elementVars_.find(dyn_cast<VarDecl>(declRefExpr->getDecl()));
+        return it == elementVars_.end() ? "" : it->second;
+    }
+    if (auto operatorCall = dyn_cast<CXXOperatorCallExpr>(expr))
+    {
+        // aMap[nKey]
+        if (operatorCall->getOperator() == OO_Subscript && operatorCall->getNumArgs() == 2)
+            return containerName(operatorCall->getArg(0));
+        // *it
+        if (operatorCall->getOperator() == OO_Star && operatorCall->getNumArgs() == 1)
+        {
+            auto declRefExpr = dyn_cast<DeclRefExpr>(operatorCall->getArg(0)->IgnoreParenImpCasts());
+            auto it = declRefExpr ? iteratorVars_.find(dyn_cast<VarDecl>(declRefExpr->getDecl())) : iteratorVars_.end();
+            return it == iteratorVars_.end() ? "" : it->second;
+        }
+        return "";
+    }
+    // aList.back()
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(expr))
+    {
+        auto methodDecl = memberCall->getMethodDecl();
+        if (methodDecl && methodDecl->getIdentifier()
+            && (methodDecl->getName() == "front" || methodDecl->getName() == "back" || methodDecl->getName() == "at"))
+            return containerName(memberCall->getImplicitObjectArgument());
+    }
+    return "";
+}
+
+void NodeContainer::addKey(std::string const & name, const Expr* arg)
+{
+    arg = arg->IgnoreParenImpCasts();
+    if (arg->isValueDependent())
+        return;
+    APSInt x1;
+    if (arg->EvaluateAsInt(x1, compiler.getASTContext()))
+        keySet.insert({name, x1.toString(10)});
+}
+
+void NodeContainer::addUse(std::string const & name, std::string const & use, const Stmt* stmt)
+{
+    MyUseInfo aInfo;
+    aInfo.name = name;
+    aInfo.use = use;
+    aInfo.sourceLocation = toString(stmt->getLocStart());
+    useSet.insert(aInfo);
+}
+
+bool NodeContainer::VisitCXXMemberCallExpr( const CXXMemberCallExpr* callExpr )
+{
+    if (ignoreLocation(callExpr))
+        return true;
+    std::string name = containerName(callExpr->getImplicitObjectArgument());
+    if (name.empty())
+        return true;
+    const CXXMethodDecl* methodDecl = callExpr->getMethodDecl();
+    if (!methodDecl || !methodDecl->getIdentifier())
+        return true;
+    auto methodName = methodDecl->getName();
+    std::string use;
+    if (methodName == "push_back" || methodName == "emplace_back")
+        use = "append";
+    else if (methodName == "push_front" || methodName == "emplace_front")
+        use = "midinsert";
+    else if (methodName == "insert" || methodName == "emplace" || methodName == "emplace_hint")
+    {
+        use = "append";
+        // for std::list the first argument is the position, for the associative containers
+        // the key (or a hint)
+        if (containerKind(callExpr->getImplicitObjectArgument()->getType()) == "list")
+        {
+            use = "midinsert";
+            if (callExpr->getNumArgs() >= 1)
+                if (auto posCall = dyn_cast<CXXMemberCallExpr>(lookThroughConversion(callExpr->getArg(0))))
+                    if (posCall->getMethodDecl() && posCall->getMethodDecl()->getIdentifier()
+                        && posCall->getMethodDecl()->getName() == "end")
+                        use = "append";
+        }
+        else if (methodName == "emplace" && callExpr->getNumArgs() >= 1)
+            addKey(name, callExpr->getArg(0));
+        // aSet.insert(nKey)
+        else if (methodName == "insert" && callExpr->getNumArgs() == 1
+                 && containerKind(callExpr->getImplicitObjectArgument()->getType()) == "set")
+            addKey(name, callExpr->getArg(0));
+    }
+    else if (methodName == "splice" || methodName == "merge")
+        use = "splice";
+    else if (methodName == "find" || methodName == "count" || methodName == "lower_bound"
+             || methodName == "upper_bound" || methodName == "equal_range" || methodName == "at")
+    {
+        use = "lookup";
+        if (callExpr->getNumArgs() == 1)
+            addKey(name, callExpr->getArg(0));
+    }
+    else if (methodName == "erase" || methodName == "remove" || methodName == "remove_if"
+             || methodName == "pop_front" || methodName == "pop_back" || methodName == "unique")
+        use = "erase";
+    else if (methodName == "begin" || methodName == "end" || methodName == "cbegin"
+             || methodName == "cend" || methodName == "rbegin" || methodName == "rend")
+        use = "iterate";
+    else if (methodName == "sort")
+        use = "sort";
+    else
+        return true;
+    addUse(name, use, callExpr);
+    return true;
+}
+
+bool NodeContainer::VisitCXXOperatorCallExpr( const CXXOperatorCallExpr* callExpr )
+{
+    if (ignoreLocation(callExpr))
+        return true;
+    if (callExpr->getOperator() != OO_Subscript || callExpr->getNumArgs() != 2)
+        return true;
+    std::string name = containerName(callExpr->getArg(0));
+    if (name.empty())
+        return true;
+    addUse(name, "lookup", callExpr);
+    addKey(name, callExpr->getArg(1));
+    return true;
+}
+
+bool NodeContainer::VisitCXXForRangeStmt( const CXXForRangeStmt* stmt )
+{
+    if (ignoreLocation(stmt))
+        return true;
+    std::string name = containerName(stmt->getRangeInit());
+    if (name.empty())
+        return true;
+    addUse(name, "iterate", stmt);
+    if (stmt->getLoopVariable()->getType()->isReferenceType())
+        elementVars_[stmt->getLoopVariable()] = name;
+    return true;
+}
+
+bool NodeContainer::VisitUnaryOperator( const UnaryOperator* unaryOp )
+{
+    if (ignoreLocation(unaryOp) || unaryOp->getOpcode() != UO_AddrOf)
+        return true;
+    // keeps a pointer into a node
+    std::string name = elementContainer(unaryOp->getSubExpr());
+    if (!name.empty())
+        addUse(name, "stableref", unaryOp);
+    return true;
+}
+
+bool NodeContainer::VisitMemberExpr( const MemberExpr* memberExpr )
+{
+    if (ignoreLocation(memberExpr))
+        return true;
+    checkEscape(memberExpr);
+    return true;
+}
+
+bool NodeContainer::VisitDeclRefExpr( const DeclRefExpr* declRefExpr )
+{
+    if (ignoreLocation(declRefExpr))
+        return true;
+    checkEscape(declRefExpr);
+    return true;
+}
+
+/**
+ * Containers whose address is taken, or which are passed on, bound or returned by non-const
+ * reference, may be modified in ways we cannot see.
+ */
+void NodeContainer::checkEscape(const Expr* expr)
+{
+    std::string name = containerName(expr);
+    if (name.empty())
+        return;
+    const Stmt* child = expr;
+    const Stmt* parent = parentStmt(expr);
+    while (parent && (isa<ImplicitCastExpr>(parent) || isa<ParenExpr>(parent)))
+    {
+        child = parent;
+        parent = parentStmt(parent);
+    }
+    if (!parent)
+        return;
+    if (auto unaryOp = dyn_cast<UnaryOperator>(parent))
+    {
+        if (unaryOp->getOpcode() == UO_AddrOf)
+            addUse(name, "escape", expr);
+        return;
+    }
+    if (isa<CXXMemberCallExpr>(parent) || isa<CXXOperatorCallExpr>(parent))
+        return;
+    // std::list<Foo>& rList = maList;
+    if (auto declStmt = dyn_cast<DeclStmt>(parent))
+    {
+        for (auto decl : declStmt->decls())
+        {
+            auto varDecl = dyn_cast<VarDecl>(decl);
+            if (varDecl && varDecl->getInit() == child && varDecl->getType()->isLValueReferenceType()
+                && !varDecl->getType()->getPointeeType().isConstQualified())
+                addUse(name, "escape", expr);
+        }
+        return;
+    }
+    // std::list<Foo>& getList() { return maList; }
+    if (isa<ReturnStmt>(parent))
+    {
+        auto functionDecl = parentFunctionDecl(parent);
+        if (functionDecl && functionDecl->getReturnType()->isLValueReferenceType()
+            && !functionDecl->getReturnType()->getPointeeType().isConstQualified())
+            addUse(name, "escape", expr);
+        return;
+    }
+    const FunctionDecl* calleeDecl = nullptr;
+    unsigned numArgs = 0;
+    const Expr* const * args = nullptr;
+    if (auto callExpr = dyn_cast<CallExpr>(parent))
+    {
+        calleeDecl = callExpr->getDirectCallee();
+        numArgs = callExpr->getNumArgs();
+        args = callExpr->getArgs();
+    }
+    else if (auto constructExpr = dyn_cast<CXXConstructExpr>(parent))
+    {
+        calleeDecl = constructExpr->getConstructor();
+        numArgs = constructExpr->getNumArgs();
+        args = constructExpr->getArgs();
+    }
+    else
+        return;
+    if (!calleeDecl)
+    {
+        addUse(name, "escape", expr);
+        return;
+    }
+    for (unsigned i = 0; i < numArgs; ++i)
+    {
+        if (args[i] != child)
+            continue;
+        if (i >= calleeDecl->getNumParams()) // can happen with varargs
+            break;
+        QualType qt = calleeDecl->getParamDecl(i)->getType();
+        if ((qt->isReferenceType() || qt->isPointerType())
+            && !qt->getPointeeType().isConstQualified()
+            && !qt->isRValueReferenceType())
+            addUse(name, "escape", expr);
+        break;
+    }
+}
+
+std::string NodeContainer::toString(SourceLocation loc)
+{
+    SourceLocation expansionLoc = compiler.getSourceManager().getExpansionLoc( loc );
+    StringRef name = compiler.getSourceManager().getFilename(expansionLoc);
+    std::string sourceLocation = std::string(name.substr(strlen(SRCDIR)+1)) + ":" + std::to_string(compiler.getSourceManager().getSpellingLineNumber(expansionLoc));
+    normalizeDotDotInFilePath(sourceLocation);
+    return sourceLocation;
+}
+
+loplugin::Plugin::Registration< NodeContainer > X("nodecontainer", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,96 @@
+#!/usr/bin/python
+
+import re
+import io
+
+definitionToKindMap = dict() # name -> (kind, type, keyType, keyWidth)
+definitionToSourceLocationMap = dict()
+useDict = dict() # name -> dict(use -> set of sourceLocation)
+keyDict = dict() # name -> set of int
+storedIteratorSet = set() # container types whose iterators are kept in fields
+
+# clang does not always use exactly the same numbers in the type-parameter vars it generates
+# so I need to substitute them to ensure we can match correctly.
+normalizeTypeParamsRegex = re.compile(r"type-parameter-\d+-\d+")
+def normalizeTypeParams( line ):
+    return normalizeTypeParamsRegex.sub("type-parameter-?-?", line)
+
+with io.open("loplugin.nodecontainer.log", "rb", buffering=1024*1024) as txt:
+    for line in txt:
+        tokens = line.strip().split("\t")
+        if tokens[0] == "defn:":
+            name = normalizeTypeParams(tokens[1])
+            definitionToKindMap[name] = (tokens[2], normalizeTypeParams(tokens[3]), tokens[4], int(tokens[5]))
+            definitionToSourceLocationMap[name] = tokens[6]
+        elif tokens[0] == "use:":
+            name = normalizeTypeParams(tokens[1])
+            use = tokens[2]
+            sourceLocation = tokens[3]
+            useDict.setdefault(name, dict()).setdefault(use, set()).add(sourceLocation)
+        elif tokens[0] == "key:":
+            name = normalizeTypeParams(tokens[1])
+            keyDict.setdefault(name, set()).add(int(tokens[2]))
+        elif tokens[0] == "iterfield:":
+            storedIteratorSet.add(normalizeTypeParams(tokens[1]))
+        else:
+            print( "unknown line: " + line)
+
+def useCount(uses, use):
+    return len(uses.get(use, set()))
+
+def recommend(name):
+    kind, containerType, keyType, keyWidth = definitionToKindMap[name]
+    uses = useDict.get(name, dict())
+    # unused, or only touched in ways we cannot follow
+    if not uses or "escape" in uses:
+        return None
+    # these really need node-based storage
+    if "splice" in uses or "stableref" in uses or containerType in storedIteratorSet:
+        return None
+    if kind == "list":
+        # a handful of mid-sequence inserts are cheap enough on a vector
+        if useCount(uses, "midinsert") > 2:
+            return None
+        return "std::vector (appends " + str(useCount(uses, "append")) \
+            + ", mid inserts " + str(useCount(uses, "midinsert")) + ")"
+    keys = keyDict.get(name, set())
+    # only recommend direct indexing when the observed keys fill most of their range
+    if keyWidth > 0 and (kind == "map" or kind == "set") and len(keys) > 1:
+        density = float(len(keys)) / (max(keys) - min(keys) + 1)
+        if density >= 0.5:
+            keyRange = "constant keys " + str(min(keys)) + ".." + str(max(keys)) \
+                + ", density " + str(int(density * 100)) + "%"
+            if min(keys) != 0:
+                keyRange += ", offset by " + str(min(keys))
+            if kind == "set":
+                return "std::bitset/std::vector<bool> indexed by key (" + keyRange + ")"
+            return "std::vector indexed by key (" + keyRange + ")"
+    # lots of erasing is where the node-based containers shine
+    if useCount(uses, "erase") > 2:
+        return None
+    if kind == "set" or kind == "multiset":
+        return "o3tl::sorted_vector<" + keyType + ">"
+    return "sorted std::vector of pairs (lookups " + str(useCount(uses, "lookup")) + ")"
+
+tmp1list = list()
+for name in definitionToKindMap:
+    sourceLocation = definitionToSourceLocationMap[name]
+    # ignore external code
+    if sourceLocation.startswith("external/"):
+        continue
+    r = recommend(name)
+    if r is None:
+        continue
+    tmp1list.append((sourceLocation, name, definitionToKindMap[name][0], r))
+
+# sort results by filename:lineno
+def natural_sort_key(s, _nsre=re.compile('([0-9]+)')):
+    return [int(text) if text.isdigit() else text.lower()
+            for text in re.split(_nsre, s)]
+tmp1list.sort(key=lambda v: natural_sort_key(v[0]))
+
+with open("compilerplugins/clang/nodecontainer.results", "wt") as f:
+    for v in tmp1list:
+        f.write(v[0] + "\n")
+        f.write("    std::" + v[2] + " " + v[1] + "\n")
+        f.write("    could be " + v[3] + "\n")
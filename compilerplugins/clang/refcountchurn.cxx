@@ -0,0 +1,627 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "plugin.hxx"
+
+/**
+Look for copies of reference counting smart pointers (css::uno::Reference, rtl::Reference,
+VclPtr, std::shared_ptr) that cost an atomic increment and decrement without need:
+
+(1) a local variable copied from an object that outlives it (a variable or a member), that
+    is only read afterwards, like
+
+        for (auto const & rEntry : maEntries)
+        {
+            Reference<XAccessible> xFocused(m_xFocused);
+            if (xFocused.is() && xFocused == rEntry.mxAccessible)
+                return true;
+        }
+
+    where a 'const Reference<XAccessible>&' would do;
+
+(2) a call to a method that returns a member by value, whose result is only compared or
+    tested, like 'if (GetFoo() == xOther)', where the method could return a const reference.
+
+Both are only reported in loop bodies, and in accessors (const methods, and methods whose
+name starts with get, is, has or find), where the traffic adds up.  Copies in ranged-for
+loop variables are already reported by loplugin:rangedforcopy.
+
+A copy from a member is not reported in a method that calls a non-const method on this, nor
+is a copy whose source is modified in the same function, as the copy is then usually meant
+to keep the object alive.  For the same reason copies of container elements are not
+reported, nor copies that live across anything that might drop the source: a call through
+the copy, a call to a non-const method or to a free function, or the release of a guard,
+as in
+
+    Reference<XFoo> xFoo(m_xFoo);
+    aGuard.clear();
+    xFoo->bar();
+*/
+
+namespace {
+
+bool isSmartRef(QualType type)
+{
+    auto const tc = loplugin::TypeCheck(type.getNonReferenceType());
+    return tc.Class("Reference").Namespace("uno").Namespace("star").Namespace("sun").Namespace("com").GlobalNamespace()
+        || tc.Class("Reference").Namespace("rtl").GlobalNamespace()
+        || tc.Class("VclPtr").GlobalNamespace()
+        || tc.Class("shared_ptr").StdNamespace();
+}
+
+bool isAccessor(const FunctionDecl* functionDecl)
+{
+    auto const methodDecl = dyn_cast_or_null<CXXMethodDecl>(functionDecl);
+    if (!methodDecl)
+        return false;
+    if (methodDecl->isConst())
+        return true;
+    if (!methodDecl->getIdentifier())
+        return false;
+    StringRef name = methodDecl->getName();
+    for (char const * prefix : { "get", "Get", "is", "Is", "has", "Has", "find", "Find" })
+        if (name.startswith(prefix))
+            return true;
+    return false;
+}
+
+class RefCountChurn:
+    public RecursiveASTVisitor<RefCountChurn>, public loplugin::Plugin
+{
+public:
+    explicit RefCountChurn(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        if (!compiler.getLangOpts().CPlusPlus) {
+            return;
+        }
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+        reportCopies();
+    }
+
+    bool TraverseFunctionDecl(FunctionDecl*);
+    bool TraverseCXXMethodDecl(CXXMethodDecl*);
+    bool TraverseCXXConstructorDecl(CXXConstructorDecl*);
+    bool TraverseCXXConversionDecl(CXXConversionDecl*);
+    bool TraverseCXXDestructorDecl(CXXDestructorDecl*);
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        if (stmt->getLoopVariable())
+            rangedForVars_.insert(stmt->getLoopVariable());
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        ++loopDepth_;
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        --loopDepth_;
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        unsigned saved = 0;
+        std::swap(saved, loopDepth_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        std::swap(saved, loopDepth_);
+        return ret;
+    }
+
+    bool VisitVarDecl(const VarDecl*);
+    bool VisitDeclRefExpr(const DeclRefExpr*);
+    bool VisitMemberExpr(const MemberExpr*);
+    bool VisitCXXMemberCallExpr(const CXXMemberCallExpr*);
+
+private:
+    struct Copy
+    {
+        const VarDecl* varDecl;
+        const FunctionDecl* functionDecl;
+        const ValueDecl* sourceDecl;
+        unsigned loopDepth;
+    };
+
+    const FunctionDecl* currentFunction() const
+    { return maTraversingFunctions.empty() ? nullptr : maTraversingFunctions.back(); }
+    bool isInteresting() const
+    { return loopDepth_ != 0 || isAccessor(currentFunction()); }
+    bool findSource(const Expr* expr, const Expr*& rootExpr);
+    bool isKeptAlive(const VarDecl* varDecl);
+    bool mayDropSource(const Stmt* stmt, const VarDecl* varDecl, bool nested);
+    bool isReadOnlyUse(const Expr* expr);
+    bool isReadOnlyArgument(const Stmt* callOrConstruct, const Stmt* arg);
+    const MemberExpr* returnedMember(const CXXMethodDecl* methodDecl);
+    bool isOnlyCompared(const Expr* expr);
+    void checkModified(const Expr* expr, const ValueDecl* decl);
+    void reportCopies();
+
+    // I use traverse and a member variable because I cannot find a reliable way of walking back up the AST tree using the parentStmt() stuff
+    std::vector<const FunctionDecl*> maTraversingFunctions;
+    unsigned loopDepth_ = 0;
+    std::set<const VarDecl*> rangedForVars_;
+
+    std::vector<Copy> copies_;
+    std::set<const VarDecl*> copyVars_;
+    std::set<const VarDecl*> writtenVars_;
+    // the sources of the copies, and the expressions through which the copies read them
+    std::set<std::pair<const FunctionDecl*, const ValueDecl*>> sources_;
+    std::set<const Expr*> sourceExprs_;
+    std::set<std::pair<const FunctionDecl*, const ValueDecl*>> modifiedSources_;
+    std::set<const FunctionDecl*> callsNonConstOnThis_;
+};
+
+bool RefCountChurn::TraverseFunctionDecl( FunctionDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseFunctionDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool RefCountChurn::TraverseCXXMethodDecl( CXXMethodDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXMethodDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool RefCountChurn::TraverseCXXConstructorDecl( CXXConstructorDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXConstructorDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool RefCountChurn::TraverseCXXConversionDecl( CXXConversionDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXConversionDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+bool RefCountChurn::TraverseCXXDestructorDecl( CXXDestructorDecl* p )
+{
+    maTraversingFunctions.push_back(p);
+    bool ret = RecursiveASTVisitor::TraverseCXXDestructorDecl(p);
+    maTraversingFunctions.pop_back();
+    return ret;
+}
+
+bool RefCountChurn::VisitVarDecl(const VarDecl* varDecl)
+{
+    if (ignoreLocation(varDecl) || !currentFunction()) {
+        return true;
+    }
+    if (isa<ParmVarDecl>(varDecl) || !varDecl->hasLocalStorage() || varDecl->getType()->isReferenceType()) {
+        return true;
+    }
+    if (!isSmartRef(varDecl->getType()) || !isInteresting()) {
+        return true;
+    }
+    // the loop variable of a ranged-for is loplugin:rangedforcopy's business
+    if (rangedForVars_.find(varDecl) != rangedForVars_.end() || !varDecl->getInit()) {
+        return true;
+    }
+    auto const constructExpr = dyn_cast<CXXConstructExpr>(varDecl->getInit()->IgnoreImplicit());
+    if (!constructExpr || constructExpr->getNumArgs() != 1 || !constructExpr->getConstructor()->isCopyConstructor()) {
+        return true;
+    }
+    const Expr* arg = constructExpr->getArg(0);
+    if (!arg->isLValue()) {
+        return true;
+    }
+    const Expr* rootExpr = nullptr;
+    if (!findSource(arg, rootExpr) || isKeptAlive(varDecl)) {
+        return true;
+    }
+    const ValueDecl* sourceDecl = nullptr;
+    if (auto const declRefExpr = dyn_cast<DeclRefExpr>(rootExpr))
+        sourceDecl = declRefExpr->getDecl();
+    else
+        sourceDecl = cast<MemberExpr>(rootExpr)->getMemberDecl();
+    sources_.emplace(currentFunction(), sourceDecl);
+    sourceExprs_.insert(rootExpr);
+    copies_.push_back({varDecl, currentFunction(), sourceDecl, loopDepth_});
+    copyVars_.insert(varDecl);
+    return true;
+}
+
+bool RefCountChurn::VisitDeclRefExpr(const DeclRefExpr* declRefExpr)
+{
+    if (ignoreLocation(declRefExpr)) {
+        return true;
+    }
+    if (auto const varDecl = dyn_cast<VarDecl>(declRefExpr->getDecl())) {
+        if (copyVars_.find(varDecl) != copyVars_.end() && !isReadOnlyUse(declRefExpr))
+            writtenVars_.insert(varDecl);
+    }
+    checkModified(declRefExpr, declRefExpr->getDecl());
+    return true;
+}
+
+bool RefCountChurn::VisitMemberExpr(const MemberExpr* memberExpr)
+{
+    if (ignoreLocation(memberExpr)) {
+        return true;
+    }
+    checkModified(memberExpr, memberExpr->getMemberDecl());
+    return true;
+}
+
+void RefCountChurn::checkModified(const Expr* expr, const ValueDecl* decl)
+{
+    if (sources_.find({currentFunction(), decl}) == sources_.end())
+        return;
+    if (sourceExprs_.find(expr) != sourceExprs_.end())
+        return;
+    if (!isReadOnlyUse(expr))
+        modifiedSources_.emplace(currentFunction(), decl);
+}
+
+bool RefCountChurn::VisitCXXMemberCallExpr(const CXXMemberCallExpr* callExpr)
+{
+    if (ignoreLocation(callExpr)) {
+        return true;
+    }
+    const CXXMethodDecl* methodDecl = callExpr->getMethodDecl();
+    if (!methodDecl) {
+        return true;
+    }
+    if (!methodDecl->isConst() && currentFunction()) {
+        const Expr* object = callExpr->getImplicitObjectArgument();
+        if (object && isa<CXXThisExpr>(object->IgnoreParenImpCasts()))
+            callsNonConstOnThis_.insert(currentFunction());
+    }
+
+    // (2) a member returned by value, only to be compared
+    if (!isInteresting()) {
+        return true;
+    }
+    QualType returnType = methodDecl->getReturnType();
+    if (returnType->isReferenceType() || !isSmartRef(returnType)) {
+        return true;
+    }
+    const MemberExpr* memberExpr = returnedMember(methodDecl);
+    if (!memberExpr || !isOnlyCompared(callExpr)) {
+        return true;
+    }
+    report(
+        DiagnosticsEngine::Warning,
+        "%0 returns member %1 by value, only to compare it here%select{| in a loop (depth %3)}2, return 'const %4&' instead",
+        callExpr->getLocStart())
+        << methodDecl << memberExpr->getMemberDecl() << (loopDepth_ != 0) << loopDepth_
+        << returnType.getUnqualifiedType() << callExpr->getSourceRange();
+    report(
+        DiagnosticsEngine::Note, "method is here", memberExpr->getLocStart())
+        << methodDecl->getSourceRange();
+    return true;
+}
+
+/**
+ * Is the object the copy is made from one that outlives the copy?  That is a variable or a
+ * member, not an element of a container, which whatever is called while the copy lives
+ * might remove.  rootExpr is set to the expression naming the variable or member.
+ */
+bool RefCountChurn::findSource(const Expr* expr, const Expr*& rootExpr)
+{
+    expr = expr->IgnoreParenImpCasts();
+    if (auto const declRefExpr = dyn_cast<DeclRefExpr>(expr)) {
+        if (!isa<VarDecl>(declRefExpr->getDecl()))
+            return false;
+        rootExpr = declRefExpr;
+        return true;
+    }
+    if (auto const memberExpr = dyn_cast<MemberExpr>(expr)) {
+        if (!isa<FieldDecl>(memberExpr->getMemberDecl()))
+            return false;
+        rootExpr = memberExpr;
+        return true;
+    }
+    return false;
+}
+
+bool refersTo(const Stmt* stmt, const VarDecl* varDecl)
+{
+    if (auto const declRefExpr = dyn_cast<DeclRefExpr>(stmt))
+        if (declRefExpr->getDecl() == varDecl)
+            return true;
+    for (const Stmt* child : stmt->children())
+        if (child && refersTo(child, varDecl))
+            return true;
+    return false;
+}
+
+// xFoo->bar(), (*xFoo).bar() or xFoo.get()->bar()
+bool isCallThrough(const Expr* object, const VarDecl* varDecl)
+{
+    object = object->IgnoreParenImpCasts();
+    const Expr* smartRef = nullptr;
+    if (auto const operatorCall = dyn_cast<CXXOperatorCallExpr>(object)) {
+        if ((operatorCall->getOperator() == OO_Arrow || operatorCall->getOperator() == OO_Star)
+            && operatorCall->getNumArgs() == 1)
+            smartRef = operatorCall->getArg(0);
+    } else if (auto const memberCall = dyn_cast<CXXMemberCallExpr>(object)) {
+        auto const methodDecl = memberCall->getMethodDecl();
+        if (methodDecl && methodDecl->getIdentifier() && methodDecl->getName() == "get")
+            smartRef = memberCall->getImplicitObjectArgument();
+    }
+    if (!smartRef)
+        return false;
+    auto const declRefExpr = dyn_cast<DeclRefExpr>(smartRef->IgnoreParenImpCasts());
+    return declRefExpr && declRefExpr->getDecl() == varDecl;
+}
+
+bool isGuard(QualType type)
+{
+    auto const recordDecl = type->getAsCXXRecordDecl();
+    if (!recordDecl || !recordDecl->getIdentifier())
+        return false;
+    StringRef name = recordDecl->getName();
+    return name.find("Guard") != StringRef::npos || name.find("Releaser") != StringRef::npos;
+}
+
+/**
+ * Is the copy meant to keep the object alive, as it lives across something that might drop
+ * the source?  Looks at the statements from the declaration of the copy to its last use.
+ */
+bool RefCountChurn::isKeptAlive(const VarDecl* varDecl)
+{
+    auto const declStmt = dyn_cast_or_null<DeclStmt>(parentStmt(varDecl->getInit()));
+    auto const compoundStmt = declStmt ? dyn_cast_or_null<CompoundStmt>(parentStmt(declStmt)) : nullptr;
+    if (!compoundStmt)
+        return true;
+    auto const declIt = std::find(compoundStmt->body_begin(), compoundStmt->body_end(), declStmt);
+    if (declIt == compoundStmt->body_end())
+        return true;
+    auto lastUseIt = declIt;
+    for (auto it = declIt + 1; it != compoundStmt->body_end(); ++it)
+        if (refersTo(*it, varDecl))
+            lastUseIt = it;
+    for (auto it = declIt + 1; it <= lastUseIt; ++it)
+        if (mayDropSource(*it, varDecl, false))
+            return true;
+    return false;
+}
+
+bool RefCountChurn::mayDropSource(const Stmt* stmt, const VarDecl* varDecl, bool nested)
+{
+    if (auto const declStmt = dyn_cast<DeclStmt>(stmt)) {
+        // a guard in a nested scope is released before the copy is gone
+        if (nested) {
+            for (auto const decl : declStmt->decls()) {
+                auto const guardVar = dyn_cast<VarDecl>(decl);
+                if (guardVar && isGuard(guardVar->getType()))
+                    return true;
+            }
+        }
+    } else if (auto const memberCall = dyn_cast<CXXMemberCallExpr>(stmt)) {
+        auto const methodDecl = memberCall->getMethodDecl();
+        if (!methodDecl || !methodDecl->isConst())
+            return true;
+        if (memberCall->getImplicitObjectArgument()
+            && isCallThrough(memberCall->getImplicitObjectArgument(), varDecl))
+            return true;
+    } else if (auto const operatorCall = dyn_cast<CXXOperatorCallExpr>(stmt)) {
+        switch (operatorCall->getOperator()) {
+        case OO_EqualEqual:
+        case OO_ExclaimEqual:
+        case OO_Less:
+        case OO_Exclaim:
+            break;
+        default: {
+            auto const methodDecl = dyn_cast_or_null<CXXMethodDecl>(operatorCall->getDirectCallee());
+            if (!methodDecl || !methodDecl->isConst())
+                return true;
+            break;
+        }
+        }
+    } else if (isa<CallExpr>(stmt)) {
+        // a free function can do anything
+        return true;
+    }
+    for (const Stmt* child : stmt->children())
+        if (child && mayDropSource(child, varDecl, true))
+            return true;
+    return false;
+}
+
+/**
+ * Is the object that expr refers to only read where expr is used, i.e. bound to a const
+ * reference, copied, or used as the object of a const member function?
+ */
+bool RefCountChurn::isReadOnlyUse(const Expr* expr)
+{
+    const Stmt* child = expr;
+    const Stmt* parent = parentStmt(expr);
+    // look through the wrappers around the object
+    while (parent && (isa<ParenExpr>(parent) || isa<ImplicitCastExpr>(parent)
+                      || isa<MaterializeTemporaryExpr>(parent) || isa<CXXBindTemporaryExpr>(parent)))
+    {
+        if (auto const castExpr = dyn_cast<ImplicitCastExpr>(parent)) {
+            if (castExpr->getCastKind() == CK_NoOp && castExpr->getType().isConstQualified())
+                return true;
+            if (castExpr->getCastKind() != CK_NoOp && castExpr->getCastKind() != CK_DerivedToBase
+                && castExpr->getCastKind() != CK_UncheckedDerivedToBase)
+            {
+                return false;
+            }
+        }
+        child = parent;
+        parent = parentStmt(parent);
+    }
+    if (!parent)
+        return false;
+    if (auto const memberExpr = dyn_cast<MemberExpr>(parent)) {
+        auto const methodDecl = dyn_cast<CXXMethodDecl>(memberExpr->getMemberDecl());
+        return methodDecl && methodDecl->isConst();
+    }
+    if (isa<CallExpr>(parent) || isa<CXXConstructExpr>(parent))
+        return isReadOnlyArgument(parent, child);
+    return false;
+}
+
+bool RefCountChurn::isReadOnlyArgument(const Stmt* callOrConstruct, const Stmt* arg)
+{
+    const FunctionDecl* functionDecl = nullptr;
+    llvm::ArrayRef<const Expr*> args;
+    unsigned firstParam = 0;
+    if (auto const constructExpr = dyn_cast<CXXConstructExpr>(callOrConstruct)) {
+        functionDecl = constructExpr->getConstructor();
+        args = llvm::makeArrayRef(constructExpr->getArgs(), constructExpr->getNumArgs());
+    } else {
+        auto const callExpr = cast<CallExpr>(callOrConstruct);
+        functionDecl = callExpr->getDirectCallee();
+        args = llvm::makeArrayRef(callExpr->getArgs(), callExpr->getNumArgs());
+        // for a member operator, the first argument is the object
+        if (isa<CXXOperatorCallExpr>(callExpr) && functionDecl && isa<CXXMethodDecl>(functionDecl)) {
+            if (!args.empty() && args[0] == arg)
+                return cast<CXXMethodDecl>(functionDecl)->isConst();
+            firstParam = 1;
+        }
+    }
+    if (!functionDecl)
+        return false;
+    for (unsigned i = firstParam; i != args.size(); ++i) {
+        if (args[i] != arg)
+            continue;
+        if (i - firstParam >= functionDecl->getNumParams())
+            return false;
+        QualType paramType = functionDecl->getParamDecl(i - firstParam)->getType();
+        if (paramType->isRValueReferenceType())
+            return false;
+        if (auto const refType = paramType->getAs<LValueReferenceType>())
+            return refType->getPointeeType().isConstQualified();
+        // passed by value, copied
+        return true;
+    }
+    return false;
+}
+
+/**
+ * The member a method returns, if all the method does is return a member of its class.
+ */
+const MemberExpr* RefCountChurn::returnedMember(const CXXMethodDecl* methodDecl)
+{
+    const FunctionDecl* definition = nullptr;
+    if (!methodDecl->hasBody(definition) || !definition)
+        return nullptr;
+    auto const compoundStmt = dyn_cast_or_null<CompoundStmt>(definition->getBody());
+    if (!compoundStmt || compoundStmt->size() != 1)
+        return nullptr;
+    auto const returnStmt = dyn_cast<ReturnStmt>(*compoundStmt->body_begin());
+    if (!returnStmt || !returnStmt->getRetValue())
+        return nullptr;
+    const Expr* expr = returnStmt->getRetValue()->IgnoreImplicit();
+    if (auto const constructExpr = dyn_cast<CXXConstructExpr>(expr)) {
+        if (constructExpr->getNumArgs() != 1)
+            return nullptr;
+        expr = constructExpr->getArg(0);
+    }
+    auto const memberExpr = dyn_cast<MemberExpr>(expr->IgnoreParenImpCasts());
+    if (!memberExpr || !isa<FieldDecl>(memberExpr->getMemberDecl())
+        || !isa<CXXThisExpr>(memberExpr->getBase()->IgnoreParenImpCasts()))
+    {
+        return nullptr;
+    }
+    return memberExpr;
+}
+
+/**
+ * Is the temporary returned by a call only compared (==, !=, <) or tested (is(), get(),
+ * conversion to a pointer or bool)?
+ */
+bool RefCountChurn::isOnlyCompared(const Expr* expr)
+{
+    const Stmt* parent = parentStmt(expr);
+    while (parent && (isa<ParenExpr>(parent) || isa<ImplicitCastExpr>(parent)
+                      || isa<MaterializeTemporaryExpr>(parent) || isa<CXXBindTemporaryExpr>(parent)))
+    {
+        parent = parentStmt(parent);
+    }
+    if (!parent)
+        return false;
+    if (auto const memberExpr = dyn_cast<MemberExpr>(parent)) {
+        auto const methodDecl = dyn_cast<CXXMethodDecl>(memberExpr->getMemberDecl());
+        if (!methodDecl || !methodDecl->isConst())
+            return false;
+        if (isa<CXXConversionDecl>(methodDecl))
+            return true;
+        return methodDecl->getIdentifier()
+            && (methodDecl->getName() == "is" || methodDecl->getName() == "get");
+    }
+    if (auto const operatorCallExpr = dyn_cast<CXXOperatorCallExpr>(parent)) {
+        switch (operatorCallExpr->getOperator()) {
+        case OO_EqualEqual:
+        case OO_ExclaimEqual:
+        case OO_Less:
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+void RefCountChurn::reportCopies()
+{
+    for (const Copy & copy : copies_) {
+        if (writtenVars_.find(copy.varDecl) != writtenVars_.end())
+            continue;
+        if (modifiedSources_.find({copy.functionDecl, copy.sourceDecl}) != modifiedSources_.end())
+            continue;
+        // a member might be replaced by whatever the method calls on this
+        if (isa<FieldDecl>(copy.sourceDecl)
+            && callsNonConstOnThis_.find(copy.functionDecl) != callsNonConstOnThis_.end())
+        {
+            continue;
+        }
+        report(
+            DiagnosticsEngine::Warning,
+            "%0 is a copy of an object that outlives it and is only read%select{ in accessor %2| in a loop (depth %3)}1, bind a 'const %4&' to it instead",
+            copy.varDecl->getLocation())
+            << copy.varDecl << (copy.loopDepth != 0) << copy.functionDecl << copy.loopDepth
+            << copy.varDecl->getType().getUnqualifiedType() << copy.varDecl->getSourceRange();
+    }
+}
+
+loplugin::Plugin::Registration< RefCountChurn > X("refcountchurn", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */
@@ -0,0 +1,271 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This file is part of the LibreOffice project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "check.hxx"
+#include "compat.hxx"
+#include "plugin.hxx"
+
+/**
+Look for sorting that is repeated more often than the data changes:
+
+(1) std::sort/std::stable_sort, comphelper sorts or a sort()/Sort() member call inside a loop
+    body, where sorting once after the loop, or keeping the container sorted, would do;
+
+(2) sorting in a const member function, of the container it then returns, like
+    ScriptDocument::getObjectNames, which sorts again on every call where the sorted order could
+    be cached or kept up to date by whoever changes the data;
+
+(3) sorting directly after inserting a single element into the same container, like
+    pTabBar->InsertPage(...); pTabBar->Sort(); where inserting at the right position (found
+    with std::upper_bound) is O(log n) instead of O(n log n), and repeating it n times is not
+    O(n^2 log n).
+*/
+
+namespace {
+
+class RepeatedSort:
+    public RecursiveASTVisitor<RepeatedSort>, public loplugin::Plugin
+{
+public:
+    explicit RepeatedSort(InstantiationData const & data): Plugin(data) {}
+
+    virtual void run() override
+    {
+        TraverseDecl(compiler.getASTContext().getTranslationUnitDecl());
+    }
+
+    bool TraverseForStmt(ForStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseForStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseCXXForRangeStmt(CXXForRangeStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseCXXForRangeStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseWhileStmt(WhileStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseWhileStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseDoStmt(DoStmt * stmt)
+    {
+        loops_.push_back(stmt);
+        auto const ret = RecursiveASTVisitor::TraverseDoStmt(stmt);
+        loops_.pop_back();
+        return ret;
+    }
+
+    bool TraverseLambdaExpr(LambdaExpr * expr)
+    {
+        // a lambda body is not executed where it is written
+        std::vector<const Stmt*> saved;
+        saved.swap(loops_);
+        auto const ret = RecursiveASTVisitor::TraverseLambdaExpr(expr);
+        loops_.swap(saved);
+        return ret;
+    }
+
+    bool VisitCallExpr(const CallExpr*);
+
+private:
+    const Expr* getSortedContainer(const CallExpr*);
+    bool isReturned(const Stmt* body, std::string const & container);
+    const CallExpr* getPrecedingInsert(const CallExpr*, std::string const & container);
+    std::string getExprAsString(const Expr*);
+
+    std::vector<const Stmt*> loops_;
+};
+
+bool RepeatedSort::VisitCallExpr(const CallExpr* callExpr)
+{
+    if (ignoreLocation(callExpr))
+        return true;
+    const Expr* containerExpr = getSortedContainer(callExpr);
+    if (!containerExpr)
+        return true;
+    std::string container = getExprAsString(containerExpr);
+
+    if (!loops_.empty())
+    {
+        // sorting a container that is built afresh in each iteration is fine
+        if (auto declRefExpr = dyn_cast<DeclRefExpr>(containerExpr))
+            if (!compiler.getSourceManager().isBeforeInTranslationUnit(
+                    declRefExpr->getDecl()->getLocation(), loops_.back()->getLocStart()))
+                return true;
+        report(
+            DiagnosticsEngine::Warning,
+            "sorting inside a loop (depth %0), sort once after the loop, or keep the container sorted with a sorted insert",
+            callExpr->getLocStart())
+            << unsigned(loops_.size()) << callExpr->getSourceRange();
+        return true;
+    }
+
+    if (!container.empty())
+    {
+        const FunctionDecl* functionDecl = parentFunctionDecl(callExpr);
+        auto methodDecl = dyn_cast_or_null<CXXMethodDecl>(functionDecl);
+        if (methodDecl && methodDecl->isConst() && methodDecl->getBody()
+            && isReturned(methodDecl->getBody(), container))
+        {
+            report(
+                DiagnosticsEngine::Warning,
+                "const accessor %0 sorts '%1' on every call, cache the sorted order or keep it sorted where the data changes",
+                callExpr->getLocStart())
+                << methodDecl << container << callExpr->getSourceRange();
+            return true;
+        }
+
+        if (const CallExpr* insertCall = getPrecedingInsert(callExpr, container))
+        {
+            report(
+                DiagnosticsEngine::Warning,
+                "'%0' is sorted directly after inserting a single element, insert at the sorted position instead",
+                callExpr->getLocStart())
+                << container << callExpr->getSourceRange();
+            report(
+                DiagnosticsEngine::Note, "insert is here", insertCall->getLocStart())
+                << insertCall->getSourceRange();
+        }
+    }
+    return true;
+}
+
+/**
+ * If this is a sort call, return the expression for what is being sorted.
+ */
+const Expr* RepeatedSort::getSortedContainer(const CallExpr* callExpr)
+{
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(callExpr))
+    {
+        // std::list::sort, TabBar::Sort etc.
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        if (!methodDecl || !methodDecl->getIdentifier())
+            return nullptr;
+        if (methodDecl->getName() != "sort" && methodDecl->getName() != "Sort")
+            return nullptr;
+        const Expr* object = memberCall->getImplicitObjectArgument();
+        return object ? object->IgnoreParenImpCasts() : nullptr;
+    }
+    const FunctionDecl* calleeDecl = callExpr->getDirectCallee();
+    if (!calleeDecl || callExpr->getNumArgs() < 2)
+        return nullptr;
+    auto dc = loplugin::DeclCheck(calleeDecl);
+    if (!(dc.Function("sort").StdNamespace() || dc.Function("stable_sort").StdNamespace()
+          || dc.Function("partial_sort").StdNamespace()
+          || dc.Function("sort").Namespace("comphelper").GlobalNamespace()
+          || dc.Function("sortAndRemoveDuplicates").Namespace("comphelper").GlobalNamespace()))
+        return nullptr;
+    // std::sort(aFoo.begin(), aFoo.end()) sorts aFoo
+    const Expr* first = callExpr->getArg(0)->IgnoreImplicit();
+    if (auto memberCall = dyn_cast<CXXMemberCallExpr>(first))
+    {
+        const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+        if (methodDecl && methodDecl->getIdentifier()
+            && (methodDecl->getName() == "begin" || methodDecl->getName() == "getArray"))
+        {
+            if (const Expr* object = memberCall->getImplicitObjectArgument())
+                return object->IgnoreParenImpCasts();
+        }
+    }
+    // comphelper sorts taking the container itself
+    return first->IgnoreParenImpCasts();
+}
+
+bool RepeatedSort::isReturned(const Stmt* stmt, std::string const & container)
+{
+    if (auto returnStmt = dyn_cast<ReturnStmt>(stmt))
+    {
+        const Expr* retValue = returnStmt->getRetValue();
+        if (retValue && getExprAsString(retValue->IgnoreImplicit()->IgnoreParenImpCasts()) == container)
+            return true;
+    }
+    for (const Stmt* child : stmt->children())
+        if (child && !isa<LambdaExpr>(child) && isReturned(child, container))
+            return true;
+    return false;
+}
+
+/**
+ * Return the single element insertion into the same container in the statement right
+ * before the sort, if any.
+ */
+const CallExpr* RepeatedSort::getPrecedingInsert(const CallExpr* callExpr, std::string const & container)
+{
+    const Stmt* stmt = callExpr;
+    const Stmt* parent = parentStmt(stmt);
+    while (parent && !isa<CompoundStmt>(parent))
+    {
+        if (!isa<ExprWithCleanups>(parent) && !isa<ImplicitCastExpr>(parent))
+            return nullptr;
+        stmt = parent;
+        parent = parentStmt(parent);
+    }
+    if (!parent)
+        return nullptr;
+    const Stmt* previous = nullptr;
+    for (const Stmt* child : cast<CompoundStmt>(parent)->body())
+    {
+        if (child == stmt)
+            break;
+        previous = child;
+    }
+    if (!previous || !isa<Expr>(previous))
+        return nullptr;
+    auto memberCall = dyn_cast<CXXMemberCallExpr>(cast<Expr>(previous)->IgnoreImplicit());
+    if (!memberCall)
+        return nullptr;
+    const CXXMethodDecl* methodDecl = memberCall->getMethodDecl();
+    if (!methodDecl || !methodDecl->getIdentifier())
+        return nullptr;
+    auto name = methodDecl->getName();
+    if (name != "push_back" && name != "emplace_back" && name != "insert" && name != "emplace"
+        && name != "Insert" && name != "InsertPage" && name != "InsertEntry")
+        return nullptr;
+    const Expr* object = memberCall->getImplicitObjectArgument();
+    if (!object || getExprAsString(object->IgnoreParenImpCasts()) != container)
+        return nullptr;
+    return memberCall;
+}
+
+std::string RepeatedSort::getExprAsString(const Expr* expr)
+{
+    if (expr->HasSideEffects(compiler.getASTContext()))
+        return "";
+    SourceManager& SM = compiler.getSourceManager();
+    SourceLocation startLoc = SM.getExpansionLoc(expr->getLocStart());
+    SourceLocation endLoc = SM.getExpansionLoc(expr->getLocEnd());
+    const char *p1 = SM.getCharacterData( startLoc );
+    const char *p2 = SM.getCharacterData( endLoc );
+    if (!p1 || !p2 || (p2 - p1) < 0) {
+        return "";
+    }
+    unsigned n = Lexer::MeasureTokenLength( endLoc, SM, compiler.getLangOpts());
+    return std::string( p1, p2 - p1 + n);
+}
+
+loplugin::Plugin::Registration< RepeatedSort > X("repeatedsort", false);
+
+}
+
+/* vim:set shiftwidth=4 softtabstop=4 expandtab: */